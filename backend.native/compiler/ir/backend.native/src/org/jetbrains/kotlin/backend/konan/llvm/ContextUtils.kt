@@ -496,6 +496,7 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
     val initThreadLocalSingleton = importRtFunction("InitThreadLocalSingleton")
     val initSingletonFunction = importRtFunction("InitSingleton")
     val initAndRegisterGlobalFunction = importRtFunction("InitAndRegisterGlobal")
+    val callInitGlobalPossiblyLock = importRtFunction("CallInitGlobalPossiblyLock")
     val updateHeapRefFunction = importRtFunction("UpdateHeapRef")
     val updateStackRefFunction = importRtFunction("UpdateStackRef")
     val updateReturnRefFunction = importRtFunction("UpdateReturnRef")
@@ -330,6 +330,11 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
 
         f()
 
+        context.llvm.fileInitializers
+                .filter { fileInitializerFor(it) != null }
+                .groupBy { fileInitializerFor(it)!! }
+                .forEach { (fileInitializer, fields) -> generateFileInitializer(fileInitializer, fields) }
+
         if (context.llvm.fileInitializers.isEmpty() && !context.llvm.fileUsesThreadLocalObjects && context.llvm.globalSharedObjects.isEmpty()) {
             return
         }
@@ -417,29 +422,9 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                 appendingTo(bbInit) {
                     context.llvm.fileInitializers
                             .forEach { irField ->
-                                if (irField.storageKind != FieldStorageKind.THREAD_LOCAL) {
-                                    val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
-                                            functionGenerationContext
-                                    )
-                                    val initialValue = if (irField.initializer?.expression !is IrConst<*>?) {
-                                        val initialization = evaluateExpression(irField.initializer!!.expression)
-                                        if (irField.storageKind == FieldStorageKind.SHARED_FROZEN)
-                                            freeze(initialization, currentCodeContext.exceptionHandler)
-                                        initialization
-                                    } else {
-                                        null
-                                    }
-                                    val needRegistration =
-                                            context.memoryModel == MemoryModel.EXPERIMENTAL && // only for the new MM
-                                                    irField.type.binaryTypeIsReference() && // only for references
-                                                    (initialValue != null || // which are initialized from heap object
-                                                            !irField.isFinal) // or are not final
-                                    if (needRegistration) {
-                                        call(context.llvm.initAndRegisterGlobalFunction, listOf(address, initialValue
-                                                ?: kNullObjHeaderPtr))
-                                    } else if (initialValue != null) {
-                                        storeAny(initialValue, address, false)
-                                    }
+                                // Lazily initialized globals are set up by their file initializer on first access.
+                                if (irField.storageKind != FieldStorageKind.THREAD_LOCAL && fileInitializerFor(irField) == null) {
+                                    initializeGlobal(irField)
                                 }
                             }
                     ret(null)
@@ -482,6 +467,11 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                     context.llvm.globalSharedObjects.forEach { address ->
                         storeHeapRef(codegen.kNullObjHeaderPtr, address)
                     }
+                    // Let a runtime created after this one initialize the lazy globals again.
+                    context.llvm.fileInitializers
+                            .mapNotNull { fileInitializerFor(it) }
+                            .distinct()
+                            .forEach { store(Int32(FILE_NOT_INITIALIZED).llvm, it.state) }
                     ret(null)
                 }
             }
@@ -489,6 +479,109 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
         return initFunction
     }
 
+    private fun initializeGlobal(irField: IrField) {
+        with(functionGenerationContext) {
+            val address = context.llvmDeclarations.forStaticField(irField).storageAddressAccess.getAddress(
+                    functionGenerationContext
+            )
+            val initialValue = if (irField.initializer?.expression !is IrConst<*>?) {
+                val initialization = evaluateExpression(irField.initializer!!.expression)
+                if (irField.storageKind == FieldStorageKind.SHARED_FROZEN)
+                    freeze(initialization, currentCodeContext.exceptionHandler)
+                initialization
+            } else {
+                null
+            }
+            if (irField.needsRegistration) {
+                call(context.llvm.initAndRegisterGlobalFunction, listOf(address, initialValue
+                        ?: kNullObjHeaderPtr))
+            } else if (initialValue != null) {
+                storeAny(initialValue, address, false)
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------//
+    // Lazy initialization of top-level properties.
+    // With `-Xlazy-global-initialization` the shared globals of a file that need any code to be initialized are not
+    // set up at startup. Instead each access to a global of such a file first checks the file state and, unless
+    // it's already initialized, calls the runtime to run the file initializer.
+
+    // Must be synchronized with Memory.h
+    val FILE_NOT_INITIALIZED = 0
+    val FILE_INITIALIZED = 1
+
+    private inner class FileInitializer(val state: LLVMValueRef, val function: LLVMValueRef)
+
+    private val lazyFileInitializers = mutableMapOf<IrFile, FileInitializer?>()
+
+    // Registration in the new MM rootset. Only references, which are initialized from heap objects or are not final.
+    private val IrField.needsRegistration: Boolean
+        get() = context.memoryModel == MemoryModel.EXPERIMENTAL &&
+                type.binaryTypeIsReference() &&
+                (initializer?.expression !is IrConst<*>? || !isFinal)
+
+    private val IrField.needsInitializationCode: Boolean
+        get() = initializer?.expression !is IrConst<*>? || needsRegistration
+
+    private fun IrFile.sharedGlobals() = declarations.flatMap {
+        when (it) {
+            is IrField -> listOf(it)
+            is IrProperty -> listOfNotNull(it.backingField)
+            else -> emptyList()
+        }
+    }.filter { context.needGlobalInit(it) && it.storageKind != FieldStorageKind.THREAD_LOCAL }
+
+    private fun fileInitializerFor(irField: IrField): FileInitializer? {
+        if (!context.config.lazyGlobalInitialization || irField.storageKind == FieldStorageKind.THREAD_LOCAL) return null
+        // Only files compiled into this LLVM module are initialized lazily. A cache is linked into binaries built without
+        // knowing how the cache was compiled, so its globals stay eagerly initialized, and globals of a file from a cache
+        // are accessed directly.
+        if (context.config.produce.isCache || codegen.isExternal(irField)) return null
+        val file = irField.parent as? IrFile ?: return null
+        return lazyFileInitializers.getOrPut(file) {
+            val globals = file.sharedGlobals()
+            if (globals.none { it.needsInitializationCode }) return@getOrPut null
+            // With the strict MM mutable globals belong to the main thread, so their files are initialized there at startup.
+            if (context.memoryModel == MemoryModel.STRICT && context.config.threadsAreAllowed && globals.any { it.isGlobalNonPrimitive })
+                return@getOrPut null
+            // Private to this LLVM module, so files with the same name in the same package don't clash.
+            val symbolName = "kfile:${file.fqName}/${file.name}"
+            val state = context.llvm.staticData.createGlobal(int32Type, "$symbolName#state").also {
+                it.setZeroInitializer()
+                it.setAlignment(4)
+            }
+            val function = addLlvmFunctionWithDefaultAttributes(context, context.llvmModule!!, "$symbolName#init", kVoidFuncType)
+            LLVMSetLinkage(function, LLVMLinkage.LLVMPrivateLinkage)
+            FileInitializer(state.llvmGlobal, function)
+        }
+    }
+
+    private fun generateFileInitializer(fileInitializer: FileInitializer, fields: List<IrField>) {
+        generateFunction(codegen, fileInitializer.function) {
+            using(FunctionScope(fileInitializer.function, "init_file", it)) {
+                // Accesses to the globals do the main thread checks, if any.
+                fields.forEach { initializeGlobal(it) }
+                ret(null)
+            }
+        }
+    }
+
+    // Runs the file initializer unless the file is initialized already or `irField` is accessed by the initializer itself.
+    private fun initializeFileIfNeeded(irField: IrField) {
+        val fileInitializer = fileInitializerFor(irField) ?: return
+        with(functionGenerationContext) {
+            if (function == fileInitializer.function) return
+            val state = load(fileInitializer.state)
+            LLVMSetOrdering(state, LLVMAtomicOrdering.LLVMAtomicOrderingAcquire)
+            LLVMSetAlignment(state, 4)
+            ifThen(icmpNe(state, Int32(FILE_INITIALIZED).llvm)) {
+                call(context.llvm.callInitGlobalPossiblyLock, listOf(fileInitializer.state, fileInitializer.function),
+                        Lifetime.IRRELEVANT, currentCodeContext.exceptionHandler)
+            }
+        }
+    }
+
     //-------------------------------------------------------------------------//
     // Creates static struct InitNode $nodeName = {$initName, NULL};
 
@@ -1588,6 +1681,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                 if (context.config.threadsAreAllowed && value.symbol.owner.isGlobalNonPrimitive) {
                     functionGenerationContext.checkGlobalsAccessible(currentCodeContext.exceptionHandler)
                 }
+                initializeFileIfNeeded(value.symbol.owner)
                 val ptr = context.llvmDeclarations.forStaticField(value.symbol.owner).storageAddressAccess.getAddress(
                         functionGenerationContext
                 )
@@ -1658,6 +1752,7 @@ internal class CodeGeneratorVisitor(val context: Context, val lifetimes: Map<IrE
                 functionGenerationContext.checkGlobalsAccessible(currentCodeContext.exceptionHandler)
             if (value.symbol.owner.storageKind == FieldStorageKind.SHARED_FROZEN)
                 functionGenerationContext.freeze(valueToAssign, currentCodeContext.exceptionHandler)
+            initializeFileIfNeeded(value.symbol.owner)
             functionGenerationContext.storeAny(valueToAssign, globalAddress, false)
         }
         if (store != null && value.value.type.classifierOrNull?.isClassWithFqName(vectorType) == true) {
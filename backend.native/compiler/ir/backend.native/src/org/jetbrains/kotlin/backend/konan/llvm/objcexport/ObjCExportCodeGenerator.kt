@@ -583,7 +583,10 @@ private fun ObjCExportCodeGeneratorBase.buildWritableTypeInfoValue(
     )
 
     val writableTypeInfoType = runtime.writableTypeInfoType!!
-    return Struct(writableTypeInfoType, objCExportAddition)
+    return Struct(writableTypeInfoType,
+            objCExportAddition,
+            null // Type counters are allocated by the runtime.
+    )
 }
 
 private val ObjCExportCodeGenerator.kotlinToObjCFunctionType: LLVMTypeRef
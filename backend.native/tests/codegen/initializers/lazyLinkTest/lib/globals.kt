@@ -0,0 +1,11 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+fun trace(name: String, value: Int): Int {
+    println("init $name")
+    return value
+}
+
+val libValue = trace("libValue", 40)
@@ -0,0 +1,14 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+// The library has a file with the same name in the same package, and each file gets its own initializer.
+
+val mainValue = trace("mainValue", 2)
+
+fun main() {
+    println("main")
+    println(libValue + mainValue)
+    println(libValue + mainValue)
+}
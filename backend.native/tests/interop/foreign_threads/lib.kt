@@ -0,0 +1,15 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+import kotlin.native.concurrent.*
+
+@ThreadLocal
+private var counter = 0
+
+fun incrementThreadLocal(): Int {
+    return ++counter
+}
+
+fun currentWorkerId(): Int = Worker.current.id
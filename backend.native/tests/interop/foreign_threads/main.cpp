@@ -0,0 +1,39 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "testlib_api.h"
+
+#include <cassert>
+#include <set>
+#include <thread>
+#include <vector>
+
+int main() {
+    // Short-lived threads reuse memory state of the threads that left the runtime before them.
+    // Thread locals must still start from their initial values.
+    for (int i = 0; i < 100; ++i) {
+        std::thread thread([]() {
+            assert(testlib_symbols()->kotlin.root.incrementThreadLocal() == 1);
+            assert(testlib_symbols()->kotlin.root.incrementThreadLocal() == 2);
+        });
+        thread.join();
+    }
+
+    // Workers of foreign threads are created on demand, and are still distinct.
+    std::vector<int> ids(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        threads.emplace_back([&ids, i]() {
+            ids[i] = testlib_symbols()->kotlin.root.currentWorkerId();
+            assert(testlib_symbols()->kotlin.root.currentWorkerId() == ids[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(std::set<int>(ids.begin(), ids.end()).size() == ids.size());
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+@file:OptIn(ExperimentalStdlibApi::class)
+
+package runtime.basic.console_buffering
+
+import kotlin.native.concurrent.*
+
+fun main() {
+    // Many small writes, which take several buffers.
+    for (i in 0 until 10000) {
+        print(i)
+        print(' ')
+        if (i % 100 == 99) println()
+    }
+
+    // A single write larger than the buffer.
+    println("x".repeat(40000))
+    flushStandardOutput()
+
+    // All threads share the buffer, so lines written at once must stay whole.
+    val workers = Array(4) { Worker.start() }
+    workers.mapIndexed { index, worker ->
+        worker.execute(TransferMode.SAFE, { index }) { id ->
+            repeat(1000) { print("worker $id line $it\n") }
+        }
+    }.forEach { it.result }
+    workers.forEach { it.requestTermination().result }
+
+    // Flushed at exit even without a trailing newline.
+    print("END")
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+@file:OptIn(ExperimentalStdlibApi::class)
+
+package runtime.basic.direct_byte_buffer
+
+import kotlin.native.concurrent.*
+import kotlin.test.*
+import kotlinx.cinterop.*
+
+@Test fun runTest() {
+    DirectByteBuffer.allocate(64).use { buffer ->
+        assertEquals(64L, buffer.capacity)
+        assertEquals(DirectByteBuffer.ByteOrder.NATIVE, buffer.order)
+        assertEquals(0.toByte(), buffer[63])
+
+        buffer.setIntAt(1, 0x12345678)
+        assertEquals(0x12345678, buffer.getIntAt(1))
+        buffer.setDoubleAt(9, 0.1)
+        assertEquals(0.1, buffer.getDoubleAt(9))
+
+        buffer.order = DirectByteBuffer.ByteOrder.BIG_ENDIAN
+        buffer.setIntAt(0, 0x01020304)
+        assertEquals(1.toByte(), buffer[0])
+        assertEquals(4.toByte(), buffer[3])
+        buffer.order = DirectByteBuffer.ByteOrder.LITTLE_ENDIAN
+        assertEquals(0x04030201, buffer.getIntAt(0))
+
+        val ints = IntArray(5) { it * 1000 - 2 }
+        for (order in DirectByteBuffer.ByteOrder.values()) {
+            buffer.order = order
+            buffer.putInts(3, ints)
+            val readBack = IntArray(7)
+            buffer.getInts(3, readBack, 1, 5)
+            assertTrue((intArrayOf(0) + ints + intArrayOf(0)).contentEquals(readBack))
+            assertEquals(ints[1], buffer.getIntAt(7))
+        }
+
+        val doubles = doubleArrayOf(1.5, -0.0, Double.MAX_VALUE)
+        buffer.order = DirectByteBuffer.ByteOrder.BIG_ENDIAN
+        buffer.putDoubles(40, doubles)
+        assertTrue(doubles.contentEquals(DoubleArray(3).also { buffer.getDoubles(40, it) }))
+
+        buffer.putBytes(0, byteArrayOf(7, 8, 9))
+        assertEquals(8.toByte(), buffer.asCPointer(1).pointed.value)
+
+        assertFailsWith<ArrayIndexOutOfBoundsException> { buffer.getLongAt(57) }
+        assertFailsWith<ArrayIndexOutOfBoundsException> { buffer[-1] }
+        assertFailsWith<ArrayIndexOutOfBoundsException> { buffer.putLongs(40, LongArray(4)) }
+        assertFailsWith<ArrayIndexOutOfBoundsException> { buffer.getShorts(0, ShortArray(2), 1, 2) }
+    }
+
+    val buffer = DirectByteBuffer.allocate(0)
+    assertEquals(0L, buffer.capacity)
+    buffer.free()
+    assertTrue(buffer.isFreed)
+    buffer.free()
+    assertFailsWith<IllegalStateException> { buffer[0] }
+    assertFailsWith<IllegalArgumentException> { DirectByteBuffer.allocate(-1) }
+
+    // A frozen buffer cannot be freed, its memory is released by its cleaner instead.
+    val frozen = DirectByteBuffer.allocate(8).freeze()
+    assertEquals(0L, frozen.getLongAt(0))
+    if (Platform.memoryModel != MemoryModel.EXPERIMENTAL) {
+        assertFailsWith<InvalidMutabilityException> { frozen.free() }
+        assertFalse(frozen.isFreed)
+    }
+
+    println("OK")
+}
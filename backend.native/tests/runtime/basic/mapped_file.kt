@@ -0,0 +1,77 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+@file:OptIn(ExperimentalStdlibApi::class)
+
+package runtime.basic.mapped_file
+
+import kotlin.native.concurrent.*
+import kotlin.test.*
+import kotlinx.cinterop.*
+import platform.posix.*
+
+private fun writeTempFile(name: String, data: ByteArray): String {
+    val path = "${getenv("TMPDIR")?.toKString() ?: "/tmp"}/$name.${getpid()}"
+    val file = fopen(path, "wb") ?: error("Cannot create $path")
+    if (data.isNotEmpty()) {
+        data.usePinned {
+            fwrite(it.addressOf(0), 1, data.size.convert(), file)
+        }
+    }
+    fclose(file)
+    return path
+}
+
+@Test fun runTest() {
+    val data = ByteArray(4099) { it.toByte() }
+    data.setIntAt(1, 0x12345678)
+    data.setLongAt(4091, -2L)
+    val path = writeTempFile("mapped_file", data)
+    try {
+        MappedFile.open(path, MappedFile.Advice.SEQUENTIAL).use { file ->
+            assertEquals(4099L, file.size)
+            assertEquals(0.toByte(), file[0])
+            assertEquals(0x12345678, file.getIntAt(1))
+            assertEquals(data.getShortAt(2), file.getShortAt(2))
+            assertEquals(-2L, file.getLongAt(4091))
+            assertEquals(data.getDoubleAt(100), file.getDoubleAt(100))
+            assertFailsWith<ArrayIndexOutOfBoundsException> { file.getLongAt(4092) }
+            assertFailsWith<ArrayIndexOutOfBoundsException> { file[-1] }
+
+            val copy = file.copyInto(ByteArray(10), 2, 4000, 4008)
+            assertEquals(data[4000], copy[2])
+            assertEquals(data[4007], copy[9])
+            assertEquals(data[4000], file.asCPointer(4000).pointed.value)
+
+            file.advise(MappedFile.Advice.RANDOM)
+            file.close()
+            assertTrue(file.isClosed)
+            assertFailsWith<IllegalStateException> { file.getIntAt(0) }
+        }
+
+        // A frozen file cannot be closed, it is unmapped by its cleaner instead.
+        val frozen = MappedFile.open(path).freeze()
+        assertEquals(0x12345678, frozen.getIntAt(1))
+        if (Platform.memoryModel != MemoryModel.EXPERIMENTAL) {
+            assertFailsWith<InvalidMutabilityException> { frozen.close() }
+            assertFalse(frozen.isClosed)
+        }
+    } finally {
+        remove(path)
+    }
+
+    val emptyPath = writeTempFile("mapped_file_empty", ByteArray(0))
+    try {
+        MappedFile.open(emptyPath).use { file ->
+            assertEquals(0L, file.size)
+            assertFailsWith<ArrayIndexOutOfBoundsException> { file[0] }
+        }
+    } finally {
+        remove(emptyPath)
+    }
+
+    assertFailsWith<IllegalArgumentException> { MappedFile.open("$path.does-not-exist") }
+    println("OK")
+}
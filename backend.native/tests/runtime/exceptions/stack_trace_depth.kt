@@ -0,0 +1,57 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+@file:OptIn(ExperimentalStdlibApi::class)
+
+package runtime.exceptions.stack_trace_depth
+
+import kotlin.native.Platform
+import kotlin.test.*
+
+var unwoundFrames = 0
+
+fun throwAt(depth: Int) {
+    if (depth == 0) throw IllegalStateException("deep")
+    // Keeps the recursive call from being turned into a loop.
+    try {
+        throwAt(depth - 1)
+    } finally {
+        unwoundFrames++
+    }
+}
+
+fun captureStackTrace(depth: Int): Array<String> =
+        assertFailsWith<IllegalStateException> { throwAt(depth) }.getStackTrace()
+
+fun testDepth() {
+    assertEquals(Int.MAX_VALUE, Platform.stackTraceDepth)
+    // Deeper than the on-stack capture buffer.
+    assertTrue(captureStackTrace(300).size > 300)
+
+    Platform.stackTraceDepth = 5
+    assertEquals(5, captureStackTrace(300).size)
+
+    Platform.stackTraceDepth = 0
+    assertEquals(0, captureStackTrace(10).size)
+    assertFailsWith<IllegalArgumentException> { Platform.stackTraceDepth = -1 }
+}
+
+fun testFramePointers() {
+    Platform.isFramePointerStackTraceActive = true
+    // Stays off on architectures without frame pointer walking.
+    if (!Platform.isFramePointerStackTraceActive) return
+    // Unoptimized code keeps frame pointers, so the walk finds every frame of the recursion.
+    assertEquals(101, captureStackTrace(100).count { "throwAt" in it })
+
+    Platform.stackTraceDepth = 50
+    assertEquals(50, captureStackTrace(100).size)
+
+    Platform.isFramePointerStackTraceActive = false
+}
+
+fun main(args: Array<String>) {
+    if ("frame_pointers" in args) testFramePointers() else testDepth()
+    println("OK")
+}
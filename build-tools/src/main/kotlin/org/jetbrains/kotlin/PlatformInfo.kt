@@ -26,6 +26,9 @@ object PlatformInfo {
     @JvmStatic
     fun isWindowsTarget(project: Project) = getTarget(project).family == Family.MINGW
 
+    @JvmStatic
+    fun isLinuxTarget(project: Project) = getTarget(project).family == Family.LINUX
+
     @JvmStatic
     fun isWasmTarget(project: Project) =
         getTarget(project).family == Family.WASM
@@ -98,4 +98,6 @@ public actual class AtomicRef<T> internal constructor(value: T) {
     }
 }
 
-public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(initial)
\ No newline at end of file
+public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(initial)
+
+public actual fun <T> freezeGraph(value: T): T = value
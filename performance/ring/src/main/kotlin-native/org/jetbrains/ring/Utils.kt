@@ -50,4 +50,6 @@ public actual class AtomicRef<T> constructor(@PublishedApi internal val a: KAtom
     override fun toString(): String = value.toString()
 }
 
-public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
\ No newline at end of file
+public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
+
+public actual fun <T> freezeGraph(value: T): T = value.freeze()
@@ -210,6 +210,9 @@ class RingLauncher : Launcher() {
                     "Casts.interfaceCast" to BenchmarkEntryWithInit.create(::CastsBenchmark, { interfaceCast() }),
                     "LocalObjects.localArray" to BenchmarkEntryWithInit.create(::LocalObjectsBenchmark, { localArray() }),
                     "LinkedListWithAtomicsBenchmark" to BenchmarkEntryWithInit.create(::LinkedListWithAtomicsBenchmark, { ensureNext() }),
+                    "Freeze.freezeTree" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeTree() }),
+                    "Freeze.freezeRing" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeRing() }),
+                    "Freeze.freezeListOfCycles" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeListOfCycles() }),
                     "Inheritance.baseCalls" to BenchmarkEntryWithInit.create(::InheritanceBenchmark, { baseCalls() })
             )
     )
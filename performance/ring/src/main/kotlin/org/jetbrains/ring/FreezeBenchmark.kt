@@ -0,0 +1,57 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.ring
+
+import org.jetbrains.benchmarksLauncher.Blackhole
+import org.jetbrains.benchmarksLauncher.Random
+
+// A frozen graph cannot be frozen again, so every iteration builds a new one.
+open class FreezeBenchmark {
+    class TreeNode(val value: Int, val left: TreeNode?, val right: TreeNode?)
+
+    class GraphNode(val value: Int) {
+        var next: GraphNode? = null
+        var other: GraphNode? = null
+    }
+
+    private fun buildTree(from: Int, to: Int): TreeNode? {
+        if (from >= to) return null
+        val middle = (from + to) / 2
+        return TreeNode(middle, buildTree(from, middle), buildTree(middle + 1, to))
+    }
+
+    private fun buildNodes(): Array<GraphNode> = Array(BENCHMARK_SIZE) { GraphNode(it) }
+
+    //Benchmark
+    fun freezeTree() {
+        val tree = buildTree(0, BENCHMARK_SIZE)!!
+        Blackhole.consume(freezeGraph(tree))
+    }
+
+    // The whole graph is a single strongly connected component.
+    //Benchmark
+    fun freezeRing() {
+        val nodes = buildNodes()
+        for (i in nodes.indices) {
+            nodes[i].next = nodes[(i + 1) % nodes.size]
+            nodes[i].other = nodes[Random.nextInt(nodes.size)]
+        }
+        Blackhole.consume(freezeGraph(nodes))
+    }
+
+    // A list of many small strongly connected components.
+    //Benchmark
+    fun freezeListOfCycles() {
+        val nodes = buildNodes()
+        for (i in 0 until nodes.size - 1 step 2) {
+            val pair = nodes[i + 1]
+            nodes[i].other = pair
+            pair.other = nodes[i]
+            if (i + 2 < nodes.size) pair.next = nodes[i + 2]
+        }
+        Blackhole.consume(freezeGraph(nodes[0]))
+    }
+}
@@ -41,3 +41,9 @@ expect class AtomicRef<T> {
 }
 
 public expect fun <T> atomic(initial: T): AtomicRef<T>
+
+
+/**
+ * Makes the object graph reachable from [value] immutable, where the platform supports it.
+ */
+public expect fun <T> freezeGraph(value: T): T
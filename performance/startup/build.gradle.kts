@@ -1,6 +1,8 @@
 import org.jetbrains.kotlin.gradle.plugin.mpp.NativeBuildType
 import org.jetbrains.kotlin.RunKotlinNativeTask
 import org.jetbrains.kotlin.BenchmarkRepeatingType
+import org.jetbrains.kotlin.gradle.plugin.mpp.KotlinNativeTarget
+import java.io.ByteArrayOutputStream
 
 /*
  * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
@@ -12,14 +14,120 @@ plugins {
 }
 
 val defaultBuildType = NativeBuildType.RELEASE
+val benchmarkBuildType = (findProperty("nativeBuildType") as String?)?.let { NativeBuildType.valueOf(it) } ?: defaultBuildType
+
+// Globals.initialize reads top-level properties spread over several files. The benchmark executable initializes them
+// eagerly, before `main`, so there it is a warm read. To compare cold starts, the same program is also linked with
+// lazily initialized top-level properties, and konanRunColdStart times whole runs of both executables.
+val lazyGlobalsExecutableName = "benchmarkLazyGlobals"
+val coldStartAttempts = findProperty("coldStartAttempts")?.toString()?.toInt() ?: 20
+
+val generateGlobalsInit by tasks.registering {
+    val fileCount = 4
+    val globalsPerFile = 250
+    val outputDir = file("$buildDir/generated/globalsInit")
+    outputs.dir(outputDir)
+
+    doLast {
+        val packageDir = outputDir.resolve("org/jetbrains/startup")
+        packageDir.deleteRecursively()
+        packageDir.mkdirs()
+        val header = """
+            |/*
+            | * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+            | * that can be found in the LICENSE file.
+            | */
+            |
+            |// Generated by the generateGlobalsInit task.
+            |
+            |package org.jetbrains.startup
+            |
+            |""".trimMargin()
+        val importLine = "import org.jetbrains.benchmarksLauncher.BenchmarkEntryManual\n\n"
+        val globalCount = fileCount * globalsPerFile
+        for (fileIndex in 0 until fileCount) {
+            packageDir.resolve("GlobalsInit$fileIndex.kt").writeText(buildString {
+                append(header)
+                for (index in fileIndex * globalsPerFile until (fileIndex + 1) * globalsPerFile) {
+                    append("internal val global$index = listOf($index, ${index + 1}).sum()\n")
+                }
+            })
+        }
+        packageDir.resolve("GlobalsInitBenchmark.kt").writeText(buildString {
+            append(header)
+            append(importLine)
+            append("private var globalsInitializeRun = false\n\n")
+            append("private fun globalsInitialize(): Int {\n")
+            append("    if (globalsInitializeRun) {\n")
+            append("        error(\"Function globalsInitialize can be called only once.\")\n")
+            append("    }\n")
+            append("    globalsInitializeRun = true\n\n")
+            append("    var total = 0\n")
+            for (index in 0 until globalCount) {
+                append("    total += global$index\n")
+            }
+            append("    return total\n")
+            append("}\n\n")
+            append("val globalsBenchmarks = mapOf(\"Globals.initialize\" to BenchmarkEntryManual(::globalsInitialize))\n")
+        })
+    }
+}
 
 benchmark {
     applicationName = "Startup"
-    commonSrcDirs = listOf("../../tools/benchmarks/shared/src/main/kotlin/report", "src/main/kotlin", "../shared/src/main/kotlin")
+    commonSrcDirs = listOf("../../tools/benchmarks/shared/src/main/kotlin/report", "src/main/kotlin", "../shared/src/main/kotlin", generateGlobalsInit)
     jvmSrcDirs = listOf("../shared/src/main/kotlin-jvm")
     nativeSrcDirs = listOf("../shared/src/main/kotlin-native/common")
     mingwSrcDirs = listOf("../shared/src/main/kotlin-native/mingw")
     posixSrcDirs = listOf("../shared/src/main/kotlin-native/posix")
-    buildType = (findProperty("nativeBuildType") as String?)?.let { NativeBuildType.valueOf(it) } ?: defaultBuildType
+    buildType = benchmarkBuildType
     repeatingType = BenchmarkRepeatingType.EXTERNAL
 }
+
+val nativeTarget = kotlin.targets.getByName<KotlinNativeTarget>("native")
+
+nativeTarget.binaries.executable(lazyGlobalsExecutableName, listOf(benchmarkBuildType)) {
+    runTask?.enabled = false
+    // The benchmark plugin configures its executable after evaluation, so copy the settings after that.
+    project.afterEvaluate {
+        val eagerExecutable = nativeTarget.binaries.getExecutable("benchmark", benchmarkBuildType)
+        linkerOpts.addAll(eagerExecutable.linkerOpts)
+        freeCompilerArgs = eagerExecutable.freeCompilerArgs + "-Xlazy-global-initialization"
+    }
+}
+
+// Each run is a new process, so it includes runtime startup and, with eager initialization, all top-level properties.
+// `list` only starts the program, Globals.initialize also reads every generated property.
+val konanRunColdStart by tasks.registering {
+    group = "benchmarking"
+    description = "Compares cold starts with eagerly and lazily initialized top-level properties."
+    val executables = listOf(
+            "eager" to nativeTarget.binaries.getExecutable("benchmark", benchmarkBuildType),
+            "lazy" to nativeTarget.binaries.getExecutable(lazyGlobalsExecutableName, benchmarkBuildType)
+    )
+    dependsOn(executables.map { (_, executable) -> executable.linkTask })
+    val reportFile = file("$buildDir/coldStart.txt")
+    outputs.file(reportFile)
+
+    doLast {
+        val scenarios = listOf(
+                "Startup" to listOf("list"),
+                "Globals.initialize" to listOf("-f", "Globals.initialize", "-w", "0", "-r", "1")
+        )
+        val report = scenarios.flatMap { (scenario, args) ->
+            executables.map { (mode, executable) ->
+                val times = List(coldStartAttempts) {
+                    val start = System.nanoTime()
+                    project.exec {
+                        commandLine(listOf(executable.outputFile.absolutePath) + args)
+                        standardOutput = ByteArrayOutputStream()
+                    }
+                    (System.nanoTime() - start) / 1000
+                }.sorted()
+                "$scenario.coldStart ($mode): median ${times[times.size / 2]} us, min ${times.first()} us"
+            }
+        }
+        report.forEach { println(it) }
+        reportFile.writeText(report.joinToString("\n", postfix = "\n"))
+    }
+}
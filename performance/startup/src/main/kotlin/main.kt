@@ -9,10 +9,10 @@ import kotlinx.cli.*
 
 class StartupLauncher : Launcher() {
     override val benchmarks = BenchmarksCollection(
-      mutableMapOf(
+      mutableMapOf<String, AbstractBenchmarkEntry>(
           "Singleton.initialize" to BenchmarkEntryManual(::singletonInitialize),
           "Singleton.initializeNested" to BenchmarkEntryManual(::singletonInitializeNested),
-      )
+      ).apply { putAll(globalsBenchmarks) }
     )
 }
 
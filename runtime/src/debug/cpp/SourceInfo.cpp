@@ -204,6 +204,160 @@ extern "C" struct SourceInfo Kotlin_getSourceInfo(void* addr) {
   return result;
 }
 
+#elif KONAN_LINUX && USE_ELF_SYMBOLS
+
+#include <elf.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <link.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+
+#include "DwarfLineTable.hpp"
+#include "Mutex.hpp"
+
+#if ELFSIZE == 32
+#define Elf_Ehdr        Elf32_Ehdr
+#define Elf_Shdr        Elf32_Shdr
+#elif ELFSIZE == 64
+#define Elf_Ehdr        Elf64_Ehdr
+#define Elf_Shdr        Elf64_Shdr
+#else
+#error "Impossible ELFSIZE"
+#endif
+
+namespace {
+
+// Line table of the ELF module containing the runtime, and hence the Kotlin code: the executable,
+// or the shared library for dynamic library builds.
+struct ModuleLineTable {
+  kotlin::DwarfLineTable table;
+  // Run time minus link time addresses, non-zero for PIE and shared libraries.
+  uintptr_t loadBias = 0;
+  // Run time addresses of the module's loaded segments.
+  uintptr_t low = UINTPTR_MAX;
+  uintptr_t high = 0;
+};
+
+std::atomic<ModuleLineTable*> moduleLineTable{nullptr};
+kotlin::SpinLock moduleLineTableLock;
+
+struct ModuleInfo {
+  ModuleLineTable* module;
+  char path[PATH_MAX];
+};
+
+// Finds the module with this function in it.
+int findModule(struct dl_phdr_info* info, size_t, void* data) {
+  auto* result = static_cast<ModuleInfo*>(data);
+  auto self = reinterpret_cast<uintptr_t>(&Kotlin_getSourceInfo);
+  uintptr_t low = UINTPTR_MAX;
+  uintptr_t high = 0;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const auto& segment = info->dlpi_phdr[i];
+    if (segment.p_type != PT_LOAD) continue;
+    uintptr_t begin = info->dlpi_addr + segment.p_vaddr;
+    if (begin < low) low = begin;
+    if (begin + segment.p_memsz > high) high = begin + segment.p_memsz;
+  }
+  if (self < low || self >= high) return 0;
+  result->module->loadBias = info->dlpi_addr;
+  result->module->low = low;
+  result->module->high = high;
+  // The executable has an empty name.
+  const char* path = info->dlpi_name != nullptr && info->dlpi_name[0] != '\0' ? info->dlpi_name : "/proc/self/exe";
+  strncpy(result->path, path, sizeof(result->path) - 1);
+  return 1;
+}
+
+// Debug sections are not loaded during regular execution, so the file has to be mapped again.
+void readLineTable(ModuleLineTable* module, const char* path) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  struct stat fileStat;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &fileStat) == 0 && static_cast<size_t>(fileStat.st_size) >= sizeof(Elf_Ehdr)) {
+    mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) return;
+
+  const char* base = static_cast<const char*>(mapping);
+  size_t size = fileStat.st_size;
+  auto* ehdr = reinterpret_cast<const Elf_Ehdr*>(base);
+  bool valid = memcmp(ehdr->e_ident, ELFMAG, SELFMAG) == 0 && ehdr->e_shoff + ehdr->e_shnum * sizeof(Elf_Shdr) <= size &&
+      ehdr->e_shstrndx < ehdr->e_shnum;
+  if (valid) {
+    auto* shdr = reinterpret_cast<const Elf_Shdr*>(base + ehdr->e_shoff);
+    const Elf_Shdr& names = shdr[ehdr->e_shstrndx];
+    kotlin::DwarfLineTable::Sections sections;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+      const Elf_Shdr& section = shdr[i];
+      // Compressed debug sections are not supported.
+      if (section.sh_type == SHT_NOBITS || (section.sh_flags & SHF_COMPRESSED) != 0) continue;
+      if (section.sh_offset + section.sh_size > size || section.sh_name >= names.sh_size) continue;
+      const char* name = base + names.sh_offset + section.sh_name;
+      auto* data = reinterpret_cast<const uint8_t*>(base + section.sh_offset);
+      if (strcmp(name, ".debug_line") == 0) {
+        sections.debugLine = data;
+        sections.debugLineSize = section.sh_size;
+      } else if (strcmp(name, ".debug_line_str") == 0) {
+        sections.debugLineStr = data;
+        sections.debugLineStrSize = section.sh_size;
+      } else if (strcmp(name, ".debug_str") == 0) {
+        sections.debugStr = data;
+        sections.debugStrSize = section.sh_size;
+      }
+    }
+    module->table = kotlin::DwarfLineTable(sections);
+  }
+  // The table keeps copies of everything it needs.
+  munmap(mapping, size);
+}
+
+ModuleLineTable* buildModuleLineTable() {
+  ModuleInfo info = {};
+  info.module = konanConstructInstance<ModuleLineTable>();
+  if (dl_iterate_phdr(findModule, &info) != 0) {
+    readLineTable(info.module, info.path);
+  }
+  return info.module;
+}
+
+ModuleLineTable* lineTable() {
+  ModuleLineTable* module = moduleLineTable.load(std::memory_order_acquire);
+  if (module != nullptr) return module;
+  std::lock_guard<kotlin::SpinLock> guard(moduleLineTableLock);
+  module = moduleLineTable.load(std::memory_order_relaxed);
+  if (module == nullptr) {
+    module = buildModuleLineTable();
+    moduleLineTable.store(module, std::memory_order_release);
+  }
+  return module;
+}
+
+} // namespace
+
+extern "C" struct SourceInfo Kotlin_getSourceInfo(void* addr) {
+  SourceInfo result = { .fileName = nullptr, .lineNumber = -1, .column = -1 };
+  ModuleLineTable* module = lineTable();
+  auto address = reinterpret_cast<uintptr_t>(addr);
+  if (address <= module->low || address > module->high) return result;
+  // Stack traces hold return addresses, which may already belong to the next line: look up the call instruction.
+  kotlin::DwarfLineTable::Location location;
+  if (module->table.Find(address - 1 - module->loadBias, &location) && location.fileName != nullptr) {
+    result.fileName = location.fileName;
+    result.lineNumber = location.line;
+    result.column = location.column;
+  }
+  return result;
+}
+
 #else // KONAN_CORE_SYMBOLICATION
 
 extern "C" struct SourceInfo Kotlin_getSourceInfo(void* addr) {
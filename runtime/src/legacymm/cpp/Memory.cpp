@@ -17,8 +17,11 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <cstddef> // for offsetof
+#include <limits>
 #include <mutex>
+#include <thread>
 
 // Allow concurrent global cycle collector.
 #define USE_CYCLIC_GC 0
@@ -32,6 +35,7 @@
 #endif
 
 #include "Alloc.h"
+#include "AllocationProfiler.hpp"
 #include "KAssert.h"
 #include "Atomic.h"
 #include "Cleaner.h"
@@ -42,6 +46,7 @@
 #include "FinalizerHooks.hpp"
 #include "FreezeHooks.hpp"
 #include "KString.h"
+#include "LeakReporter.hpp"
 #include "Memory.h"
 #include "MemoryPrivate.hpp"
 #include "Mutex.hpp"
@@ -49,6 +54,7 @@
 #include "ObjectTraversal.hpp"
 #include "Porting.h"
 #include "Runtime.h"
+#include "TypeCounters.hpp"
 #include "Utils.hpp"
 #include "WorkerBoundReference.h"
 #include "Weak.h"
@@ -120,6 +126,12 @@ constexpr size_t kMaxToFreeSizeThreshold = 8 * 1024;
 constexpr size_t kMaxErgonomicToFreeSizeThreshold = 8 * 1024 * 1024;
 // How many elements in finalizer queue allowed before cleaning it up.
 constexpr int32_t kFinalizerQueueThreshold = 32;
+// Single object containers up to that size are kept for reuse after finalization.
+constexpr size_t kMaxRecycledContainerSize = 256;
+// Number of size classes of recycled containers, one per kObjectAlignment step.
+constexpr size_t kRecycledContainerClasses = kMaxRecycledContainerSize / kObjectAlignment + 1;
+// How many free containers of a single size class are kept for reuse.
+constexpr int32_t kMaxRecycledContainersPerClass = 32;
 // If allocated that much memory since last GC - force new GC.
 constexpr size_t kMaxGcAllocThreshold = 8 * 1024 * 1024;
 // If the ratio of GC collection cycles time to program execution time is greater this value,
@@ -207,8 +219,22 @@ class CycleDetector : private kotlin::Pinned, public KonanAllocatorAware {
       instance().removeCandidate(object);
   }
 
+  static void insertStableRefIfNeeded(KRef object) {
+    if (isEnabled())
+      instance().insertStableRef(object);
+  }
+
+  static void removeStableRef(KRef object) {
+    // The leak checker could have been disabled after the stable ref was created, so always look for it.
+    instance().removeStableRefEntry(object);
+  }
+
   static CycleDetectorRootset collectRootset();
 
+  // Stable refs and candidates are what keeps objects alive after the runtime is destroyed, unless
+  // there is a bug in the memory manager.
+  static void collectLeakRoots(kotlin::LeakReporter& reporter);
+
  private:
   CycleDetector() = default;
   ~CycleDetector() = default;
@@ -219,10 +245,12 @@ class CycleDetector : private kotlin::Pinned, public KonanAllocatorAware {
     return *result;
   }
 
+  static bool isEnabled() {
+    return KonanNeedDebugInfo && Kotlin_memoryLeakCheckerEnabled();
+  }
+
   static bool canBeACandidate(KRef object) {
-    return KonanNeedDebugInfo &&
-        Kotlin_memoryLeakCheckerEnabled() &&
-        (object->type_info()->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0;
+    return isEnabled() && (object->type_info()->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0;
   }
 
   void insertCandidate(KRef candidate) {
@@ -242,10 +270,29 @@ class CycleDetector : private kotlin::Pinned, public KonanAllocatorAware {
     candidateInList_.erase(it);
   }
 
+  void insertStableRef(KRef object) {
+    std::lock_guard<kotlin::SpinLock> guard(lock_);
+
+    ++stableRefs_[object];
+  }
+
+  void removeStableRefEntry(KRef object) {
+    std::lock_guard<kotlin::SpinLock> guard(lock_);
+
+    // The leak checker could have been enabled after the stable ref was created.
+    auto it = stableRefs_.find(object);
+    if (it == stableRefs_.end())
+      return;
+    if (--it->second == 0)
+      stableRefs_.erase(it);
+  }
+
   kotlin::SpinLock lock_;
   using CandidateList = KStdList<KRef>;
   CandidateList candidateList_;
   KStdUnorderedMap<KRef, CandidateList::iterator> candidateInList_;
+  // Number of stable refs to each object.
+  KStdUnorderedMap<KRef, int> stableRefs_;
 };
 
 #endif  // USE_CYCLE_DETECTOR
@@ -323,6 +370,10 @@ public:
     containerAllocs[1]++;
   }
 
+  void incRecycle(bool hit) {
+    if (hit) allocCacheHit++; else allocCacheMiss++;
+  }
+
   void incAlloc(size_t size, const ObjHeader* header) {
     objectAllocs[toIndex(header, 0)]++;
   }
@@ -355,6 +406,9 @@ public:
     konan::consolePrintf("\nMemory manager statistic:\n\n");
     konan::consolePrintf("Container alloc: %lld, free: %lld\n",
                            containerAllocs[0], containerAllocs[1]);
+    konan::consolePrintf("Container recycle hits: %d, misses: %d (%.2lf%% hit rate)\n",
+                           allocCacheHit, allocCacheMiss,
+                           percents(allocCacheHit, allocCacheHit + allocCacheMiss));
     for (int i = 0; i < 6; i++) {
       // Only local, shared and frozen can be allocated.
       if (i == 0 || i == 3 || i == 4)
@@ -614,12 +668,13 @@ public:
     void Init() noexcept { map_ = konanConstructInstance<Map>(); }
 
     void Deinit() noexcept {
-        RuntimeAssert(map_->size() == 0, "Must be already cleared");
+        RuntimeAssert(!committed_, "Must be already cleared");
+        if (storage_ != nullptr) konanFreeMemory(storage_);
         konanDestructInstance(map_);
     }
 
     void Add(Key key, int size) noexcept {
-        RuntimeAssert(storage_ == nullptr, "Storage must not be committed");
+        RuntimeAssert(!committed_, "Storage must not be committed");
         auto it = map_->find(key);
         if (it != map_->end()) {
             RuntimeAssert(it->second.size == size, "Attempt to add TLS record with the same key and different size");
@@ -630,21 +685,27 @@ public:
     }
 
     void Commit() noexcept {
-        RuntimeAssert(storage_ == nullptr, "Cannot commit storage twice");
-        storage_ = reinterpret_cast<KRef*>(konanAllocMemory(size_ * sizeof(KRef)));
+        RuntimeAssert(!committed_, "Cannot commit storage twice");
+        if (storage_ == nullptr || capacity_ < size_) {
+            if (storage_ != nullptr) konanFreeMemory(storage_);
+            storage_ = reinterpret_cast<KRef*>(konanAllocMemory(size_ * sizeof(KRef)));
+            capacity_ = size_;
+        }
+        committed_ = true;
     }
 
+    // Records and the storage block are kept: every thread registers the same records, so
+    // a thread reusing this storage after `Clear` finds them already in place.
     void Clear() noexcept {
-        RuntimeAssert(storage_ != nullptr, "Storage must be committed");
+        RuntimeAssert(committed_, "Storage must be committed");
         for (int i = 0; i < size_; ++i) {
             UpdateHeapRef(storage_ + i, nullptr);
         }
-        konanFreeMemory(storage_);
-        map_->clear();
+        committed_ = false;
     }
 
     KRef* Lookup(Key key, int index) noexcept {
-        RuntimeAssert(storage_ != nullptr, "Storage must be committed");
+        RuntimeAssert(committed_, "Storage must be committed");
         // In many cases there is only one module, so this is one element cache.
         if (lastKey_ == key) {
             return storage_ + lastOffset_ + index;
@@ -669,10 +730,53 @@ private:
     Map* map_ = nullptr;
     KRef* storage_ = nullptr;
     int size_ = 0;
+    int capacity_ = 0;
+    bool committed_ = false;
     int lastOffset_ = 0;
     Key lastKey_ = nullptr;
 };
 
+#if USE_GC
+// Positions of containers in a GC list, which is only appended to until it is emptied.
+// Entries are indexed lazily, on lookup, so each of them is hashed at most once however many subgraphs are
+// detached, while detaching a subgraph costs the list growth since the previous detach, not the list size.
+class ContainerPositions {
+ public:
+  // Calls `block` with the position of every entry of `list` still holding `container` and forgets them.
+  // Entries marked as removed never match, as their pointers are tagged.
+  template <typename F>
+  void extract(const ContainerHeaderList& list, ContainerHeader* container, F&& block) {
+    RuntimeAssert(previous_.size() <= list.size(), "The list must not shrink without reset()");
+    for (size_t index = previous_.size(); index < list.size(); ++index) {
+      auto it = last_.emplace(list[index], kNone).first;
+      previous_.push_back(it->second);
+      it->second = index;
+    }
+    auto it = last_.find(container);
+    if (it == last_.end()) return;
+    for (size_t index = it->second; index != kNone; index = previous_[index]) {
+      if (list[index] == container) block(index);
+    }
+    last_.erase(it);
+  }
+
+  // Must be called when the list is emptied.
+  void reset() {
+    if (previous_.empty()) return;
+    last_.clear();
+    previous_.clear();
+  }
+
+ private:
+  static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+  // The last position of each container.
+  KStdUnorderedMap<ContainerHeader*, size_t> last_;
+  // The previous position of the same container for every indexed position.
+  KStdVector<size_t> previous_;
+};
+#endif  // USE_GC
+
 } // namespace
 
 struct MemoryState {
@@ -688,6 +792,9 @@ struct MemoryState {
   ContainerHeader* finalizerQueue;
   int finalizerQueueSize;
   int finalizerQueueSuspendCount;
+  // Finalized containers kept for reuse - linked lists indexed by size class.
+  ContainerHeader* recycledContainers[kRecycledContainerClasses];
+  int32_t recycledContainersCount[kRecycledContainerClasses];
   /*
    * Typical scenario for GC is as following:
    * we have 90% of objects with refcount = 0 which will be deleted during
@@ -708,6 +815,9 @@ struct MemoryState {
   bool gcInProgress;
   // Objects to be released.
   ContainerHeaderList* toRelease;
+  // Where visited containers are in toFree and toRelease when detaching subgraphs.
+  ContainerPositions toFreePositions;
+  ContainerPositions toReleasePositions;
 
   ForeignRefManager* foreignRefManager;
 
@@ -722,6 +832,8 @@ struct MemoryState {
 
   // A stack of initializing singletons.
   KStdVector<std::pair<ObjHeader**, ObjHeader*>> initializingSingletons;
+  // A stack of files with lazily initialized globals, which are being initialized.
+  KStdVector<int32_t*> initializingFiles;
 
   bool isMainThread = false;
 
@@ -729,6 +841,8 @@ struct MemoryState {
   #define CONTAINER_ALLOC_STAT(state, size, container) state->statistic.incAlloc(size, container);
   #define CONTAINER_DESTROY_STAT(state, container) \
     state->statistic.incFree(container);
+  #define CONTAINER_RECYCLE_STAT(state, hit) \
+    state->statistic.incRecycle(hit);
   #define OBJECT_ALLOC_STAT(state, size, object) \
     state->statistic.incAlloc(size, object); \
     state->statistic.incAddRef(containerFor(object), 0, 0);
@@ -748,6 +862,7 @@ struct MemoryState {
 #else
   #define CONTAINER_ALLOC_STAT(state, size, container)
   #define CONTAINER_DESTROY_STAT(state, container)
+  #define CONTAINER_RECYCLE_STAT(state, hit)
   #define OBJECT_ALLOC_STAT(state, size, object)
   #define UPDATE_REF_STAT(state, oldRef, newRef, slot, stack)
   #define UPDATE_ADDREF_STAT(state, obj, atomic, stack)
@@ -795,6 +910,9 @@ namespace {
 #define CONTAINER_DESTROY_EVENT(state, container) \
   CONTAINER_DESTROY_STAT(state, container) \
   CONTAINER_DESTROY_TRACE(state, container)
+// Called on container allocation attempting to reuse a finalized container.
+#define CONTAINER_RECYCLE_EVENT(state, hit) \
+  CONTAINER_RECYCLE_STAT(state, hit)
 // Object was just allocated.
 #define OBJECT_ALLOC_EVENT(state, size, object) \
   OBJECT_ALLOC_STAT(state, size, object) \
@@ -1035,28 +1153,45 @@ inline bool isFreezableAtomic(ContainerHeader* container) {
   return isFreezableAtomic(obj);
 }
 
+#if USE_GC
+
+// `size` is the allocated size of a container, which allocContainer() always rounds up to kObjectAlignment,
+// so all containers of a class have exactly the same capacity and are interchangeable.
+inline size_t recycledContainerClass(size_t size) {
+  RuntimeAssert(size % kObjectAlignment == 0, "Container size %zu is not aligned", size);
+  return size / kObjectAlignment;
+}
+
+void releaseRecycledContainers(MemoryState* state) {
+  for (size_t sizeClass = 0; sizeClass < kRecycledContainerClasses; ++sizeClass) {
+    while (state->recycledContainers[sizeClass] != nullptr) {
+      auto* container = state->recycledContainers[sizeClass];
+      state->recycledContainers[sizeClass] = container->nextLink();
+      konanFreeMemory(container);
+      atomicAdd(&allocCount, -1);
+    }
+    state->recycledContainersCount[sizeClass] = 0;
+  }
+}
+
+#endif  // USE_GC
+
 ContainerHeader* allocContainer(MemoryState* state, size_t size) {
  ContainerHeader* result = nullptr;
+ // Real container sizes may be only 4-aligned on 32-bit targets, the allocated ones never are.
+ size = alignUp(size, kObjectAlignment);
 #if USE_GC
-  // We recycle elements of finalizer queue for new allocations, to avoid trashing memory manager.
-  ContainerHeader* container = state != nullptr ? state->finalizerQueue : nullptr;
-  ContainerHeader* previous = nullptr;
-  while (container != nullptr) {
-    // TODO: shall it be == instead?
-    if (container->hasContainerSize() &&
-        container->containerSize() >= size && container->containerSize() <= size + 16) {
-      MEMORY_LOG("recycle %p for request %d\n", container, size)
-      result = container;
-      if (previous == nullptr)
-        state->finalizerQueue = container->nextLink();
-      else
-        previous->setNextLink(container->nextLink());
-      state->finalizerQueueSize--;
-      memset(container, 0, size);
-      break;
+  // We recycle finalized containers for new allocations, to avoid trashing memory manager.
+  if (state != nullptr && size <= kMaxRecycledContainerSize) {
+    auto sizeClass = recycledContainerClass(size);
+    result = state->recycledContainers[sizeClass];
+    if (result != nullptr) {
+      MEMORY_LOG("recycle %p for request %d\n", result, size)
+      state->recycledContainers[sizeClass] = result->nextLink();
+      state->recycledContainersCount[sizeClass]--;
+      memset(result, 0, size);
     }
-    previous = container;
-    container = container->nextLink();
+    CONTAINER_RECYCLE_EVENT(state, result != nullptr)
   }
 #endif
   if (result == nullptr) {
@@ -1064,7 +1199,7 @@ ContainerHeader* allocContainer(MemoryState* state, size_t size) {
     if (state != nullptr)
         state->allocSinceLastGc += size;
 #endif
-    result = konanConstructSizedInstance<ContainerHeader>(alignUp(size, kObjectAlignment));
+    result = konanConstructSizedInstance<ContainerHeader>(size);
     atomicAdd(&allocCount, 1);
   }
   if (state != nullptr) {
@@ -1096,7 +1231,6 @@ ContainerHeader* allocAggregatingFrozenContainer(KStdVector<ContainerHeader*>& c
 #if USE_GC
 
 void processFinalizerQueue(MemoryState* state) {
-  // TODO: reuse elements of finalizer queue for new allocations.
   while (state->finalizerQueue != nullptr) {
     auto* container = state->finalizerQueue;
     state->finalizerQueue = container->nextLink();
@@ -1105,27 +1239,51 @@ void processFinalizerQueue(MemoryState* state) {
     state->containers->erase(container);
 #endif
     CONTAINER_DESTROY_EVENT(state, container)
+    // Aggregating frozen containers have no size, and those of a single object always have a non-zero one.
+    // Recycle by the allocated size, not the stored one, which is not rounded up.
+    size_t size = container->hasContainerSize() ? alignUp(container->containerSize(), kObjectAlignment) : 0;
+    if (size != 0 && size <= kMaxRecycledContainerSize) {
+      auto sizeClass = recycledContainerClass(size);
+      if (state->recycledContainersCount[sizeClass] < kMaxRecycledContainersPerClass) {
+        container->setNextLink(state->recycledContainers[sizeClass]);
+        state->recycledContainers[sizeClass] = container;
+        state->recycledContainersCount[sizeClass]++;
+        continue;
+      }
+    }
     konanFreeMemory(container);
     atomicAdd(&allocCount, -1);
   }
   RuntimeAssert(state->finalizerQueueSize == 0, "Queue must be empty here");
 }
 
-bool hasExternalRefs(ContainerHeader* start, ContainerHeaderSet* visited) {
-  ContainerHeaderDeque toVisit;
-  toVisit.push_back(start);
-  while (!toVisit.empty()) {
-    auto* container = toVisit.front();
-    toVisit.pop_front();
-    visited->insert(container);
+inline void resetSeen(ContainerHeaderList* containers, size_t from = 0) {
+  for (size_t index = from; index < containers->size(); ++index) {
+    (*containers)[index]->resetSeen();
+  }
+}
+
+// Visits containers reachable from `start` in breadth-first order, until one with external references is seen.
+// Visited containers are appended to `visited`, which also serves as the work queue, and get the 'seen' bit.
+// It must be reset with resetSeen() once the caller is done with `visited`.
+bool hasExternalRefs(ContainerHeader* start, ContainerHeaderList* visited) {
+  RuntimeAssert(visited->empty(), "Must start with an empty list");
+  start->setSeen();
+  visited->push_back(start);
+  for (size_t index = 0; index < visited->size(); ++index) {
+    auto* container = (*visited)[index];
     if (container->refCount() > 0) {
       MEMORY_LOG("container %p with rc %d blocks transfer\n", container, container->refCount())
+      // Only keep containers actually visited.
+      resetSeen(visited, index + 1);
+      visited->resize(index + 1);
       return true;
     }
-    traverseContainerReferredObjects(container, [&toVisit, visited](ObjHeader* ref) {
+    traverseContainerReferredObjects(container, [visited](ObjHeader* ref) {
         auto* child = containerFor(ref);
-        if (!isShareable(child) && (visited->count(child) == 0)) {
-           toVisit.push_front(child);
+        if (!isShareable(child) && !child->seen()) {
+           child->setSeen();
+           visited->push_back(child);
         }
      });
   }
@@ -1188,6 +1346,7 @@ ALWAYS_INLINE void runDeallocationHooks(ContainerHeader* container) {
 #if USE_CYCLE_DETECTOR
     CycleDetector::removeCandidateIfNeeded(obj);
 #endif  // USE_CYCLE_DETECTOR
+    kotlin::CountDeallocation(obj);
     kotlin::RunFinalizers(obj);
     obj = reinterpret_cast<ObjHeader*>(reinterpret_cast<uintptr_t>(obj) + objectSize(obj));
   }
@@ -1224,7 +1383,7 @@ void freeContainer(ContainerHeader* container) {
   * When we see GREY during DFS, it means we see cycle.
   */
 void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
-                         KRef* firstBlocker, KStdVector<ContainerHeader*>* order) {
+                         KRef* firstBlocker, size_t* containerCount) {
   ContainerHeaderDeque toVisit;
   toVisit.push_back(start);
   start->setSeen();
@@ -1237,7 +1396,7 @@ void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
       // Mark BLACK.
       container->resetSeen();
       container->mark();
-      order->push_back(container);
+      ++*containerCount;
       continue;
     }
     toVisit.push_front(markAsRemoved(container));
@@ -1271,29 +1430,6 @@ void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
   }
 }
 
-void traverseStronglyConnectedComponent(ContainerHeader* start,
-                                        KStdUnorderedMap<ContainerHeader*,
-                                            KStdVector<ContainerHeader*>> const* reversedEdges,
-                                        KStdVector<ContainerHeader*>* component) {
-  ContainerHeaderDeque toVisit;
-  toVisit.push_back(start);
-  start->mark();
-
-  while (!toVisit.empty()) {
-    auto* container = toVisit.front();
-    toVisit.pop_front();
-    component->push_back(container);
-    auto it = reversedEdges->find(container);
-    RuntimeAssert(it != reversedEdges->end(), "unknown node during condensation building");
-    for (auto* nextContainer : it->second) {
-      if (!nextContainer->marked()) {
-          nextContainer->mark();
-          toVisit.push_front(nextContainer);
-      }
-    }
-  }
-}
-
 template <bool Atomic>
 inline bool tryIncrementRC(ContainerHeader* container) {
   return container->tryIncRefCount<Atomic>();
@@ -1577,6 +1713,7 @@ void collectCycles(MemoryState* state) {
   scanRoots(state);
   collectRoots(state);
   state->toFree->clear();
+  state->toFreePositions.reset();
   state->roots->clear();
 }
 
@@ -1813,6 +1950,7 @@ void processDecrements(MemoryState* state) {
        container = realShareableContainer(container);
      decrementRC(container);
   }
+  state->toReleasePositions.reset();
 
   state->foreignRefManager->processEnqueuedReleaseRefsWith([](ObjHeader* obj) {
     ContainerHeader* container = containerFor(obj);
@@ -2021,6 +2159,68 @@ void deinitForeignRef(ObjHeader* object, ForeignRefManager* manager) {
   }
 }
 
+// Buffers of memory states discarded by threads leaving the runtime. Foreign threads attaching to the
+// runtime for a short callback take them instead of allocating GC lists and TLS storage anew.
+class MemoryStateBuffersPool {
+ public:
+  bool tryTake(MemoryState* state) {
+    std::lock_guard<kotlin::SpinLock> guard(lock_);
+    if (size_ == 0) return false;
+    Buffers& buffers = buffers_[--size_];
+#if USE_GC
+    state->toFree = buffers.toFree;
+    state->roots = buffers.roots;
+    state->toRelease = buffers.toRelease;
+#endif
+    state->tls = buffers.tls;
+    return true;
+  }
+
+  bool tryPut(MemoryState* state) {
+    std::lock_guard<kotlin::SpinLock> guard(lock_);
+    if (size_ == kCapacity) return false;
+    Buffers& buffers = buffers_[size_++];
+#if USE_GC
+    buffers.toFree = state->toFree;
+    buffers.roots = state->roots;
+    buffers.toRelease = state->toRelease;
+#endif
+    buffers.tls = state->tls;
+    return true;
+  }
+
+  void clear() {
+    std::lock_guard<kotlin::SpinLock> guard(lock_);
+    while (size_ > 0) {
+      Buffers& buffers = buffers_[--size_];
+#if USE_GC
+      konanDestructInstance(buffers.toFree);
+      konanDestructInstance(buffers.roots);
+      konanDestructInstance(buffers.toRelease);
+#endif
+      buffers.tls.Deinit();
+    }
+  }
+
+ private:
+  static constexpr int kCapacity = 16;
+
+  struct Buffers {
+#if USE_GC
+    ContainerHeaderList* toFree;
+    ContainerHeaderList* roots;
+    ContainerHeaderList* toRelease;
+#endif
+    ThreadLocalStorage tls;
+  };
+
+  kotlin::SpinLock lock_;
+  Buffers buffers_[kCapacity];
+  int size_ = 0;
+};
+
+MemoryStateBuffersPool memoryStateBuffersPool;
+
 MemoryState* initMemory(bool firstRuntime) {
   RuntimeAssert(offsetof(ArrayHeader, typeInfoOrMeta_)
                 ==
@@ -2034,18 +2234,22 @@ MemoryState* initMemory(bool firstRuntime) {
   RuntimeAssert(memoryState == nullptr, "memory state must be clear");
   memoryState = konanConstructInstance<MemoryState>();
   INIT_EVENT(memoryState)
+  bool reusedBuffers = memoryStateBuffersPool.tryTake(memoryState);
 #if USE_GC
-  memoryState->toFree = konanConstructInstance<ContainerHeaderList>();
-  memoryState->roots = konanConstructInstance<ContainerHeaderList>();
+  if (!reusedBuffers) {
+    memoryState->toFree = konanConstructInstance<ContainerHeaderList>();
+    memoryState->roots = konanConstructInstance<ContainerHeaderList>();
+    memoryState->toRelease = konanConstructInstance<ContainerHeaderList>();
+  }
   memoryState->gcInProgress = false;
   memoryState->gcSuspendCount = 0;
-  memoryState->toRelease = konanConstructInstance<ContainerHeaderList>();
   initGcThreshold(memoryState, kGcThreshold);
   initGcCollectCyclesThreshold(memoryState, kMaxToFreeSizeThreshold);
   memoryState->allocSinceLastGcThreshold = kMaxGcAllocThreshold;
   memoryState->gcErgonomics = true;
 #endif
-  memoryState->tls.Init();
+  if (!reusedBuffers)
+    memoryState->tls.Init();
   memoryState->foreignRefManager = ForeignRefManager::create();
   bool firstMemoryState = atomicAdd(&aliveMemoryStatesCount, 1) == 1;
   switch (Kotlin_getDestroyRuntimeMode()) {
@@ -2098,10 +2302,16 @@ void deinitMemory(MemoryState* memoryState, bool destroyRuntime) {
   } while (memoryState->toRelease->size() > 0 || !memoryState->foreignRefManager->tryReleaseRefOwned());
   RuntimeAssert(memoryState->toFree->size() == 0, "Some memory have not been released after GC");
   RuntimeAssert(memoryState->toRelease->size() == 0, "Some memory have not been released after GC");
-  konanDestructInstance(memoryState->toFree);
-  konanDestructInstance(memoryState->roots);
-  konanDestructInstance(memoryState->toRelease);
-  memoryState->tls.Deinit();
+  releaseRecycledContainers(memoryState);
+  if (destroyRuntime) {
+    memoryStateBuffersPool.clear();
+  }
+  if (destroyRuntime || !memoryStateBuffersPool.tryPut(memoryState)) {
+    konanDestructInstance(memoryState->toFree);
+    konanDestructInstance(memoryState->roots);
+    konanDestructInstance(memoryState->toRelease);
+    memoryState->tls.Deinit();
+  }
   RuntimeAssert(memoryState->finalizerQueue == nullptr, "Finalizer queue must be empty");
   RuntimeAssert(memoryState->finalizerQueueSize == 0, "Finalizer queue must be empty");
 #endif // USE_GC
@@ -2116,6 +2326,14 @@ void deinitMemory(MemoryState* memoryState, bool destroyRuntime) {
 #else
 #if USE_GC
   if (IsStrictMemoryModel() && allocCount > 0 && checkLeaks) {
+#if USE_CYCLE_DETECTOR
+    if (KonanNeedDebugInfo) {
+      // Everything else is destroyed by now, so whatever is reachable from the leak roots is leaked.
+      kotlin::LeakReporter reporter;
+      CycleDetector::collectLeakRoots(reporter);
+      reporter.Report();
+    }
+#endif  // USE_CYCLE_DETECTOR
     konan::consoleErrorf(
         "Memory leaks detected, %d objects leaked!\n"
         "Use `Platform.isMemoryLeakCheckerActive = false` to avoid this check.\n", allocCount);
@@ -2298,6 +2516,8 @@ OBJ_GETTER(allocInstance, const TypeInfo* type_info) {
 #endif  // USE_GC
   auto container = ObjectContainer(state, type_info);
   ObjHeader* obj = container.GetPlace();
+  kotlin::ProfileAllocation(type_info, type_info->instanceSize_);
+  kotlin::CountAllocation(type_info, type_info->instanceSize_);
 #if USE_GC
   if (Strict) {
     rememberNewContainer(container.header());
@@ -2328,6 +2548,9 @@ OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements) {
   checkIfGcNeeded(state);
 #endif  // USE_GC
   auto container = ArrayContainer(state, type_info, elements);
+  size_t size = sizeof(ArrayHeader) + static_cast<size_t>(-type_info->instanceSize_) * elements;
+  kotlin::ProfileAllocation(type_info, size);
+  kotlin::CountAllocation(type_info, size);
 #if USE_GC
   if (Strict) {
     rememberNewContainer(container.header());
@@ -2436,6 +2659,40 @@ OBJ_GETTER(initSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (
 #endif  // KONAN_NO_THREADS
 }
 
+void callInitGlobalPossiblyLock(int32_t* state, void (*init)()) {
+  if (__atomic_load_n(state, __ATOMIC_ACQUIRE) == FILE_INITIALIZED) return;
+  auto& initializingFiles = memoryState->initializingFiles;
+  if (std::find(initializingFiles.begin(), initializingFiles.end(), state) != initializingFiles.end()) {
+    // Accessed from the file initializer itself.
+    return;
+  }
+#if KONAN_NO_THREADS
+  *state = FILE_BEING_INITIALIZED;
+#else
+  // Spin lock. If the initializing thread fails, the state goes back to `FILE_NOT_INITIALIZED`, and we retry.
+  // Initializers may run for long, so let the initializing thread make progress meanwhile.
+  int32_t value;
+  while ((value = __sync_val_compare_and_swap(state, FILE_NOT_INITIALIZED, FILE_BEING_INITIALIZED)) == FILE_BEING_INITIALIZED) {
+    std::this_thread::yield();
+  }
+  if (value == FILE_INITIALIZED) return;
+#endif
+  initializingFiles.push_back(state);
+#if KONAN_NO_EXCEPTIONS
+  init();
+#else
+  try {
+    init();
+  } catch (...) {
+    initializingFiles.pop_back();
+    __atomic_store_n(state, FILE_NOT_INITIALIZED, __ATOMIC_RELEASE);
+    throw;
+  }
+#endif
+  initializingFiles.pop_back();
+  __atomic_store_n(state, FILE_INITIALIZED, __ATOMIC_RELEASE);
+}
+
 /**
  * We keep thread affinity and reference value based cookie in the atomic references, so that
  * repeating read operation of the same value do not lead to the repeating rememberNewContainer() operation.
@@ -2656,12 +2913,18 @@ KNativePtr createStablePointer(KRef any) {
   if (any == nullptr) return nullptr;
   MEMORY_LOG("CreateStablePointer for %p rc=%d\n", any, containerFor(any) ? containerFor(any)->refCount() : 0)
   addHeapRef(any);
+#if USE_CYCLE_DETECTOR
+  CycleDetector::insertStableRefIfNeeded(any);
+#endif  // USE_CYCLE_DETECTOR
   return reinterpret_cast<KNativePtr>(any);
 }
 
 void disposeStablePointer(KNativePtr pointer) {
   if (pointer == nullptr) return;
   KRef ref = reinterpret_cast<KRef>(pointer);
+#if USE_CYCLE_DETECTOR
+  CycleDetector::removeStableRef(ref);
+#endif  // USE_CYCLE_DETECTOR
   ReleaseHeapRef(ref);
 }
 
@@ -2697,7 +2960,7 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
   // Free cyclic garbage to decrease number of analyzed objects.
   checkIfForceCyclicGcNeeded(state);
 
-  ContainerHeaderSet visited;
+  ContainerHeaderList visited;
   if (!checked) {
     hasExternalRefs(container, &visited);
   } else {
@@ -2721,28 +2984,26 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
        }
     }
     if (bad) {
+      resetSeen(&visited);
       return false;
     }
   }
 
-  // Remove all no longer owned containers from GC structures.
-  // TODO: not very efficient traversal.
-  for (auto it = state->toFree->begin(); it != state->toFree->end(); ++it) {
-    auto container = *it;
-    if (visited.count(container) != 0) {
-      MEMORY_LOG("removing %p from the toFree list\n", container)
-      container->resetBuffered();
-      container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
-      *it = markAsRemoved(container);
+  // Remove all no longer owned containers from GC structures. Only buffered ones are in the toFree list.
+  for (auto* container : visited) {
+    if (container->buffered()) {
+      state->toFreePositions.extract(*state->toFree, container, [state, container](size_t index) {
+        MEMORY_LOG("removing %p from the toFree list\n", container)
+        container->resetBuffered();
+        container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+        (*state->toFree)[index] = markAsRemoved(container);
+      });
     }
-  }
-  for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-    auto container = *it;
-    if (!isMarkedAsRemoved(container) && visited.count(container) != 0) {
+    state->toReleasePositions.extract(*state->toRelease, container, [state, container](size_t index) {
       MEMORY_LOG("removing %p from the toRelease list\n", container)
       container->decRefCount<false>();
-      *it = markAsRemoved(container);
-    }
+      (*state->toRelease)[index] = markAsRemoved(container);
+    });
   }
 
 #if TRACE_MEMORY
@@ -2751,139 +3012,205 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
     state->containers->erase(it);
   }
 #endif
+  resetSeen(&visited);
 
 #endif  // USE_GC
   return true;
 }
 
-void freezeAcyclic(ContainerHeader* rootContainer, ContainerHeaderSet* newlyFrozen) {
-  KStdDeque<ContainerHeader*> queue;
-  queue.push_back(rootContainer);
-  while (!queue.empty()) {
-    ContainerHeader* current = queue.front();
-    queue.pop_front();
-    current->unMark();
+void freezeAcyclic(ContainerHeader* rootContainer, size_t containerCount, size_t* newlyFrozenCount) {
+  KStdVector<ContainerHeader*> toVisit;
+  toVisit.reserve(containerCount);
+  rootContainer->unMark();
+  toVisit.push_back(rootContainer);
+  while (!toVisit.empty()) {
+    ContainerHeader* current = toVisit.back();
+    toVisit.pop_back();
     current->resetBuffered();
     current->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
     // Note, that once object is frozen, it could be concurrently accessed, so
     // color and similar attributes shall not be used.
     if (!current->frozen())
-      newlyFrozen->insert(current);
+      ++*newlyFrozenCount;
     MEMORY_LOG("freezing %p\n", current)
     current->freeze();
-    traverseContainerReferredObjects(current, [&queue](ObjHeader* obj) {
+    traverseContainerReferredObjects(current, [&toVisit](ObjHeader* obj) {
         ContainerHeader* objContainer = containerFor(obj);
-        if (canFreeze(objContainer)) {
-          if (objContainer->marked())
-            queue.push_back(objContainer);
+        if (canFreeze(objContainer) && objContainer->marked()) {
+          objContainer->unMark();
+          toVisit.push_back(objContainer);
         }
     });
   }
 }
 
-void freezeCyclic(ObjHeader* root,
-                  const KStdVector<ContainerHeader*>& order,
-                  ContainerHeaderSet* newlyFrozen) {
-  KStdUnorderedMap<ContainerHeader*, KStdVector<ContainerHeader*>> reversedEdges;
-  KStdDeque<ObjHeader*> queue;
-  queue.push_back(root);
-  while (!queue.empty()) {
-    ObjHeader* current = queue.front();
-    queue.pop_front();
-    ContainerHeader* currentContainer = containerFor(current);
-    currentContainer->unMark();
-    reversedEdges.emplace(currentContainer, KStdVector<ContainerHeader*>(0));
-    traverseContainerReferredObjects(currentContainer, [current, currentContainer, &queue, &reversedEdges](ObjHeader* obj) {
-          ContainerHeader* objContainer = containerFor(obj);
-          if (canFreeze(objContainer)) {
-            if (objContainer->marked())
-              queue.push_back(obj);
-            // We ignore references from FreezableAtomicsReference during condensation, to avoid KT-33824.
-            if (!isFreezableAtomic(current))
-              reversedEdges.emplace(objContainer, KStdVector<ContainerHeader*>(0)).
-                first->second.push_back(currentContainer);
-          }
+// Freezes containers of a strongly connected component, and creates an aggregating container for
+// it if needed. References from the component may only go to itself or to already frozen containers.
+void freezeComponent(KStdVector<ContainerHeader*>& component, int totalCount, size_t* newlyFrozenCount) {
+  int internalRefsCount = 0;
+  for (auto* container : component) {
+    RuntimeAssert(!isAggregatingFrozenContainer(container), "Must not be called on such containers");
+    if (isFreezableAtomic(container)) {
+      RuntimeAssert(component.size() == 1, "Must be trivial condensation");
+      continue;
+    }
+    traverseContainerReferredObjects(container, [&internalRefsCount](ObjHeader* obj) {
+        auto* container = containerFor(obj);
+        if (canFreeze(container))
+          ++internalRefsCount;
       });
-   }
+  }
 
-   KStdVector<KStdVector<ContainerHeader*>> components;
-   MEMORY_LOG("Condensation:\n");
-   // Enumerate in the topological order.
-   for (auto it = order.rbegin(); it != order.rend(); ++it) {
-     auto* container = *it;
-     if (container->marked()) continue;
-     KStdVector<ContainerHeader*> component;
-     traverseStronglyConnectedComponent(container, &reversedEdges, &component);
-     MEMORY_LOG("SCC:\n");
-  #if TRACE_MEMORY
-     for (auto c: component)
-       konan::consolePrintf("    %p\n", c);
-  #endif
-     components.push_back(std::move(component));
-   }
+  for (auto* container : component) {
+    container->resetSeen();
+    container->resetBuffered();
+    container->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
+    ++*newlyFrozenCount;
+    // Note, that once object is frozen, it could be concurrently accessed, so
+    // color and similar attributes shall not be used.
+    MEMORY_LOG("freezing %p\n", container)
+    container->freeze();
+    // We set refcount of original container to zero, so that it is seen as such after removal
+    // meta-object, where aggregating container is stored.
+    container->setRefCount(0);
+  }
+
+  // Create fictitious container for the whole component.
+  ContainerHeader* superContainer = component[0];
+  if (component.size() > 1) {
+    superContainer = allocAggregatingFrozenContainer(component);
+    ++*newlyFrozenCount;
+  }
+  // Don't count internal references.
+  MEMORY_LOG("Setting aggregating %p rc to %d (total %d inner %d)\n", \
+     superContainer, totalCount - internalRefsCount, totalCount, internalRefsCount)
+  superContainer->setRefCount(totalCount - internalRefsCount);
+}
+
+/**
+ * Finds and freezes strongly connected components with the iterative Tarjan's algorithm.
+ * Components are found in reversed topological order, so each one is frozen right away.
+ *
+ * All containers to freeze are marked by depthFirstTraversal() beforehand, and their state is kept in
+ * the container headers:
+ *  - 'marked' bit: container is not yet visited
+ *  - 'seen' bit: container is on the component stack, and its reference counter holds its index
+ *  - neither: container is frozen
+ * Original reference counters are saved aside, as they are recomputed when components are frozen anyway.
+ */
+void freezeCyclic(ContainerHeader* rootContainer, size_t containerCount, size_t* newlyFrozenCount) {
+  struct Node {
+    ContainerHeader* container;
+    uint32_t lowLink;
+    int refCount;
+  };
+  struct Frame {
+    uint32_t node;
+    // References of the frame's container are kept in `successors` after this position.
+    size_t successorsBegin;
+  };
+  RuntimeCheck(containerCount < (1u << (31 - CONTAINER_TAG_SHIFT)), "Too many objects to freeze");
+  KStdVector<Node> nodes;
+  nodes.reserve(containerCount);
+  KStdVector<uint32_t> componentStack;
+  componentStack.reserve(containerCount);
+  KStdVector<Frame> frames;
+  KStdVector<ContainerHeader*> successors;
+  KStdVector<ContainerHeader*> component;
+  // Searches start from the root and from the values of FreezableAtomicReference.
+  KStdVector<ContainerHeader*> roots;
+  roots.push_back(rootContainer);
+
+  auto visit = [&](ContainerHeader* container) {
+    uint32_t index = nodes.size();
+    nodes.push_back({container, index, container->refCount()});
+    container->unMark();
+    container->setSeen();
+    container->setRefCount(index);
+    componentStack.push_back(index);
+    frames.push_back({index, successors.size()});
+    // We ignore references from FreezableAtomicsReference during condensation, to avoid KT-33824.
+    auto* references = isFreezableAtomic(container) ? &roots : &successors;
+    traverseContainerReferredObjects(container, [references](ObjHeader* obj) {
+        ContainerHeader* objContainer = containerFor(obj);
+        if (canFreeze(objContainer))
+          references->push_back(objContainer);
+      });
+  };
 
-  // Enumerate strongly connected components in reversed topological order.
-  for (auto it = components.rbegin(); it != components.rend(); ++it) {
-    auto& component = *it;
-    int internalRefsCount = 0;
-    int totalCount = 0;
-    for (auto* container : component) {
-      RuntimeAssert(!isAggregatingFrozenContainer(container), "Must not be called on such containers");
-      totalCount += container->refCount();
-      if (isFreezableAtomic(container)) {
-        RuntimeAssert(component.size() == 1, "Must be trivial condensation");
+  MEMORY_LOG("Condensation:\n");
+  while (!roots.empty()) {
+    auto* root = roots.back();
+    roots.pop_back();
+    if (!root->marked()) continue;
+    visit(root);
+    while (!frames.empty()) {
+      auto& frame = frames.back();
+      if (successors.size() > frame.successorsBegin) {
+        auto* next = successors.back();
+        successors.pop_back();
+        if (next->marked()) {
+          visit(next);
+        } else if (next->seen()) {
+          auto& node = nodes[frame.node];
+          node.lowLink = std::min(node.lowLink, static_cast<uint32_t>(next->refCount()));
+        }
         continue;
       }
-      traverseContainerReferredObjects(container, [&internalRefsCount](ObjHeader* obj) {
-          auto* container = containerFor(obj);
-          if (canFreeze(container))
-            ++internalRefsCount;
-        });
-    }
-
-    // Freeze component.
-    for (auto* container : component) {
-      container->resetBuffered();
-      container->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
-      if (!container->frozen())
-        newlyFrozen->insert(container);
-      // Note, that once object is frozen, it could be concurrently accessed, so
-      // color and similar attributes shall not be used.
-      MEMORY_LOG("freezing %p\n", container)
-      container->freeze();
-      // We set refcount of original container to zero, so that it is seen as such after removal
-      // meta-object, where aggregating container is stored.
-      container->setRefCount(0);
+      uint32_t index = frame.node;
+      frames.pop_back();
+      uint32_t lowLink = nodes[index].lowLink;
+      if (!frames.empty()) {
+        auto& parent = nodes[frames.back().node];
+        parent.lowLink = std::min(parent.lowLink, lowLink);
+      }
+      if (lowLink != index) continue;
+
+      // The container is a root of a component, which consists of it and everything above it on the stack.
+      component.clear();
+      int totalCount = 0;
+      uint32_t member;
+      do {
+        member = componentStack.back();
+        componentStack.pop_back();
+        component.push_back(nodes[member].container);
+        totalCount += nodes[member].refCount;
+      } while (member != index);
+      MEMORY_LOG("SCC:\n");
+  #if TRACE_MEMORY
+      for (auto c: component)
+        konan::consolePrintf("    %p\n", c);
+  #endif
+      freezeComponent(component, totalCount, newlyFrozenCount);
     }
-
-    // Create fictitious container for the whole component.
-    auto superContainer = component.size() == 1 ? component[0] : allocAggregatingFrozenContainer(component);
-    // Don't count internal references.
-    MEMORY_LOG("Setting aggregating %p rc to %d (total %d inner %d)\n", \
-       superContainer, totalCount - internalRefsCount, totalCount, internalRefsCount)
-    superContainer->setRefCount(totalCount - internalRefsCount);
-    newlyFrozen->insert(superContainer);
   }
+  RuntimeAssert(componentStack.empty(), "All components must be frozen");
 }
 
 void runFreezeHooksRecursive(ObjHeader* root) {
-  KStdUnorderedSet<KRef> seen;
+  // Objects, which containers will get frozen by freezeCyclic or freezeAcyclic, are the only objects in
+  // their containers, so the 'seen' bit of a container marks its object as visited.
   KStdVector<KRef> toVisit;
-  seen.insert(root);
-  toVisit.push_back(root);
+  KStdVector<ContainerHeader*> seen;
+  auto visit = [&toVisit, &seen](ObjHeader* obj) {
+    auto* container = containerFor(obj);
+    if (!canFreeze(container) || container->seen()) return;
+    container->setSeen();
+    seen.push_back(container);
+    toVisit.push_back(obj);
+  };
+  visit(root);
+  if (toVisit.empty()) toVisit.push_back(root);
   while (!toVisit.empty()) {
     KRef obj = toVisit.back();
     toVisit.pop_back();
 
     kotlin::RunFreezeHooks(obj);
 
-    kotlin::traverseReferredObjects(obj, [&seen, &toVisit](ObjHeader* field) {
-      auto wasNotSeenYet = seen.insert(field).second;
-      // Only iterating on unseen objects which containers will get frozen by freezeCyclic or freezeAcyclic.
-      if (wasNotSeenYet && canFreeze(containerFor(field))) {
-        toVisit.push_back(field);
-      }
-    });
+    kotlin::traverseReferredObjects(obj, visit);
+  }
+  for (auto* container : seen) {
+    container->resetSeen();
   }
 }
 
@@ -2899,7 +3226,7 @@ void runFreezeHooksRecursive(ObjHeader* root) {
  * it could be correctly released by just atomic decrement on reference counter, without additional
  * cycle collector run.
  * So during subgraph freezing operation, we perform the following steps:
- *   - run Kosoraju-Sharir algorithm to find strongly connected components
+ *   - run Tarjan's algorithm to find strongly connected components
  *   - put all objects in each strongly connected component into an artificial container
  *     (we assume that they all were in single element containers initially), single-object
  *     components remain in the same container
@@ -2913,7 +3240,7 @@ void runFreezeHooksRecursive(ObjHeader* root) {
 void freezeSubgraph(ObjHeader* root) {
   if (root == nullptr) return;
   // First check that passed object graph has no cycles.
-  // If there are cycles - run graph condensation on cyclic graphs using Kosoraju-Sharir.
+  // If there are cycles - run graph condensation on cyclic graphs using Tarjan's algorithm.
   ContainerHeader* rootContainer = containerFor(root);
   if (isPermanentOrFrozen(rootContainer)) return;
 
@@ -2935,20 +3262,20 @@ void freezeSubgraph(ObjHeader* root) {
   bool hasCycles = false;
   KRef firstBlocker = root->has_meta_object() && ((root->meta_object()->flags_ & MF_NEVER_FROZEN) != 0) ?
     root : nullptr;
-  KStdVector<ContainerHeader*> order;
-  depthFirstTraversal(rootContainer, &hasCycles, &firstBlocker, &order);
+  size_t containerCount = 0;
+  depthFirstTraversal(rootContainer, &hasCycles, &firstBlocker, &containerCount);
   if (firstBlocker != nullptr) {
     MEMORY_LOG("See freeze blocker for %p: %p\n", root, firstBlocker)
     ThrowFreezingException(root, firstBlocker);
   }
-  ContainerHeaderSet newlyFrozen;
-  // Now unmark all marked objects, and freeze them, if no cycles detected.
+  size_t newlyFrozenCount = 0;
+  // Now unmark all marked objects, and freeze them.
   if (hasCycles) {
-    freezeCyclic(root, order, &newlyFrozen);
+    freezeCyclic(rootContainer, containerCount, &newlyFrozenCount);
   } else {
-    freezeAcyclic(rootContainer, &newlyFrozen);
+    freezeAcyclic(rootContainer, containerCount, &newlyFrozenCount);
   }
-  MEMORY_LOG("Graph of %p is %s with %d elements\n", root, hasCycles ? "cyclic" : "acyclic", newlyFrozen.size())
+  MEMORY_LOG("Graph of %p is %s with %zu elements\n", root, hasCycles ? "cyclic" : "acyclic", newlyFrozenCount)
 
 #if USE_GC
   // Now remove frozen objects from the toFree list.
@@ -2956,7 +3283,6 @@ void freezeSubgraph(ObjHeader* root) {
   // and use it when analyzing toFree during collection.
   for (auto& container : *(state->toFree)) {
     if (!isMarkedAsRemoved(container) && container->frozen()) {
-      RuntimeAssert(newlyFrozen.count(container) != 0, "Must be newly frozen");
       container = markAsRemoved(container);
     }
   }
@@ -3015,6 +3341,18 @@ CycleDetectorRootset CycleDetector::collectRootset() {
   return rootset;
 }
 
+// static
+void CycleDetector::collectLeakRoots(kotlin::LeakReporter& reporter) {
+  auto& detector = instance();
+  std::lock_guard<kotlin::SpinLock> guard(detector.lock_);
+  for (auto& it: detector.stableRefs_) {
+    reporter.AddLeakRoot(kotlin::LeakReporter::RootKind::kStableRef, it.first);
+  }
+  for (auto* candidate: detector.candidateList_) {
+    reporter.AddLeakRoot(kotlin::LeakReporter::RootKind::kAtomic, candidate);
+  }
+}
+
 KStdVector<KRef> findCycleWithDFS(KRef root, const CycleDetectorRootset& rootset) {
   auto traverseFields = [&rootset](KRef obj, auto process) {
     auto it = rootset.rootToFields.find(obj);
@@ -3359,6 +3697,10 @@ void RUNTIME_NOTHROW InitAndRegisterGlobal(ObjHeader** location, const ObjHeader
     RuntimeCheck(false, "Global registration is impossible in legacy MM");
 }
 
+void CallInitGlobalPossiblyLock(int32_t* state, void (*init)()) {
+    callInitGlobalPossiblyLock(state, init);
+}
+
 RUNTIME_NOTHROW void SetStackRefStrict(ObjHeader** location, const ObjHeader* object) {
   setStackRef<true>(location, object);
 }
@@ -3425,6 +3767,10 @@ RUNTIME_NOTHROW void UpdateHeapRefIfNull(ObjHeader** location, const ObjHeader*
   updateHeapRefIfNull(location, object);
 }
 
+RUNTIME_NOTHROW void CopyHeapRefs(ObjHeader** destination, ObjHeader* const* source, int count) {
+  RuntimeFail("Only for experimental MM");
+}
+
 OBJ_GETTER(SwapHeapRefLocked,
     ObjHeader** location, ObjHeader* expectedValue, ObjHeader* newValue, int32_t* spinlock, int32_t* cookie) {
   RETURN_RESULT_OF(swapHeapRefLocked, location, expectedValue, newValue, spinlock, cookie);
@@ -3670,6 +4016,20 @@ void Kotlin_native_internal_GC_setCyclicCollector(KRef gc, KBoolean value) {
 #endif  // USE_CYCLIC_GC
 }
 
+KBoolean Kotlin_native_internal_GC_dumpHeap(KRef, KRef path) {
+  // Heap dumps need to enumerate all objects, which is not possible with reference counting.
+  ThrowIllegalArgumentException();
+}
+
+void Kotlin_native_internal_GC_dumpHeapOnSignal(KRef, KInt signal, KRef path) {
+  ThrowIllegalArgumentException();
+}
+
+KInt Kotlin_native_internal_GC_reportLeaks(KRef) {
+  // Globals cannot be enumerated, so live objects cannot be told from leaked ones before shutdown.
+  return -1;
+}
+
 bool Kotlin_Any_isShareable(KRef thiz) {
     return thiz == nullptr || isShareable(containerFor(thiz));
 }
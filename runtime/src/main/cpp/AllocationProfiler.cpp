@@ -0,0 +1,360 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "AllocationProfiler.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "Exceptions.h"
+#include "ExecFormat.h"
+#include "KString.h"
+#include "Porting.h"
+#include "SourceInfo.h"
+#include "TypeInfo.h"
+#include "TypeInfoUtils.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+// Per-thread distance to the next sample.
+struct ThreadSampler {
+    int64_t interval;
+    int64_t bytesUntilSample;
+    uint64_t random;
+};
+
+THREAD_LOCAL_VARIABLE ThreadSampler threadSampler = {0, 0, 0};
+
+int64_t nextSampleDistance(ThreadSampler& sampler) noexcept {
+    if (sampler.random == 0) {
+        sampler.random = reinterpret_cast<uintptr_t>(&sampler) * 0x9E3779B97F4A7C15ULL | 1;
+    }
+    // xorshift64*
+    sampler.random ^= sampler.random >> 12;
+    sampler.random ^= sampler.random << 25;
+    sampler.random ^= sampler.random >> 27;
+    uint64_t bits = sampler.random * 0x2545F4914F6CDD1DULL;
+    // Uniform in (0, 1].
+    double uniform = static_cast<double>((bits >> 11) + 1) * 0x1.0p-53;
+    return static_cast<int64_t>(-std::log(uniform) * static_cast<double>(sampler.interval)) + 1;
+}
+
+// Just enough of the protobuf wire format to write a pprof profile.
+class ProtoWriter : private MoveOnly {
+public:
+    ProtoWriter() noexcept = default;
+    ProtoWriter(ProtoWriter&&) noexcept = default;
+    ProtoWriter& operator=(ProtoWriter&&) noexcept = default;
+
+    void Uint(uint32_t field, uint64_t value) noexcept {
+        Key(field, kVarint);
+        Varint(value);
+    }
+
+    void Int(uint32_t field, int64_t value) noexcept { Uint(field, static_cast<uint64_t>(value)); }
+
+    void Bytes(uint32_t field, const void* data, size_t size) noexcept {
+        Key(field, kLengthDelimited);
+        Varint(size);
+        auto* bytes = static_cast<const uint8_t*>(data);
+        data_.insert(data_.end(), bytes, bytes + size);
+    }
+
+    void Message(uint32_t field, const ProtoWriter& message) noexcept { Bytes(field, message.data_.data(), message.data_.size()); }
+
+    template <typename T>
+    void Packed(uint32_t field, const KStdVector<T>& values) noexcept {
+        ProtoWriter packed;
+        for (T value : values) {
+            packed.Varint(static_cast<uint64_t>(value));
+        }
+        Message(field, packed);
+    }
+
+    const KStdVector<uint8_t>& data() const noexcept { return data_; }
+
+private:
+    static constexpr uint32_t kVarint = 0;
+    static constexpr uint32_t kLengthDelimited = 2;
+
+    void Key(uint32_t field, uint32_t wireType) noexcept { Varint(field << 3 | wireType); }
+
+    void Varint(uint64_t value) noexcept {
+        while (value >= 0x80) {
+            data_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data_.push_back(static_cast<uint8_t>(value));
+    }
+
+    KStdVector<uint8_t> data_;
+};
+
+// Field numbers from profile.proto.
+namespace profile {
+constexpr uint32_t kSampleType = 1;
+constexpr uint32_t kSample = 2;
+constexpr uint32_t kLocation = 4;
+constexpr uint32_t kFunction = 5;
+constexpr uint32_t kStringTable = 6;
+constexpr uint32_t kPeriodType = 11;
+constexpr uint32_t kPeriod = 12;
+} // namespace profile
+
+namespace value_type {
+constexpr uint32_t kType = 1;
+constexpr uint32_t kUnit = 2;
+} // namespace value_type
+
+namespace sample {
+constexpr uint32_t kLocationId = 1;
+constexpr uint32_t kValue = 2;
+constexpr uint32_t kLabel = 3;
+} // namespace sample
+
+namespace label {
+constexpr uint32_t kKey = 1;
+constexpr uint32_t kStr = 2;
+} // namespace label
+
+namespace location {
+constexpr uint32_t kId = 1;
+constexpr uint32_t kAddress = 3;
+constexpr uint32_t kLine = 4;
+} // namespace location
+
+namespace line {
+constexpr uint32_t kFunctionId = 1;
+constexpr uint32_t kLine = 2;
+} // namespace line
+
+namespace function {
+constexpr uint32_t kId = 1;
+constexpr uint32_t kName = 2;
+constexpr uint32_t kFilename = 4;
+} // namespace function
+
+class ProfileBuilder : private Pinned {
+public:
+    ProfileBuilder() noexcept { String(""); }
+
+    int64_t String(const KStdString& string) noexcept {
+        auto it = strings_.find(string);
+        if (it != strings_.end()) return it->second;
+        int64_t index = strings_.size();
+        strings_.emplace(string, index);
+        profile_.Bytes(profile::kStringTable, string.data(), string.size());
+        return index;
+    }
+
+    void ValueType(uint32_t field, const char* type, const char* unit) noexcept {
+        ProtoWriter valueType;
+        valueType.Int(value_type::kType, String(type));
+        valueType.Int(value_type::kUnit, String(unit));
+        profile_.Message(field, valueType);
+    }
+
+    // Location of a code address, symbolized with the function name and, when available, the source position.
+    uint64_t CodeLocation(void* address) noexcept {
+        auto it = codeLocations_.find(address);
+        if (it != codeLocations_.end()) return it->second;
+
+        char symbol[512];
+        if (!AddressToSymbol(address, symbol, sizeof(symbol))) {
+            konan::snprintf(symbol, sizeof(symbol), "%p", address);
+        }
+        SourceInfo sourceInfo = Kotlin_getSourceInfo(address);
+        uint64_t functionId = Function(symbol, sourceInfo.fileName != nullptr ? sourceInfo.fileName : "");
+        uint64_t id = Location(reinterpret_cast<uintptr_t>(address), functionId, sourceInfo.lineNumber > 0 ? sourceInfo.lineNumber : 0);
+        codeLocations_.emplace(address, id);
+        return id;
+    }
+
+    // A pseudo-location standing for allocations of `typeInfo`.
+    uint64_t TypeLocation(const TypeInfo* typeInfo, const KStdString& typeName) noexcept {
+        auto it = typeLocations_.find(typeInfo);
+        if (it != typeLocations_.end()) return it->second;
+        uint64_t id = Location(0, Function(typeName, ""), 0);
+        typeLocations_.emplace(typeInfo, id);
+        return id;
+    }
+
+    ProtoWriter& profile() noexcept { return profile_; }
+
+private:
+    uint64_t Function(const KStdString& name, const KStdString& fileName) noexcept {
+        auto it = functions_.find(name);
+        if (it != functions_.end()) return it->second;
+        uint64_t id = functions_.size() + 1;
+        ProtoWriter function;
+        function.Uint(function::kId, id);
+        function.Int(function::kName, String(name));
+        function.Int(function::kFilename, String(fileName));
+        profile_.Message(profile::kFunction, function);
+        functions_.emplace(name, id);
+        return id;
+    }
+
+    uint64_t Location(uint64_t address, uint64_t functionId, int64_t lineNumber) noexcept {
+        uint64_t id = ++locationsCount_;
+        ProtoWriter line;
+        line.Uint(line::kFunctionId, functionId);
+        line.Int(line::kLine, lineNumber);
+        ProtoWriter location;
+        location.Uint(location::kId, id);
+        location.Uint(location::kAddress, address);
+        location.Message(location::kLine, line);
+        profile_.Message(profile::kLocation, location);
+        return id;
+    }
+
+    ProtoWriter profile_;
+    KStdOrderedMap<KStdString, int64_t> strings_;
+    KStdOrderedMap<KStdString, uint64_t> functions_;
+    KStdUnorderedMap<void*, uint64_t> codeLocations_;
+    KStdUnorderedMap<const TypeInfo*, uint64_t> typeLocations_;
+    uint64_t locationsCount_ = 0;
+};
+
+} // namespace
+
+std::atomic<bool> kotlin::internal::allocationProfilerEnabled = false;
+
+// static
+AllocationProfiler& AllocationProfiler::Instance() noexcept {
+    static AllocationProfiler instance [[clang::no_destroy]];
+    return instance;
+}
+
+void AllocationProfiler::SetSamplingInterval(int64_t bytes) noexcept {
+    samplingInterval_.store(bytes, std::memory_order_relaxed);
+    if (this == &Instance()) {
+        internal::allocationProfilerEnabled.store(bytes > 0, std::memory_order_relaxed);
+    }
+}
+
+void AllocationProfiler::Record(
+        const TypeInfo* typeInfo, size_t size, int64_t samplingInterval, void* const* stack, int stackSize) noexcept {
+    // Allocations are sampled with the probability 1 - exp(-size / interval), so each sample stands for
+    // 1 / probability allocations of the same size.
+    double probability = -std::expm1(-static_cast<double>(size) / static_cast<double>(samplingInterval));
+    double weight = probability > 0 ? 1 / probability : 1;
+    Key key{typeInfo, KStdVector<void*>(stack, stack + stackSize)};
+    std::lock_guard<SpinLock> guard(mutex_);
+    auto& value = samples_[std::move(key)];
+    value.objects += weight;
+    value.bytes += weight * static_cast<double>(size);
+}
+
+KStdVector<AllocationProfiler::Sample> AllocationProfiler::Samples() noexcept {
+    KStdVector<Sample> result;
+    std::lock_guard<SpinLock> guard(mutex_);
+    result.reserve(samples_.size());
+    for (auto& entry : samples_) {
+        result.push_back(Sample{entry.first.typeInfo, entry.first.stack, entry.second.objects, entry.second.bytes});
+    }
+    return result;
+}
+
+bool AllocationProfiler::Write(std::FILE* file) noexcept {
+    // Symbolization is slow, so do not hold the lock for it.
+    KStdVector<Sample> samples = Samples();
+
+    ProfileBuilder builder;
+    auto& profile = builder.profile();
+    builder.ValueType(profile::kSampleType, "alloc_objects", "count");
+    builder.ValueType(profile::kSampleType, "alloc_space", "bytes");
+    builder.ValueType(profile::kPeriodType, "space", "bytes");
+    profile.Int(profile::kPeriod, GetSamplingInterval());
+
+    KStdUnorderedMap<const TypeInfo*, KStdString> typeNames;
+    for (auto& sample : samples) {
+        auto typeNameIt = typeNames.find(sample.typeInfo);
+        if (typeNameIt == typeNames.end()) {
+            typeNameIt = typeNames.emplace(sample.typeInfo, TypeName(sample.typeInfo)).first;
+        }
+
+        KStdVector<uint64_t> locations;
+        locations.reserve(sample.stack.size() + 1);
+        locations.push_back(builder.TypeLocation(sample.typeInfo, typeNameIt->second));
+        for (void* address : sample.stack) {
+            locations.push_back(builder.CodeLocation(address));
+        }
+        KStdVector<int64_t> values = {std::llround(sample.objects), std::llround(sample.bytes)};
+
+        ProtoWriter typeLabel;
+        typeLabel.Int(label::kKey, builder.String("object"));
+        typeLabel.Int(label::kStr, builder.String(typeNameIt->second));
+
+        ProtoWriter message;
+        message.Packed(sample::kLocationId, locations);
+        message.Packed(sample::kValue, values);
+        message.Message(sample::kLabel, typeLabel);
+        profile.Message(profile::kSample, message);
+    }
+
+    auto& data = profile.data();
+    return std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+}
+
+void AllocationProfiler::Clear() noexcept {
+    std::lock_guard<SpinLock> guard(mutex_);
+    samples_.clear();
+}
+
+size_t AllocationProfiler::KeyHash::operator()(const Key& key) const noexcept {
+    size_t result = std::hash<const TypeInfo*>()(key.typeInfo);
+    for (void* address : key.stack) {
+        result = result * 31 + std::hash<void*>()(address);
+    }
+    return result;
+}
+
+NO_INLINE void kotlin::internal::SampleAllocation(const TypeInfo* typeInfo, size_t size) noexcept {
+    auto& profiler = AllocationProfiler::Instance();
+    int64_t interval = profiler.GetSamplingInterval();
+    if (interval <= 0) return;
+
+    auto& sampler = threadSampler;
+    if (sampler.interval != interval) {
+        sampler.interval = interval;
+        sampler.bytesUntilSample = nextSampleDistance(sampler);
+    }
+    sampler.bytesUntilSample -= static_cast<int64_t>(size);
+    if (sampler.bytesUntilSample > 0) return;
+    // An allocation spanning several distances is still sampled once: its weight accounts for its size.
+    sampler.bytesUntilSample = nextSampleDistance(sampler);
+
+    void* stack[AllocationProfiler::kMaxStackDepth];
+    // Skip this function, the rest of the allocation path is useful to tell allocations of the memory manager apart.
+    int stackSize = CaptureStackTrace(stack, AllocationProfiler::kMaxStackDepth, 0);
+    profiler.Record(typeInfo, size, interval, stack, stackSize);
+}
+
+extern "C" void Kotlin_native_internal_GC_setAllocationSamplingInterval(ObjHeader*, int64_t value) {
+    if (value < 0) {
+        ThrowIllegalArgumentException();
+    }
+    AllocationProfiler::Instance().SetSamplingInterval(value);
+}
+
+extern "C" int64_t Kotlin_native_internal_GC_getAllocationSamplingInterval(ObjHeader*) {
+    return AllocationProfiler::Instance().GetSamplingInterval();
+}
+
+extern "C" bool Kotlin_native_internal_GC_dumpAllocationProfile(ObjHeader*, ObjHeader* path) {
+    char* cpath = CreateCStringFromString(path);
+    std::FILE* file = std::fopen(cpath, "wb");
+    DisposeCString(cpath);
+    if (file == nullptr) return false;
+    bool written = AllocationProfiler::Instance().Write(file);
+    if (std::fclose(file) != 0) {
+        written = false;
+    }
+    return written;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_ALLOCATION_PROFILER_H
+#define RUNTIME_ALLOCATION_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+
+#include "Alloc.h"
+#include "Common.h"
+#include "Mutex.hpp"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Samples allocations of Kotlin objects: on average once per `samplingInterval` allocated bytes the type, size and
+// stack of an allocation are recorded. Distances between samples are drawn from an exponential distribution, so that
+// periodic allocation patterns do not bias the samples, and each sample is weighted to estimate what it stands for.
+// Samples with the same type and stack are aggregated.
+class AllocationProfiler : private Pinned {
+public:
+    struct Sample {
+        const TypeInfo* typeInfo;
+        KStdVector<void*> stack;
+        // Estimated number of allocated objects and bytes.
+        double objects;
+        double bytes;
+    };
+
+    static constexpr int kMaxStackDepth = 64;
+
+    static AllocationProfiler& Instance() noexcept;
+
+    AllocationProfiler() noexcept = default;
+
+    // `0` disables sampling. Only the `Instance` is sampled by `ProfileAllocation`.
+    void SetSamplingInterval(int64_t bytes) noexcept;
+    int64_t GetSamplingInterval() const noexcept { return samplingInterval_.load(std::memory_order_relaxed); }
+
+    // Records an allocation of `size` bytes, that was sampled with the average distance of `samplingInterval` bytes.
+    void Record(const TypeInfo* typeInfo, size_t size, int64_t samplingInterval, void* const* stack, int stackSize) noexcept;
+
+    KStdVector<Sample> Samples() noexcept;
+
+    // Writes the samples as an uncompressed pprof profile (see profile.proto in github.com/google/pprof) with the
+    // allocated type as the innermost frame. Returns `false` if the file could not be written.
+    bool Write(std::FILE* file) noexcept;
+
+    void Clear() noexcept;
+
+private:
+    struct Key {
+        const TypeInfo* typeInfo;
+        KStdVector<void*> stack;
+
+        bool operator==(const Key& rhs) const noexcept { return typeInfo == rhs.typeInfo && stack == rhs.stack; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Value {
+        double objects = 0;
+        double bytes = 0;
+    };
+
+    std::atomic<int64_t> samplingInterval_ = 0;
+    SpinLock mutex_;
+    std::unordered_map<Key, Value, KeyHash, std::equal_to<Key>, KonanAllocator<std::pair<const Key, Value>>> samples_;
+};
+
+namespace internal {
+
+extern std::atomic<bool> allocationProfilerEnabled;
+
+void SampleAllocation(const TypeInfo* typeInfo, size_t size) noexcept;
+
+} // namespace internal
+
+// Must be called by memory managers for every allocated object with its size.
+ALWAYS_INLINE inline void ProfileAllocation(const TypeInfo* typeInfo, size_t size) noexcept {
+    if (internal::allocationProfilerEnabled.load(std::memory_order_relaxed)) {
+        internal::SampleAllocation(typeInfo, size);
+    }
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_ALLOCATION_PROFILER_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "AllocationProfiler.hpp"
+
+#include <cmath>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "TypeInfo.h"
+#include "Types.h"
+
+using namespace kotlin;
+
+using testing::DoubleNear;
+
+namespace {
+
+// Top level fields of a serialized message, enough to check the structure of a pprof profile.
+class ProtoReader {
+public:
+    explicit ProtoReader(KStdVector<uint8_t> data) : data_(std::move(data)) {}
+
+    // Returns length delimited fields with the number `field`.
+    KStdVector<KStdString> Fields(uint32_t field) {
+        KStdVector<KStdString> result;
+        size_t position = 0;
+        while (position < data_.size()) {
+            uint64_t key = Varint(position);
+            switch (key & 7) {
+                case 0:
+                    Varint(position);
+                    break;
+                case 2: {
+                    uint64_t size = Varint(position);
+                    if (key >> 3 == field) {
+                        result.emplace_back(reinterpret_cast<const char*>(data_.data() + position), size);
+                    }
+                    position += size;
+                    break;
+                }
+                default:
+                    ADD_FAILURE() << "Unexpected wire type " << (key & 7);
+                    return result;
+            }
+        }
+        return result;
+    }
+
+private:
+    uint64_t Varint(size_t& position) {
+        uint64_t result = 0;
+        for (int shift = 0; position < data_.size(); shift += 7) {
+            uint8_t byte = data_[position++];
+            result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) break;
+        }
+        return result;
+    }
+
+    KStdVector<uint8_t> data_;
+};
+
+KStdVector<uint8_t> ReadAll(std::FILE* file) {
+    std::rewind(file);
+    KStdVector<uint8_t> result;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        result.insert(result.end(), buffer, buffer + read);
+    }
+    return result;
+}
+
+TypeInfo MakeTypeInfo(int32_t instanceSize) {
+    TypeInfo typeInfo{};
+    typeInfo.instanceSize_ = instanceSize;
+    return typeInfo;
+}
+
+} // namespace
+
+TEST(AllocationProfilerTest, AggregateSamples) {
+    AllocationProfiler profiler;
+    TypeInfo type1 = MakeTypeInfo(16);
+    TypeInfo type2 = MakeTypeInfo(16);
+    void* stack1[] = {reinterpret_cast<void*>(1), reinterpret_cast<void*>(2)};
+    void* stack2[] = {reinterpret_cast<void*>(1), reinterpret_cast<void*>(3)};
+
+    profiler.Record(&type1, 1 << 20, 1, stack1, 2);
+    profiler.Record(&type1, 1 << 20, 1, stack1, 2);
+    profiler.Record(&type1, 1 << 20, 1, stack2, 2);
+    profiler.Record(&type2, 1 << 20, 1, stack1, 2);
+
+    auto samples = profiler.Samples();
+    ASSERT_THAT(samples.size(), 3);
+    for (auto& sample : samples) {
+        bool doubled = sample.typeInfo == &type1 && sample.stack == KStdVector<void*>(stack1, stack1 + 2);
+        // Allocations much bigger than the interval are always sampled, so they have the weight of 1.
+        EXPECT_THAT(sample.objects, DoubleNear(doubled ? 2 : 1, 1e-9));
+        EXPECT_THAT(sample.bytes, DoubleNear(doubled ? 2 << 20 : 1 << 20, 1e-3));
+    }
+
+    profiler.Clear();
+    EXPECT_THAT(profiler.Samples(), testing::IsEmpty());
+}
+
+TEST(AllocationProfilerTest, WeightSmallAllocations) {
+    AllocationProfiler profiler;
+    TypeInfo type = MakeTypeInfo(16);
+
+    profiler.Record(&type, 16, 1024, nullptr, 0);
+
+    auto samples = profiler.Samples();
+    ASSERT_THAT(samples.size(), 1);
+    double weight = 1 / (1 - std::exp(-16.0 / 1024));
+    EXPECT_THAT(samples[0].objects, DoubleNear(weight, 1e-9));
+    EXPECT_THAT(samples[0].bytes, DoubleNear(weight * 16, 1e-9));
+}
+
+TEST(AllocationProfilerTest, SampleAllocations) {
+    constexpr int kCount = 200000;
+    constexpr size_t kSize = 32;
+    auto& profiler = AllocationProfiler::Instance();
+    TypeInfo type = MakeTypeInfo(kSize);
+
+    for (int i = 0; i < kCount; ++i) {
+        ProfileAllocation(&type, kSize);
+    }
+    EXPECT_THAT(profiler.Samples(), testing::IsEmpty());
+
+    profiler.SetSamplingInterval(4096);
+    for (int i = 0; i < kCount; ++i) {
+        ProfileAllocation(&type, kSize);
+    }
+    profiler.SetSamplingInterval(0);
+
+    double objects = 0;
+    double bytes = 0;
+    for (auto& sample : profiler.Samples()) {
+        EXPECT_THAT(sample.typeInfo, &type);
+        objects += sample.objects;
+        bytes += sample.bytes;
+    }
+    // About 1500 samples are taken, so the estimate is well within 10%.
+    EXPECT_THAT(objects, DoubleNear(kCount, kCount * 0.1));
+    EXPECT_THAT(bytes, DoubleNear(kCount * kSize, kCount * kSize * 0.1));
+    profiler.Clear();
+}
+
+TEST(AllocationProfilerTest, WriteProfile) {
+    AllocationProfiler profiler;
+    profiler.SetSamplingInterval(512);
+    TypeInfo type1 = MakeTypeInfo(16);
+    TypeInfo type2 = MakeTypeInfo(16);
+    void* stack[] = {reinterpret_cast<void*>(1), reinterpret_cast<void*>(2)};
+    profiler.Record(&type1, 1 << 20, 512, stack, 2);
+    profiler.Record(&type2, 1 << 20, 512, stack, 1);
+
+    std::FILE* file = std::tmpfile();
+    EXPECT_TRUE(profiler.Write(file));
+    ProtoReader profile(ReadAll(file));
+    std::fclose(file);
+
+    auto strings = profile.Fields(6);
+    ASSERT_THAT(strings, testing::Not(testing::IsEmpty()));
+    EXPECT_THAT(strings[0], "");
+    EXPECT_THAT(strings, testing::IsSupersetOf({"alloc_objects", "alloc_space", "count", "bytes", "space", "object", "<anonymous>"}));
+    EXPECT_THAT(profile.Fields(1).size(), 2); // sample_type
+    EXPECT_THAT(profile.Fields(2).size(), 2); // sample
+    // Two code addresses and a pseudo-location for each type.
+    EXPECT_THAT(profile.Fields(4).size(), 4); // location
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ArrayKernels.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Alignment.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+#if defined(__SSE2__)
+
+void CopyNonTemporal(uint8_t* destination, const uint8_t* source, size_t size) noexcept {
+    constexpr size_t kStoreSize = sizeof(__m128i);
+    constexpr size_t kBlockSize = 4 * kStoreSize;
+
+    // Streaming stores require an aligned destination.
+    size_t head = static_cast<uint8_t*>(AlignUp(destination, kStoreSize)) - destination;
+    memcpy(destination, source, head);
+    destination += head;
+    source += head;
+    size -= head;
+
+    for (; size >= kBlockSize; size -= kBlockSize, destination += kBlockSize, source += kBlockSize) {
+        auto* from = reinterpret_cast<const __m128i*>(source);
+        auto* to = reinterpret_cast<__m128i*>(destination);
+        __m128i first = _mm_loadu_si128(from);
+        __m128i second = _mm_loadu_si128(from + 1);
+        __m128i third = _mm_loadu_si128(from + 2);
+        __m128i fourth = _mm_loadu_si128(from + 3);
+        _mm_stream_si128(to, first);
+        _mm_stream_si128(to + 1, second);
+        _mm_stream_si128(to + 2, third);
+        _mm_stream_si128(to + 3, fourth);
+    }
+    // Streaming stores are weakly ordered, make them visible before anything that follows.
+    _mm_sfence();
+    memcpy(destination, source, size);
+}
+
+#endif
+
+} // namespace
+
+void kotlin::CopyArray(void* destination, const void* source, size_t size) noexcept {
+#if defined(__SSE2__)
+    auto* to = static_cast<uint8_t*>(destination);
+    auto* from = static_cast<const uint8_t*>(source);
+    bool overlap = to < from + size && from < to + size;
+    if (size >= kNonTemporalCopyThreshold && !overlap) {
+        CopyNonTemporal(to, from, size);
+        return;
+    }
+#endif
+    memmove(destination, source, size);
+}
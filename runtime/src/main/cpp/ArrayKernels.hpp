@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_ARRAY_KERNELS_H
+#define RUNTIME_ARRAY_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace kotlin {
+
+// Copies larger than this bypass the cache with non-temporal stores (where supported): the destination
+// wouldn't fit into the cache anyway, and reading it in first only halves the available bandwidth.
+constexpr size_t kNonTemporalCopyThreshold = 4 * 1024 * 1024;
+
+// Width of a single store in `FillArray`. Compilers split it into several stores on targets with narrower vectors.
+constexpr size_t kFillVectorSize = 32;
+
+// Fills `count` elements starting at `destination` with `value`.
+template <typename T>
+void FillArray(T* destination, size_t count, T value) {
+    if constexpr (sizeof(T) == 1) {
+        memset(destination, static_cast<uint8_t>(value), count);
+    } else {
+        uint8_t bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        bool uniformBytes = true;
+        for (size_t i = 1; i < sizeof(T); ++i) {
+            uniformBytes &= bytes[i] == bytes[0];
+        }
+        if (uniformBytes) {
+            // Zeroes and -1 of any width.
+            memset(destination, bytes[0], count * sizeof(T));
+            return;
+        }
+
+        constexpr size_t kLanes = kFillVectorSize / sizeof(T);
+        typedef T Vector __attribute__((vector_size(kFillVectorSize)));
+        Vector splat;
+        for (size_t i = 0; i < kLanes; ++i) {
+            splat[i] = value;
+        }
+        // memcpy keeps it legal for unaligned destinations and compiles to single vector stores.
+        for (; count >= 4 * kLanes; count -= 4 * kLanes, destination += 4 * kLanes) {
+            memcpy(destination, &splat, sizeof(splat));
+            memcpy(destination + kLanes, &splat, sizeof(splat));
+            memcpy(destination + 2 * kLanes, &splat, sizeof(splat));
+            memcpy(destination + 3 * kLanes, &splat, sizeof(splat));
+        }
+        for (; count >= kLanes; count -= kLanes, destination += kLanes) {
+            memcpy(destination, &splat, sizeof(splat));
+        }
+        for (; count > 0; --count) {
+            *destination++ = value;
+        }
+    }
+}
+
+// Same as `memmove`, but uses non-temporal stores for large non-overlapping ranges.
+void CopyArray(void* destination, const void* source, size_t size) noexcept;
+
+} // namespace kotlin
+
+#endif // RUNTIME_ARRAY_KERNELS_H
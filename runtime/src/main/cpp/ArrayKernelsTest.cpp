@@ -0,0 +1,85 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ArrayKernels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+template <typename T>
+class FillArrayTest : public testing::Test {};
+
+using FillArrayTypes = testing::Types<KBoolean, KByte, KChar, KShort, KInt, KLong, KFloat, KDouble>;
+TYPED_TEST_SUITE(FillArrayTest, FillArrayTypes);
+
+template <typename T>
+void CheckFill(size_t size, size_t from, size_t to, T value, T background) {
+    // Not std::vector, because of std::vector<bool>.
+    std::unique_ptr<T[]> array(new T[size]);
+    std::fill(array.get(), array.get() + size, background);
+    FillArray(array.get() + from, to - from, value);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(array[i], (i >= from && i < to) ? value : background) << "at " << i;
+    }
+}
+
+} // namespace
+
+TYPED_TEST(FillArrayTest, Empty) {
+    CheckFill<TypeParam>(10, 3, 3, static_cast<TypeParam>(1), static_cast<TypeParam>(0));
+}
+
+TYPED_TEST(FillArrayTest, UniformBytes) {
+    CheckFill<TypeParam>(100, 0, 100, static_cast<TypeParam>(0), static_cast<TypeParam>(1));
+    CheckFill<TypeParam>(100, 1, 99, static_cast<TypeParam>(0), static_cast<TypeParam>(1));
+}
+
+TYPED_TEST(FillArrayTest, AllSizesAndOffsets) {
+    for (size_t from = 0; from < 9; ++from) {
+        for (size_t to = from; to < 300; to += 7) {
+            CheckFill<TypeParam>(300, from, to, static_cast<TypeParam>(1), static_cast<TypeParam>(0));
+        }
+    }
+}
+
+TEST(CopyArrayTest, Small) {
+    std::vector<KInt> source = {1, 2, 3, 4, 5};
+    std::vector<KInt> destination(5, 0);
+    CopyArray(destination.data() + 1, source.data(), 3 * sizeof(KInt));
+    EXPECT_THAT(destination, testing::ElementsAre(0, 1, 2, 3, 0));
+}
+
+TEST(CopyArrayTest, OverlappingLarge) {
+    constexpr size_t kCount = kNonTemporalCopyThreshold / sizeof(KInt) + 1000;
+    std::vector<KInt> array(kCount + 3);
+    for (size_t i = 0; i < array.size(); ++i) array[i] = static_cast<KInt>(i);
+    CopyArray(array.data() + 3, array.data(), kCount * sizeof(KInt));
+    for (size_t i = 0; i < kCount; ++i) {
+        ASSERT_EQ(array[i + 3], static_cast<KInt>(i));
+    }
+}
+
+TEST(CopyArrayTest, Large) {
+    constexpr size_t kSize = kNonTemporalCopyThreshold + 123;
+    std::vector<uint8_t> source(kSize);
+    for (size_t i = 0; i < kSize; ++i) source[i] = static_cast<uint8_t>(i * 31);
+    for (size_t offset : {0, 1, 7, 16}) {
+        std::vector<uint8_t> destination(kSize + 32, 0);
+        CopyArray(destination.data() + offset, source.data(), kSize);
+        EXPECT_TRUE(std::equal(source.begin(), source.end(), destination.begin() + offset));
+        EXPECT_EQ(destination[offset + kSize], 0);
+    }
+}
@@ -17,10 +17,13 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "Alloc.h"
+#include "ArrayKernels.hpp"
 #include "KAssert.h"
 #include "Exceptions.h"
 #include "Memory.h"
 #include "Natives.h"
+#include "Sorting.hpp"
 #include "Types.h"
 
 extern "C" void checkRangeIndexes(KInt from, KInt to, KInt size);
@@ -48,10 +51,46 @@ inline void fillImpl(KRef thiz, KInt fromIndex, KInt toIndex, T value) {
   ArrayHeader* array = thiz->array();
   checkRangeIndexes(fromIndex, toIndex, array->count_);
   mutabilityCheck(thiz);
-  T* address = PrimitiveArrayAddressOfElementAt<T>(array, fromIndex);
-  for (KInt index = fromIndex; index < toIndex; ++index) {
-    *address++ = value;
+  kotlin::FillArray(PrimitiveArrayAddressOfElementAt<T>(array, fromIndex), toIndex - fromIndex, value);
+}
+
+// Below this size pdqsort beats radix sort, which also needs a buffer as large as the array.
+constexpr KInt kRadixSortThreshold = 1 << 12;
+
+template<typename T>
+inline T* sortRange(KRef thiz, KInt fromIndex, KInt toIndex) {
+  ArrayHeader* array = thiz->array();
+  checkRangeIndexes(fromIndex, toIndex, array->count_);
+  mutabilityCheck(thiz);
+  return PrimitiveArrayAddressOfElementAt<T>(array, fromIndex);
+}
+
+template<typename T>
+inline void sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  T* begin = sortRange<T>(thiz, fromIndex, toIndex);
+  if (toIndex - fromIndex < 2) return;
+  kotlin::PdqSort(begin, begin + (toIndex - fromIndex));
+}
+
+template<typename T>
+inline void radixSortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  T* begin = sortRange<T>(thiz, fromIndex, toIndex);
+  KInt count = toIndex - fromIndex;
+  if (count < 2) return;
+  T* buffer = count >= kRadixSortThreshold ? konanAllocArray<T>(count) : nullptr;
+  if (buffer == nullptr) {
+    kotlin::PdqSort(begin, begin + count);
+    return;
   }
+  kotlin::RadixSort(begin, begin + count, buffer);
+  konanFreeMemory(buffer);
+}
+
+template<typename T>
+inline void countingSortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  T* begin = sortRange<T>(thiz, fromIndex, toIndex);
+  if (toIndex - fromIndex < 2) return;
+  kotlin::CountingSort(begin, begin + (toIndex - fromIndex));
 }
 
 template<typename T>
@@ -65,9 +104,9 @@ inline void copyImpl(KConstRef thiz, KInt fromIndex,
       ThrowArrayIndexOutOfBoundsException();
   }
   mutabilityCheck(destination);
-  memmove(PrimitiveArrayAddressOfElementAt<T>(destinationArray, toIndex),
-          PrimitiveArrayAddressOfElementAt<T>(array, fromIndex),
-          count * sizeof(T));
+  kotlin::CopyArray(PrimitiveArrayAddressOfElementAt<T>(destinationArray, toIndex),
+                    PrimitiveArrayAddressOfElementAt<T>(array, fromIndex),
+                    count * sizeof(T));
 }
 
 
@@ -133,8 +172,9 @@ void Kotlin_Array_copyImpl(KConstRef thiz, KInt fromIndex,
     ThrowArrayIndexOutOfBoundsException();
   }
   mutabilityCheck(destination);
-  if (CurrentMemoryModel != MemoryModel::kExperimental && array == destinationArray &&
-      std::abs(fromIndex - toIndex) < count) {
+  if (CurrentMemoryModel == MemoryModel::kExperimental) {
+    CopyHeapRefs(ArrayAddressOfElementAt(destinationArray, toIndex), ArrayAddressOfElementAt(array, fromIndex), count);
+  } else if (array == destinationArray && std::abs(fromIndex - toIndex) < count) {
     UpdateHeapRefsInsideOneArray(array, fromIndex, toIndex, count);
   } else {
     if (fromIndex >= toIndex) {
@@ -528,6 +568,38 @@ void Kotlin_BooleanArray_fillImpl(KRef thiz, KInt fromIndex, KInt toIndex, KBool
   fillImpl<KBoolean>(thiz, fromIndex, toIndex, value);
 }
 
+void Kotlin_ByteArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  countingSortImpl<KByte>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_ShortArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  sortImpl<KShort>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_CharArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  sortImpl<KChar>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_IntArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  radixSortImpl<KInt>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_LongArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  radixSortImpl<KLong>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_FloatArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  sortImpl<KFloat>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_DoubleArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  sortImpl<KDouble>(thiz, fromIndex, toIndex);
+}
+
+void Kotlin_BooleanArray_sortImpl(KRef thiz, KInt fromIndex, KInt toIndex) {
+  countingSortImpl<KBoolean>(thiz, fromIndex, toIndex);
+}
+
 void Kotlin_ByteArray_copyImpl(KConstRef thiz, KInt fromIndex,
                               KRef destination, KInt toIndex, KInt count) {
   copyImpl<KByte>(thiz, fromIndex, destination, toIndex, count);
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_BYTE_ORDER_H
+#define RUNTIME_BYTE_ORDER_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "Common.h"
+
+namespace kotlin {
+
+// Loads and stores of primitive values at arbitrary addresses. `memcpy` lets the compiler pick a single
+// unaligned access where the target supports it and byte accesses otherwise (KONAN_NO_UNALIGNED_ACCESS).
+template <typename T>
+ALWAYS_INLINE inline T LoadUnaligned(const void* address) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    T result;
+    memcpy(&result, address, sizeof(T));
+    return result;
+}
+
+template <typename T>
+ALWAYS_INLINE inline void StoreUnaligned(void* address, T value) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+    memcpy(address, &value, sizeof(T));
+}
+
+namespace internal {
+
+template <size_t Size>
+struct UnsignedOfSize;
+
+template <>
+struct UnsignedOfSize<1> {
+    using Type = uint8_t;
+    static Type Swap(Type value) noexcept { return value; }
+};
+
+template <>
+struct UnsignedOfSize<2> {
+    using Type = uint16_t;
+    static Type Swap(Type value) noexcept { return __builtin_bswap16(value); }
+};
+
+template <>
+struct UnsignedOfSize<4> {
+    using Type = uint32_t;
+    static Type Swap(Type value) noexcept { return __builtin_bswap32(value); }
+};
+
+template <>
+struct UnsignedOfSize<8> {
+    using Type = uint64_t;
+    static Type Swap(Type value) noexcept { return __builtin_bswap64(value); }
+};
+
+} // namespace internal
+
+// Reverses the byte order of an integral or floating point value.
+template <typename T>
+ALWAYS_INLINE inline T ByteSwap(T value) noexcept {
+    using Unsigned = internal::UnsignedOfSize<sizeof(T)>;
+    auto bits = Unsigned::Swap(LoadUnaligned<typename Unsigned::Type>(&value));
+    return LoadUnaligned<T>(&bits);
+}
+
+constexpr bool kIsLittleEndian =
+#if __BIG_ENDIAN__
+        false;
+#else
+        true;
+#endif
+
+template <typename T>
+ALWAYS_INLINE inline T LoadLittleEndian(const void* address) noexcept {
+    T value = LoadUnaligned<T>(address);
+    return kIsLittleEndian ? value : ByteSwap(value);
+}
+
+template <typename T>
+ALWAYS_INLINE inline T LoadBigEndian(const void* address) noexcept {
+    T value = LoadUnaligned<T>(address);
+    return kIsLittleEndian ? ByteSwap(value) : value;
+}
+
+template <typename T>
+ALWAYS_INLINE inline void StoreLittleEndian(void* address, T value) noexcept {
+    StoreUnaligned(address, kIsLittleEndian ? value : ByteSwap(value));
+}
+
+template <typename T>
+ALWAYS_INLINE inline void StoreBigEndian(void* address, T value) noexcept {
+    StoreUnaligned(address, kIsLittleEndian ? ByteSwap(value) : value);
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_BYTE_ORDER_H
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ByteOrder.hpp"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+using namespace kotlin;
+
+TEST(ByteOrderTest, ByteSwap) {
+    EXPECT_EQ(ByteSwap<uint8_t>(0x12), 0x12);
+    EXPECT_EQ(ByteSwap<uint16_t>(0x1234), 0x3412);
+    EXPECT_EQ(ByteSwap<int32_t>(0x12345678), 0x78563412);
+    EXPECT_EQ(ByteSwap<uint64_t>(0x0102030405060708ULL), 0x0807060504030201ULL);
+    EXPECT_EQ(ByteSwap(ByteSwap(3.25)), 3.25);
+    EXPECT_EQ(ByteSwap(ByteSwap(-1.5f)), -1.5f);
+}
+
+TEST(ByteOrderTest, UnalignedAccess) {
+    uint8_t buffer[16] = {};
+    for (size_t offset = 0; offset < 8; ++offset) {
+        StoreUnaligned<int64_t>(buffer + offset, -2);
+        EXPECT_EQ(LoadUnaligned<int64_t>(buffer + offset), -2);
+        StoreUnaligned<double>(buffer + offset, 0.1);
+        EXPECT_EQ(LoadUnaligned<double>(buffer + offset), 0.1);
+    }
+}
+
+TEST(ByteOrderTest, LittleAndBigEndian) {
+    uint8_t buffer[9] = {};
+    StoreLittleEndian<uint32_t>(buffer + 1, 0x01020304);
+    EXPECT_EQ(buffer[1], 0x04);
+    EXPECT_EQ(buffer[4], 0x01);
+    EXPECT_EQ(LoadLittleEndian<uint32_t>(buffer + 1), 0x01020304u);
+    EXPECT_EQ(LoadBigEndian<uint32_t>(buffer + 1), 0x04030201u);
+
+    StoreBigEndian<int16_t>(buffer + 3, 0x0102);
+    EXPECT_EQ(buffer[3], 0x01);
+    EXPECT_EQ(buffer[4], 0x02);
+    EXPECT_EQ(LoadBigEndian<int16_t>(buffer + 3), 0x0102);
+
+    StoreBigEndian<float>(buffer, 1.0f);
+    EXPECT_EQ(buffer[0], 0x3f);
+    EXPECT_EQ(buffer[1], 0x80);
+    EXPECT_EQ(LoadBigEndian<float>(buffer), 1.0f);
+
+    StoreLittleEndian<double>(buffer, NAN);
+    EXPECT_TRUE(std::isnan(LoadLittleEndian<double>(buffer)));
+}
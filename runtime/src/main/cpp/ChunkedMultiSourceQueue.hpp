@@ -0,0 +1,198 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_CHUNKED_MULTI_SOURCE_QUEUE_H
+#define RUNTIME_CHUNKED_MULTI_SOURCE_QUEUE_H
+
+#include <mutex>
+
+#include "Mutex.hpp"
+#include "NodeChunk.hpp"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// A `MultiSourceQueue` that stores elements in `NodeChunk`s instead of separately allocated list nodes.
+// Each `Producer` inserts into chunks it owns and publishing moves whole chunks to the queue. Once its own chunks
+// are full, a `Producer` first fills free nodes of published chunks under the queue lock, so that frequent
+// publication does not leave a trail of barely used chunks. Such elements are visible to `Iter` right away.
+// Iteration sweeps the chunks linearly. The order of iteration is only guaranteed for elements of the same chunk
+// inserted with no erasures in between.
+template <typename T>
+class ChunkedMultiSourceQueue : private Pinned {
+public:
+    class Producer;
+
+private:
+    using Chunk = NodeChunk<T, Producer>;
+
+public:
+    using Node = typename Chunk::Node;
+
+    class Producer {
+    public:
+        explicit Producer(ChunkedMultiSourceQueue& owner) noexcept : owner_(owner) {}
+
+        ~Producer() { Publish(); }
+
+        Node* Insert(const T& value) noexcept {
+            Chunk* chunk = chunks_.first();
+            if (chunk == nullptr || chunk->full()) {
+                if (Node* node = owner_.InsertIntoPublished(value)) {
+                    return node;
+                }
+                chunk = AcquireChunk();
+            }
+            Node* node = chunk->Emplace(value);
+            chunks_.Update(chunk, false);
+            return node;
+        }
+
+        void Erase(Node* node) noexcept {
+            Chunk* chunk = node->chunk();
+            if (chunk->owner() == this) {
+                // If we own it, delete it immediately.
+                bool wasFull = chunk->full();
+                chunk->Erase(node);
+                chunks_.Update(chunk, wasFull);
+                return;
+            }
+            // If it's owned by the global queue or some other `Producer`, queue it.
+            deletionQueue_.push_back(node);
+        }
+
+        // Merge `this` queue with owning `ChunkedMultiSourceQueue`. `this` will have no elements after the call,
+        // but may keep an empty chunk for the following insertions. This call is performed without heap allocations.
+        void Publish() noexcept {
+            std::lock_guard<SpinLock> guard(owner_.mutex_);
+            Chunk* kept = nullptr;
+            while (Chunk* chunk = chunks_.first()) {
+                chunks_.Remove(chunk);
+                if (!chunk->empty()) {
+                    chunk->owner() = nullptr;
+                    owner_.chunks_.Insert(chunk);
+                } else if (kept == nullptr) {
+                    kept = chunk;
+                } else {
+                    Chunk::Destroy(chunk);
+                }
+            }
+            if (kept != nullptr) {
+                chunks_.Insert(kept);
+            }
+            owner_.deletionQueue_.splice(owner_.deletionQueue_.end(), deletionQueue_);
+        }
+
+        void ClearForTests() noexcept {
+            chunks_.Clear();
+            deletionQueue_.clear();
+        }
+
+    private:
+        // Published chunks are never taken back: their elements must stay visible to `Iter` regardless of what
+        // producers do.
+        Chunk* AcquireChunk() noexcept {
+            Chunk* chunk = Chunk::Create(this);
+            chunks_.Insert(chunk);
+            return chunk;
+        }
+
+        ChunkedMultiSourceQueue& owner_; // weak
+        NodeChunkList<Chunk> chunks_;
+        KStdList<Node*> deletionQueue_;
+    };
+
+    class Iterator {
+    public:
+        T& operator*() noexcept { return **position_; }
+
+        Iterator& operator++() noexcept {
+            ++position_;
+            return *this;
+        }
+
+        bool operator==(const Iterator& rhs) const noexcept { return position_ == rhs.position_; }
+
+        bool operator!=(const Iterator& rhs) const noexcept { return position_ != rhs.position_; }
+
+    private:
+        friend class ChunkedMultiSourceQueue;
+
+        explicit Iterator(Chunk* chunk) noexcept : position_(chunk) {}
+
+        NodeChunkIterator<Chunk> position_;
+    };
+
+    class Iterable : MoveOnly {
+    public:
+        Iterator begin() noexcept { return Iterator(owner_.chunks_.first()); }
+        Iterator end() noexcept { return Iterator(nullptr); }
+
+    private:
+        friend class ChunkedMultiSourceQueue;
+
+        explicit Iterable(ChunkedMultiSourceQueue& owner) noexcept : owner_(owner), guard_(owner_.mutex_) {}
+
+        ChunkedMultiSourceQueue& owner_; // weak
+        std::unique_lock<SpinLock> guard_;
+    };
+
+    ChunkedMultiSourceQueue() noexcept = default;
+
+    // Lock `ChunkedMultiSourceQueue` for safe iteration. If element was scheduled for deletion,
+    // it'll still be iterated. Use `ApplyDeletions` to remove those elements.
+    Iterable Iter() noexcept { return Iterable(*this); }
+
+    // Lock `ChunkedMultiSourceQueue` and apply deletions. Only deletes elements that were published.
+    // Chunks that become empty are released.
+    void ApplyDeletions() noexcept {
+        std::lock_guard<SpinLock> guard(mutex_);
+        auto it = deletionQueue_.begin();
+        while (it != deletionQueue_.end()) {
+            Node* node = *it;
+            Chunk* chunk = node->chunk();
+            if (chunk->owner() != nullptr) {
+                // If the `Node` is still owned by some `Producer`, skip it.
+                ++it;
+                continue;
+            }
+            bool wasFull = chunk->full();
+            chunk->Erase(node);
+            if (chunk->empty()) {
+                chunks_.Remove(chunk);
+                Chunk::Destroy(chunk);
+            } else {
+                chunks_.Update(chunk, wasFull);
+            }
+            it = deletionQueue_.erase(it);
+        }
+    }
+
+    void ClearForTests() noexcept {
+        std::lock_guard<SpinLock> guard(mutex_);
+        chunks_.Clear();
+        deletionQueue_.clear();
+    }
+
+private:
+    // Returns `nullptr` if all published chunks are full.
+    Node* InsertIntoPublished(const T& value) noexcept {
+        std::lock_guard<SpinLock> guard(mutex_);
+        Chunk* chunk = chunks_.first();
+        if (chunk == nullptr || chunk->full()) return nullptr;
+        Node* node = chunk->Emplace(value);
+        chunks_.Update(chunk, false);
+        return node;
+    }
+
+    NodeChunkList<Chunk> chunks_;
+    KStdList<Node*> deletionQueue_;
+    SpinLock mutex_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_CHUNKED_MULTI_SOURCE_QUEUE_H
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ChunkedMultiSourceQueue.hpp"
+#include "MultiSourceQueue.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+// Microbenchmarks comparing the list based `MultiSourceQueue` with its chunked counterpart. They only report
+// timings, so they are disabled by default. Run with `--gtest_also_run_disabled_tests --gtest_filter=*Benchmark*`.
+
+namespace {
+
+constexpr int kElementCount = 1000000;
+constexpr int kIterationCount = 10;
+
+class Stopwatch {
+public:
+    Stopwatch(const char* name, int64_t operationCount) noexcept :
+        name_(name), operationCount_(operationCount), start_(std::chrono::steady_clock::now()) {}
+
+    ~Stopwatch() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        std::printf("%-50s %8.2f ns/op\n", name_, static_cast<double>(elapsed.count()) / operationCount_);
+    }
+
+private:
+    const char* name_;
+    int64_t operationCount_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+template <typename Queue>
+void BenchmarkQueue(const char* insertName, const char* iterateName, const char* eraseName) {
+    Queue queue;
+    typename Queue::Producer producer(queue);
+    KStdVector<typename Queue::Node*> nodes;
+    nodes.reserve(kElementCount);
+
+    {
+        Stopwatch stopwatch(insertName, kElementCount);
+        for (int i = 0; i < kElementCount; ++i) {
+            nodes.push_back(producer.Insert(i));
+        }
+        producer.Publish();
+    }
+
+    int64_t sum = 0;
+    {
+        Stopwatch stopwatch(iterateName, static_cast<int64_t>(kElementCount) * kIterationCount);
+        for (int i = 0; i < kIterationCount; ++i) {
+            for (int element : queue.Iter()) {
+                sum += element;
+            }
+        }
+    }
+    EXPECT_THAT(sum, static_cast<int64_t>(kElementCount) * (kElementCount - 1) / 2 * kIterationCount);
+
+    {
+        Stopwatch stopwatch(eraseName, kElementCount);
+        for (auto* node : nodes) {
+            producer.Erase(node);
+        }
+        producer.Publish();
+        queue.ApplyDeletions();
+    }
+}
+
+} // namespace
+
+TEST(ChunkedMultiSourceQueueBenchmark, DISABLED_MultiSourceQueue) {
+    BenchmarkQueue<MultiSourceQueue<int>>("MultiSourceQueue insert", "MultiSourceQueue iterate", "MultiSourceQueue erase");
+}
+
+TEST(ChunkedMultiSourceQueueBenchmark, DISABLED_ChunkedMultiSourceQueue) {
+    BenchmarkQueue<ChunkedMultiSourceQueue<int>>(
+            "ChunkedMultiSourceQueue insert", "ChunkedMultiSourceQueue iterate", "ChunkedMultiSourceQueue erase");
+}
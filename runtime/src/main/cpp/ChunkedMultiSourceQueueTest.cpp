@@ -0,0 +1,408 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ChunkedMultiSourceQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "TestSupport.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+template <typename T>
+KStdVector<T> Collect(ChunkedMultiSourceQueue<T>& queue) {
+    KStdVector<T> result;
+    for (const auto& element : queue.Iter()) {
+        result.push_back(element);
+    }
+    return result;
+}
+
+} // namespace
+
+using IntQueue = ChunkedMultiSourceQueue<int>;
+
+TEST(ChunkedMultiSourceQueueTest, Insert) {
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+
+    auto* node1 = producer.Insert(kFirst);
+    auto* node2 = producer.Insert(kSecond);
+
+    EXPECT_THAT(**node1, kFirst);
+    EXPECT_THAT(**node2, kSecond);
+}
+
+TEST(ChunkedMultiSourceQueueTest, EraseFromTheSameProducer) {
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+
+    producer.Insert(kFirst);
+    auto* node2 = producer.Insert(kSecond);
+    producer.Erase(node2);
+    producer.Publish();
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::ElementsAre(kFirst));
+}
+
+TEST(ChunkedMultiSourceQueueTest, EraseFromGlobal) {
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+
+    producer.Insert(kFirst);
+    auto* node2 = producer.Insert(kSecond);
+    producer.Publish();
+    producer.Erase(node2);
+    producer.Publish();
+
+    auto actual1 = Collect(queue);
+    EXPECT_THAT(actual1, testing::ElementsAre(kFirst, kSecond));
+
+    queue.ApplyDeletions();
+
+    auto actual2 = Collect(queue);
+    EXPECT_THAT(actual2, testing::ElementsAre(kFirst));
+}
+
+TEST(ChunkedMultiSourceQueueTest, EraseFromOtherProducer) {
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    constexpr int kFirst = 1;
+    constexpr int kSecond = 2;
+
+    producer1.Insert(kFirst);
+    auto* node2 = producer1.Insert(kSecond);
+    producer2.Erase(node2);
+    producer1.Publish();
+
+    auto actual1 = Collect(queue);
+    EXPECT_THAT(actual1, testing::ElementsAre(kFirst, kSecond));
+
+    queue.ApplyDeletions();
+
+    auto actual2 = Collect(queue);
+    EXPECT_THAT(actual2, testing::ElementsAre(kFirst, kSecond));
+
+    producer2.Publish();
+
+    auto actual3 = Collect(queue);
+    EXPECT_THAT(actual3, testing::ElementsAre(kFirst, kSecond));
+
+    queue.ApplyDeletions();
+
+    auto actual4 = Collect(queue);
+    EXPECT_THAT(actual4, testing::ElementsAre(kFirst));
+}
+
+TEST(ChunkedMultiSourceQueueTest, PublishedElementsStayVisible) {
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    auto* node1 = producer1.Insert(1);
+    producer1.Insert(2);
+    producer1.Insert(3);
+    producer1.Publish();
+    EXPECT_THAT(Collect(queue), testing::ElementsAre(1, 2, 3));
+
+    // Another producer fills the published chunk in place instead of taking it, neither on its first insertion...
+    auto* node4 = producer2.Insert(4);
+    EXPECT_THAT(node4->chunk(), node1->chunk());
+    EXPECT_THAT(Collect(queue), testing::ElementsAre(1, 2, 3, 4));
+
+    // ...nor after a deletion freed a node in a published chunk.
+    producer1.Erase(node1);
+    producer1.Publish();
+    queue.ApplyDeletions();
+    producer2.Insert(5);
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAre(2, 3, 4, 5));
+
+    producer2.Publish();
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAre(2, 3, 4, 5));
+}
+
+TEST(ChunkedMultiSourceQueueTest, PublishedElementsStayVisibleDuringConcurrentInsert) {
+    constexpr int kPublished = 3;
+    IntQueue queue;
+    {
+        IntQueue::Producer producer(queue);
+        for (int i = 0; i < kPublished; ++i) {
+            producer.Insert(i);
+        }
+    }
+
+    std::atomic<bool> canStart(false);
+    std::atomic<bool> done(false);
+    std::thread inserter([&queue, &canStart, &done] {
+        IntQueue::Producer producer(queue);
+        while (!canStart) {
+        }
+        // Fill more than one chunk, so that new chunks are acquired while the other thread iterates.
+        for (int i = 0; i < 10000; ++i) {
+            producer.Insert(kPublished + i);
+        }
+        done = true;
+        producer.ClearForTests();
+    });
+
+    canStart = true;
+    do {
+        EXPECT_THAT(Collect(queue), testing::IsSupersetOf({0, 1, 2}));
+    } while (!done);
+    inserter.join();
+}
+
+TEST(ChunkedMultiSourceQueueTest, Empty) {
+    IntQueue queue;
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::IsEmpty());
+}
+
+TEST(ChunkedMultiSourceQueueTest, DoNotPublish) {
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    producer.Insert(1);
+    producer.Insert(2);
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::IsEmpty());
+}
+
+TEST(ChunkedMultiSourceQueueTest, Publish) {
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    producer1.Insert(1);
+    producer1.Insert(2);
+    producer2.Insert(10);
+    producer2.Insert(20);
+
+    producer1.Publish();
+    producer2.Publish();
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::UnorderedElementsAre(1, 2, 10, 20));
+}
+
+TEST(ChunkedMultiSourceQueueTest, PublishSeveralTimes) {
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    // Add 2 elements and publish.
+    producer.Insert(1);
+    producer.Insert(2);
+    producer.Publish();
+
+    // Add another element and publish.
+    producer.Insert(3);
+    producer.Publish();
+
+    // Publish without adding elements.
+    producer.Publish();
+
+    // Add yet another two elements and publish.
+    producer.Insert(4);
+    producer.Insert(5);
+    producer.Publish();
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::ElementsAre(1, 2, 3, 4, 5));
+}
+
+TEST(ChunkedMultiSourceQueueTest, PublishAfterEveryInsert) {
+    constexpr int kCount = 1000;
+    IntQueue queue;
+    IntQueue::Producer producer(queue);
+
+    KStdVector<IntQueue::Node*> nodes;
+    KStdVector<int> expected;
+    for (int i = 0; i < kCount; ++i) {
+        nodes.push_back(producer.Insert(i));
+        producer.Publish();
+        expected.push_back(i);
+    }
+
+    // Elements share chunks instead of taking a chunk per publication.
+    KStdVector<void*> chunks;
+    for (auto* node : nodes) {
+        if (std::find(chunks.begin(), chunks.end(), node->chunk()) == chunks.end()) {
+            chunks.push_back(node->chunk());
+        }
+    }
+    EXPECT_THAT(chunks.size(), testing::Lt(kCount / 100));
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAreArray(expected));
+}
+
+TEST(ChunkedMultiSourceQueueTest, PublishInDestructor) {
+    IntQueue queue;
+
+    {
+        IntQueue::Producer producer(queue);
+        producer.Insert(1);
+        producer.Insert(2);
+    }
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::ElementsAre(1, 2));
+}
+
+TEST(ChunkedMultiSourceQueueTest, ManyElements) {
+    constexpr int kCount = 2000;
+    IntQueue queue;
+    IntQueue::Producer producer1(queue);
+    IntQueue::Producer producer2(queue);
+
+    KStdVector<IntQueue::Node*> nodes;
+    KStdVector<int> expected;
+    for (int i = 0; i < kCount; ++i) {
+        nodes.push_back(producer1.Insert(i));
+        expected.push_back(i);
+    }
+    producer1.Publish();
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAreArray(expected));
+
+    // Erase every other element from another producer.
+    expected.clear();
+    for (int i = 0; i < kCount; ++i) {
+        if (i % 2 == 0) {
+            producer2.Erase(nodes[i]);
+        } else {
+            expected.push_back(i);
+        }
+    }
+    producer2.Publish();
+    queue.ApplyDeletions();
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAreArray(expected));
+
+    // New elements reuse the freed nodes of published chunks.
+    for (int i = kCount; i < kCount + kCount / 4; ++i) {
+        auto* node = producer2.Insert(i);
+        EXPECT_THAT(std::find(nodes.begin(), nodes.end(), node), testing::Ne(nodes.end()));
+        expected.push_back(i);
+    }
+    producer2.Publish();
+    EXPECT_THAT(Collect(queue), testing::UnorderedElementsAreArray(expected));
+}
+
+TEST(ChunkedMultiSourceQueueTest, DestroysValues) {
+    auto value = std::make_shared<int>(42);
+    {
+        ChunkedMultiSourceQueue<std::shared_ptr<int>> queue;
+        ChunkedMultiSourceQueue<std::shared_ptr<int>>::Producer producer(queue);
+        auto* node = producer.Insert(value);
+        producer.Insert(value);
+        producer.Insert(value);
+        EXPECT_THAT(value.use_count(), 4);
+
+        producer.Erase(node);
+        EXPECT_THAT(value.use_count(), 3);
+
+        producer.ClearForTests();
+        EXPECT_THAT(value.use_count(), 1);
+
+        producer.Insert(value);
+        producer.Publish();
+        EXPECT_THAT(value.use_count(), 2);
+    }
+    EXPECT_THAT(value.use_count(), 1);
+}
+
+TEST(ChunkedMultiSourceQueueTest, ConcurrentPublish) {
+    IntQueue queue;
+    constexpr int kThreadCount = kDefaultThreadCount;
+    std::atomic<bool> canStart(false);
+    std::atomic<int> readyCount(0);
+    KStdVector<std::thread> threads;
+    KStdVector<int> expected;
+
+    for (int i = 0; i < kThreadCount; ++i) {
+        expected.push_back(i);
+        threads.emplace_back([i, &queue, &canStart, &readyCount]() {
+            IntQueue::Producer producer(queue);
+            producer.Insert(i);
+            ++readyCount;
+            while (!canStart) {
+            }
+            producer.Publish();
+        });
+    }
+
+    while (readyCount < kThreadCount) {
+    }
+    canStart = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::UnorderedElementsAreArray(expected));
+}
+
+TEST(ChunkedMultiSourceQueueTest, ConcurrentPublishAndApplyDeletions) {
+    IntQueue queue;
+    constexpr int kThreadCount = kDefaultThreadCount;
+
+    std::atomic<bool> canStart(false);
+    std::atomic<int> readyCount(0);
+    std::atomic<int> startedCount(0);
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&queue, i, &canStart, &readyCount, &startedCount]() {
+            IntQueue::Producer producer(queue);
+            auto* node = producer.Insert(i);
+            producer.Publish();
+            producer.Erase(node);
+            ++readyCount;
+            while (!canStart) {
+            }
+            ++startedCount;
+            producer.Publish();
+        });
+    }
+
+    while (readyCount < kThreadCount) {
+    }
+    canStart = true;
+    while (startedCount < kThreadCount) {
+    }
+
+    queue.ApplyDeletions();
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // We do not know which elements were deleted at this point. Expecting not to crash by this point.
+
+    // This must make the queue empty.
+    queue.ApplyDeletions();
+
+    auto actual = Collect(queue);
+    EXPECT_THAT(actual, testing::IsEmpty());
+}
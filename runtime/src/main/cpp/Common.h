@@ -35,7 +35,8 @@
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
 
-#if KONAN_OBJC_INTEROP
+// The writable part is used by the Objective-C export and by per-type counters (see TypeCounters.hpp).
+#if KONAN_OBJC_INTEROP || !defined(KONAN_WASM)
 #define KONAN_TYPE_INFO_HAS_WRITABLE_PART 1
 #endif
 
@@ -23,6 +23,23 @@
 
 #include "utf8.h"
 
+namespace {
+
+struct LineReader {
+  ObjHeader** result;
+  // Chunks of a line, which does not fit into the input buffer.
+  KStdString chunks;
+  ObjHeader* line = nullptr;
+
+  void create(const char* utf8, uint32_t sizeBytes) {
+    // Strip the carriage return of "\r\n" line ends.
+    if (sizeBytes > 0 && utf8[sizeBytes - 1] == '\r') sizeBytes--;
+    line = CreateStringFromUtf8(utf8, sizeBytes, result);
+  }
+};
+
+}  // namespace
+
 extern "C" {
 
 // io/Console.kt
@@ -51,12 +68,30 @@ void Kotlin_io_Console_println0() {
   konan::consoleWriteUtf8("\n", 1);
 }
 
+void Kotlin_io_Console_flush() {
+  konan::consoleFlush();
+}
+
 OBJ_GETTER0(Kotlin_io_Console_readLine) {
-  char data[4096];
-  if (konan::consoleReadUtf8(data, sizeof(data)) < 0) {
+  LineReader reader = { OBJ_RESULT };
+  // A line that fits into the input buffer is decoded right from it.
+  auto consume = [](const char* utf8, uint32_t sizeBytes, bool last, void* context) {
+    auto* reader = static_cast<LineReader*>(context);
+    if (!last) {
+      reader->chunks.append(utf8, sizeBytes);
+    } else if (reader->chunks.empty()) {
+      reader->create(utf8, sizeBytes);
+    } else {
+      reader->chunks.append(utf8, sizeBytes);
+      reader->create(reader->chunks.data(), reader->chunks.size());
+    }
+  };
+  if (!konan::consoleReadLineUtf8(consume, &reader)) {
     RETURN_OBJ(nullptr);
   }
-  RETURN_RESULT_OF(CreateStringFromCString, data);
+  // The input has ended in the middle of a line.
+  if (reader.line == nullptr) reader.create(reader.chunks.data(), reader.chunks.size());
+  return reader.line;
 }
 
 } // extern "C"
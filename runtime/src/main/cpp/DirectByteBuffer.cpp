@@ -0,0 +1,245 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+#include "Alloc.h"
+#include "ByteOrder.hpp"
+#include "Exceptions.h"
+#include "Memory.h"
+#include "Natives.h"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+// Owns the buffer memory outside of the Kotlin heap, so that the cleaner of a buffer that was never freed can release it.
+struct Storage {
+    void* address = nullptr;
+    std::atomic<bool> released = false;
+};
+
+// Must match the fields of DirectByteBuffer in DirectByteBuffer.kt.
+struct DirectByteBuffer {
+    ObjHeader header;
+    void* address;
+    KLong capacity;
+    KBoolean bigEndian;
+    KBoolean freed;
+    Storage* storage;
+};
+
+// Enough for any SIMD load of the platform.
+constexpr size_t kBufferAlignment = 16;
+
+DirectByteBuffer* asBuffer(KRef thiz) {
+    return reinterpret_cast<DirectByteBuffer*>(thiz);
+}
+
+uint8_t* addressAt(DirectByteBuffer* buffer, KLong index, KLong width) {
+    if (buffer->freed) ThrowIllegalStateException();
+    if (index < 0 || width < 0 || index > buffer->capacity - width) ThrowArrayIndexOutOfBoundsException();
+    return static_cast<uint8_t*>(buffer->address) + index;
+}
+
+bool needsSwap(DirectByteBuffer* buffer) {
+    return (buffer->bigEndian != 0) == kIsLittleEndian;
+}
+
+template <typename T>
+T getAt(KRef thiz, KLong index) {
+    auto* buffer = asBuffer(thiz);
+    T value = LoadUnaligned<T>(addressAt(buffer, index, sizeof(T)));
+    return needsSwap(buffer) ? ByteSwap(value) : value;
+}
+
+template <typename T>
+void setAt(KRef thiz, KLong index, T value) {
+    auto* buffer = asBuffer(thiz);
+    StoreUnaligned(addressAt(buffer, index, sizeof(T)), needsSwap(buffer) ? ByteSwap(value) : value);
+}
+
+template <typename T>
+T* arrayRange(KRef array, KInt offset, KInt length) {
+    ArrayHeader* header = array->array();
+    if (offset < 0 || length < 0 || static_cast<uint32_t>(offset) + static_cast<uint32_t>(length) > header->count_) {
+        ThrowArrayIndexOutOfBoundsException();
+    }
+    return AddressOfElementAt<T>(header, offset);
+}
+
+template <typename T>
+void getBulk(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    auto* buffer = asBuffer(thiz);
+    T* target = arrayRange<T>(destination, destinationOffset, length);
+    const uint8_t* source = addressAt(buffer, index, static_cast<KLong>(length) * sizeof(T));
+    if (length == 0) return;
+    MutationCheck(destination);
+    if (sizeof(T) == 1 || !needsSwap(buffer)) {
+        memcpy(target, source, length * sizeof(T));
+        return;
+    }
+    for (KInt i = 0; i < length; ++i) {
+        target[i] = ByteSwap(LoadUnaligned<T>(source + i * sizeof(T)));
+    }
+}
+
+template <typename T>
+void putBulk(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    auto* buffer = asBuffer(thiz);
+    const T* from = arrayRange<T>(source, sourceOffset, length);
+    uint8_t* target = addressAt(buffer, index, static_cast<KLong>(length) * sizeof(T));
+    if (sizeof(T) == 1 || !needsSwap(buffer)) {
+        memcpy(target, from, length * sizeof(T));
+        return;
+    }
+    for (KInt i = 0; i < length; ++i) {
+        StoreUnaligned(target + i * sizeof(T), ByteSwap(from[i]));
+    }
+}
+
+// Both free() and the cleaner may get here, only the first one releases the memory.
+void releaseStorage(Storage* storage) {
+    if (!storage->released.exchange(true)) konanFreeMemory(storage->address);
+}
+
+} // namespace
+
+extern "C" {
+
+void Kotlin_DirectByteBuffer_allocateImpl(KRef thiz, KLong capacity) {
+    auto* buffer = asBuffer(thiz);
+    if (static_cast<uint64_t>(capacity) > SIZE_MAX - kBufferAlignment) ThrowOutOfMemoryError();
+    // Allocate at least one byte so that even an empty buffer has a valid address.
+    void* address = konanAllocAlignedMemory(capacity > 0 ? capacity : 1, kBufferAlignment);
+    if (address == nullptr) ThrowOutOfMemoryError();
+    auto* storage = konanConstructInstance<Storage>();
+    storage->address = address;
+    buffer->address = address;
+    buffer->capacity = capacity;
+    buffer->storage = storage;
+}
+
+void Kotlin_DirectByteBuffer_free(KRef thiz) {
+    // A frozen buffer may be read from several threads, so none of them may free it.
+    MutationCheck(thiz);
+    auto* buffer = asBuffer(thiz);
+    if (buffer->freed) return;
+    // The storage record itself is disposed by the cleaner.
+    releaseStorage(buffer->storage);
+    buffer->address = nullptr;
+    buffer->capacity = 0;
+    buffer->freed = true;
+}
+
+void Kotlin_DirectByteBuffer_disposeStorage(KNativePtr storage) {
+    releaseStorage(static_cast<Storage*>(storage));
+    konanDestructInstance(static_cast<Storage*>(storage));
+}
+
+KNativePtr Kotlin_DirectByteBuffer_asCPointerImpl(KRef thiz, KLong offset) {
+    return addressAt(asBuffer(thiz), offset, 0);
+}
+
+KByte Kotlin_DirectByteBuffer_get(KRef thiz, KLong index) {
+    return getAt<KByte>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_set(KRef thiz, KLong index, KByte value) {
+    setAt<KByte>(thiz, index, value);
+}
+
+KShort Kotlin_DirectByteBuffer_getShortAt(KRef thiz, KLong index) {
+    return getAt<KShort>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_setShortAt(KRef thiz, KLong index, KShort value) {
+    setAt<KShort>(thiz, index, value);
+}
+
+KInt Kotlin_DirectByteBuffer_getIntAt(KRef thiz, KLong index) {
+    return getAt<KInt>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_setIntAt(KRef thiz, KLong index, KInt value) {
+    setAt<KInt>(thiz, index, value);
+}
+
+KLong Kotlin_DirectByteBuffer_getLongAt(KRef thiz, KLong index) {
+    return getAt<KLong>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_setLongAt(KRef thiz, KLong index, KLong value) {
+    setAt<KLong>(thiz, index, value);
+}
+
+KFloat Kotlin_DirectByteBuffer_getFloatAt(KRef thiz, KLong index) {
+    return getAt<KFloat>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_setFloatAt(KRef thiz, KLong index, KFloat value) {
+    setAt<KFloat>(thiz, index, value);
+}
+
+KDouble Kotlin_DirectByteBuffer_getDoubleAt(KRef thiz, KLong index) {
+    return getAt<KDouble>(thiz, index);
+}
+
+void Kotlin_DirectByteBuffer_setDoubleAt(KRef thiz, KLong index, KDouble value) {
+    setAt<KDouble>(thiz, index, value);
+}
+
+void Kotlin_DirectByteBuffer_getBytes(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KByte>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putBytes(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KByte>(thiz, index, source, sourceOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_getShorts(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KShort>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putShorts(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KShort>(thiz, index, source, sourceOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_getInts(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KInt>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putInts(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KInt>(thiz, index, source, sourceOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_getLongs(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KLong>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putLongs(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KLong>(thiz, index, source, sourceOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_getFloats(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KFloat>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putFloats(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KFloat>(thiz, index, source, sourceOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_getDoubles(KRef thiz, KLong index, KRef destination, KInt destinationOffset, KInt length) {
+    getBulk<KDouble>(thiz, index, destination, destinationOffset, length);
+}
+
+void Kotlin_DirectByteBuffer_putDoubles(KRef thiz, KLong index, KRef source, KInt sourceOffset, KInt length) {
+    putBulk<KDouble>(thiz, index, source, sourceOffset, length);
+}
+
+} // extern "C"
@@ -0,0 +1,531 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "DwarfLineTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ByteOrder.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+// Standard opcodes.
+constexpr uint8_t DW_LNS_copy = 0x01;
+constexpr uint8_t DW_LNS_advance_pc = 0x02;
+constexpr uint8_t DW_LNS_advance_line = 0x03;
+constexpr uint8_t DW_LNS_set_file = 0x04;
+constexpr uint8_t DW_LNS_set_column = 0x05;
+constexpr uint8_t DW_LNS_negate_stmt = 0x06;
+constexpr uint8_t DW_LNS_set_basic_block = 0x07;
+constexpr uint8_t DW_LNS_const_add_pc = 0x08;
+constexpr uint8_t DW_LNS_fixed_advance_pc = 0x09;
+
+// Extended opcodes.
+constexpr uint8_t DW_LNE_end_sequence = 0x01;
+constexpr uint8_t DW_LNE_set_address = 0x02;
+constexpr uint8_t DW_LNE_define_file = 0x03;
+
+// Entry formats of DWARF 5 directory and file tables.
+constexpr uint64_t DW_LNCT_path = 0x1;
+constexpr uint64_t DW_LNCT_directory_index = 0x2;
+
+constexpr uint64_t DW_FORM_block2 = 0x03;
+constexpr uint64_t DW_FORM_block4 = 0x04;
+constexpr uint64_t DW_FORM_data2 = 0x05;
+constexpr uint64_t DW_FORM_data4 = 0x06;
+constexpr uint64_t DW_FORM_data8 = 0x07;
+constexpr uint64_t DW_FORM_string = 0x08;
+constexpr uint64_t DW_FORM_block = 0x09;
+constexpr uint64_t DW_FORM_block1 = 0x0a;
+constexpr uint64_t DW_FORM_data1 = 0x0b;
+constexpr uint64_t DW_FORM_strp = 0x0e;
+constexpr uint64_t DW_FORM_udata = 0x0f;
+constexpr uint64_t DW_FORM_strx = 0x1a;
+constexpr uint64_t DW_FORM_data16 = 0x1e;
+constexpr uint64_t DW_FORM_line_strp = 0x1f;
+constexpr uint64_t DW_FORM_strx1 = 0x25;
+constexpr uint64_t DW_FORM_strx2 = 0x26;
+constexpr uint64_t DW_FORM_strx3 = 0x27;
+constexpr uint64_t DW_FORM_strx4 = 0x28;
+
+// Bounds checked reader of section data. Reading past the end yields zeroes and marks the reader as failed,
+// so decoders check `ok()` once per entry instead of after every field.
+class Reader {
+public:
+    Reader(const uint8_t* begin, const uint8_t* end) noexcept : current_(begin), end_(end) {}
+
+    bool ok() const noexcept { return ok_; }
+    bool atEnd() const noexcept { return current_ >= end_; }
+    const uint8_t* position() const noexcept { return current_; }
+    size_t remaining() const noexcept { return end_ - current_; }
+
+    template <typename T>
+    T read() noexcept {
+        if (!has(sizeof(T))) return 0;
+        T value = LoadUnaligned<T>(current_);
+        current_ += sizeof(T);
+        return value;
+    }
+
+    uint64_t readOffset(bool dwarf64) noexcept { return dwarf64 ? read<uint64_t>() : read<uint32_t>(); }
+
+    uint64_t readAddress(size_t size) noexcept {
+        switch (size) {
+            case 4:
+                return read<uint32_t>();
+            case 8:
+                return read<uint64_t>();
+            default:
+                skip(size);
+                return 0;
+        }
+    }
+
+    uint64_t readUleb128() noexcept {
+        uint64_t result = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (!has(1)) return 0;
+            uint8_t byte = *current_++;
+            if (shift < 64) result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return result;
+        }
+    }
+
+    int64_t readSleb128() noexcept {
+        uint64_t result = 0;
+        unsigned shift = 0;
+        uint8_t byte = 0;
+        do {
+            if (!has(1)) return 0;
+            byte = *current_++;
+            if (shift < 64) result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40)) result |= ~static_cast<uint64_t>(0) << shift;
+        return static_cast<int64_t>(result);
+    }
+
+    const char* readString() noexcept {
+        const void* terminator = ok_ ? memchr(current_, 0, remaining()) : nullptr;
+        if (terminator == nullptr) {
+            fail();
+            return "";
+        }
+        const char* result = reinterpret_cast<const char*>(current_);
+        current_ = static_cast<const uint8_t*>(terminator) + 1;
+        return result;
+    }
+
+    void skip(size_t size) noexcept {
+        if (has(size)) current_ += size;
+    }
+
+    void fail() noexcept {
+        ok_ = false;
+        current_ = end_;
+    }
+
+private:
+    bool has(size_t size) noexcept {
+        if (ok_ && remaining() >= size) return true;
+        fail();
+        return false;
+    }
+
+    const uint8_t* current_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+// Zero-terminated string at `offset` of a string section, or null.
+const char* sectionString(const uint8_t* section, size_t size, uint64_t offset) noexcept {
+    if (section == nullptr || offset >= size) return nullptr;
+    if (memchr(section + offset, 0, size - offset) == nullptr) return nullptr;
+    return reinterpret_cast<const char*>(section + offset);
+}
+
+} // namespace
+
+// Decodes a single unit of `.debug_line`, appending its rows and files to the table.
+class DwarfLineTable::UnitDecoder : private Pinned {
+public:
+    UnitDecoder(DwarfLineTable& table, const Sections& sections, KStdOrderedMap<KStdString, uint32_t>& fileIds) noexcept :
+        table_(table), sections_(sections), fileIds_(fileIds) {}
+
+    bool decode(Reader& unit, bool dwarf64) noexcept {
+        dwarf64_ = dwarf64;
+        version_ = unit.read<uint16_t>();
+        if (version_ < 2 || version_ > 5) return false;
+        if (version_ >= 5) {
+            // DW_LNE_set_address carries its own size, so address_size and segment_selector_size are not needed.
+            unit.read<uint8_t>();
+            unit.read<uint8_t>();
+        }
+        uint64_t headerLength = unit.readOffset(dwarf64);
+        if (!unit.ok() || headerLength > unit.remaining()) return false;
+        const uint8_t* programStart = unit.position() + headerLength;
+
+        minimumInstructionLength_ = unit.read<uint8_t>();
+        if (version_ >= 4) unit.read<uint8_t>(); // maximum_operations_per_instruction, only matters for VLIW.
+        unit.read<uint8_t>(); // default_is_stmt
+        lineBase_ = static_cast<int8_t>(unit.read<uint8_t>());
+        lineRange_ = unit.read<uint8_t>();
+        opcodeBase_ = unit.read<uint8_t>();
+        if (!unit.ok() || lineRange_ == 0 || opcodeBase_ == 0) return false;
+        standardOpcodeLengths_ = unit.position();
+        unit.skip(opcodeBase_ - 1);
+
+        bool filesDecoded = version_ >= 5 ? decodeFilesV5(unit) : decodeFilesV2(unit);
+        if (!filesDecoded || !unit.ok() || programStart > unit.position() + unit.remaining()) return false;
+
+        Reader program(programStart, unit.position() + unit.remaining());
+        return decodeProgram(program);
+    }
+
+private:
+    bool decodeFilesV2(Reader& unit) noexcept {
+        // Directory 0 is the compilation directory, which is only known from `.debug_info`.
+        directories_.push_back("");
+        while (true) {
+            const char* directory = unit.readString();
+            if (!unit.ok()) return false;
+            if (*directory == '\0') break;
+            directories_.push_back(directory);
+        }
+        // File numbers start from 1.
+        files_.push_back(kNoFile);
+        while (true) {
+            const char* name = unit.readString();
+            if (!unit.ok()) return false;
+            if (*name == '\0') break;
+            decodeFileV2Attributes(unit, name);
+        }
+        return unit.ok();
+    }
+
+    void decodeFileV2Attributes(Reader& reader, const char* name) noexcept {
+        uint64_t directory = reader.readUleb128();
+        reader.readUleb128(); // Modification time.
+        reader.readUleb128(); // Length.
+        files_.push_back(internFile(directory, name));
+    }
+
+    struct EntryFormat {
+        uint64_t contentType;
+        uint64_t form;
+    };
+
+    bool decodeEntryFormats(Reader& unit, KStdVector<EntryFormat>& formats) noexcept {
+        uint8_t count = unit.read<uint8_t>();
+        for (uint8_t i = 0; i < count; ++i) {
+            uint64_t contentType = unit.readUleb128();
+            uint64_t form = unit.readUleb128();
+            formats.push_back({contentType, form});
+        }
+        return unit.ok();
+    }
+
+    // Reads an attribute value: a string for string forms, a number for constant forms.
+    bool decodeForm(Reader& unit, uint64_t form, const char** string, uint64_t* number) noexcept {
+        *string = nullptr;
+        *number = 0;
+        switch (form) {
+            case DW_FORM_string:
+                *string = unit.readString();
+                break;
+            case DW_FORM_line_strp:
+                *string = sectionString(sections_.debugLineStr, sections_.debugLineStrSize, unit.readOffset(dwarf64_));
+                break;
+            case DW_FORM_strp:
+                *string = sectionString(sections_.debugStr, sections_.debugStrSize, unit.readOffset(dwarf64_));
+                break;
+            // String indices need `.debug_str_offsets` and the unit's base from `.debug_info`: treat them as unknown.
+            case DW_FORM_strx:
+                unit.readUleb128();
+                break;
+            case DW_FORM_strx1:
+                unit.skip(1);
+                break;
+            case DW_FORM_strx2:
+                unit.skip(2);
+                break;
+            case DW_FORM_strx3:
+                unit.skip(3);
+                break;
+            case DW_FORM_strx4:
+                unit.skip(4);
+                break;
+            case DW_FORM_udata:
+                *number = unit.readUleb128();
+                break;
+            case DW_FORM_data1:
+                *number = unit.read<uint8_t>();
+                break;
+            case DW_FORM_data2:
+                *number = unit.read<uint16_t>();
+                break;
+            case DW_FORM_data4:
+                *number = unit.read<uint32_t>();
+                break;
+            case DW_FORM_data8:
+                *number = unit.read<uint64_t>();
+                break;
+            case DW_FORM_data16:
+                unit.skip(16);
+                break;
+            case DW_FORM_block:
+                unit.skip(unit.readUleb128());
+                break;
+            case DW_FORM_block1:
+                unit.skip(unit.read<uint8_t>());
+                break;
+            case DW_FORM_block2:
+                unit.skip(unit.read<uint16_t>());
+                break;
+            case DW_FORM_block4:
+                unit.skip(unit.read<uint32_t>());
+                break;
+            default:
+                // The size of an unknown form is unknown too, the rest of the unit cannot be decoded.
+                return false;
+        }
+        return unit.ok();
+    }
+
+    bool decodeFilesV5(Reader& unit) noexcept {
+        KStdVector<EntryFormat> formats;
+        if (!decodeEntryFormats(unit, formats)) return false;
+        uint64_t count = unit.readUleb128();
+        for (uint64_t i = 0; i < count && unit.ok(); ++i) {
+            const char* path = "";
+            for (auto& format : formats) {
+                const char* string;
+                uint64_t number;
+                if (!decodeForm(unit, format.form, &string, &number)) return false;
+                if (format.contentType == DW_LNCT_path && string != nullptr) path = string;
+            }
+            directories_.push_back(path);
+        }
+
+        formats.clear();
+        if (!decodeEntryFormats(unit, formats)) return false;
+        count = unit.readUleb128();
+        // File numbers start from 0.
+        for (uint64_t i = 0; i < count && unit.ok(); ++i) {
+            const char* path = nullptr;
+            uint64_t directory = 0;
+            for (auto& format : formats) {
+                const char* string;
+                uint64_t number;
+                if (!decodeForm(unit, format.form, &string, &number)) return false;
+                if (format.contentType == DW_LNCT_path) path = string;
+                if (format.contentType == DW_LNCT_directory_index) directory = number;
+            }
+            files_.push_back(path != nullptr ? internFile(directory, path) : kNoFile);
+        }
+        return unit.ok();
+    }
+
+    uint32_t internFile(uint64_t directory, const char* name) noexcept {
+        KStdString path;
+        if (name[0] != '/' && directory < directories_.size()) {
+            const char* directoryPath = directories_[directory];
+            // Since DWARF 5 directory 0 is the compilation directory, which other relative directories are based on.
+            if (directoryPath[0] != '/' && directory != 0 && version_ >= 5 && directories_[0][0] != '\0') {
+                path = directories_[0];
+                path += '/';
+            }
+            if (directoryPath[0] != '\0') {
+                path += directoryPath;
+                path += '/';
+            }
+        }
+        path += name;
+        auto it = fileIds_.find(path);
+        if (it != fileIds_.end()) return it->second;
+        uint32_t id = table_.fileNameOffsets_.size();
+        table_.fileNameOffsets_.push_back(table_.fileNames_.size());
+        table_.fileNames_.insert(table_.fileNames_.end(), path.c_str(), path.c_str() + path.size() + 1);
+        fileIds_.emplace(std::move(path), id);
+        return id;
+    }
+
+    uint32_t fileId(uint64_t file) const noexcept { return file < files_.size() ? files_[file] : kNoFile; }
+
+    bool decodeProgram(Reader& program) noexcept {
+        resetState();
+        size_t sequenceStart = table_.rows_.size();
+        while (!program.atEnd()) {
+            uint8_t opcode = program.read<uint8_t>();
+            if (opcode >= opcodeBase_) {
+                uint8_t adjusted = opcode - opcodeBase_;
+                address_ += static_cast<uint64_t>(adjusted / lineRange_) * minimumInstructionLength_;
+                line_ += lineBase_ + adjusted % lineRange_;
+                emitRow();
+                continue;
+            }
+            switch (opcode) {
+                case 0: {
+                    uint64_t length = program.readUleb128();
+                    if (length == 0 || length > program.remaining()) return false;
+                    Reader instruction(program.position(), program.position() + length);
+                    program.skip(length);
+                    switch (instruction.read<uint8_t>()) {
+                        case DW_LNE_end_sequence:
+                            // Rows at the end address cover nothing.
+                            while (table_.rows_.size() > sequenceStart && table_.rows_.back().address >= address_) {
+                                table_.rows_.pop_back();
+                            }
+                            // Linkers point sequences of discarded functions to address 0, they would shadow real code.
+                            if (table_.rows_.size() > sequenceStart && table_.rows_[sequenceStart].address != 0) {
+                                table_.rows_.push_back({address_, kNoFile, 0, 0, true});
+                            } else {
+                                table_.rows_.resize(sequenceStart);
+                            }
+                            sequenceStart = table_.rows_.size();
+                            resetState();
+                            break;
+                        case DW_LNE_set_address:
+                            address_ = instruction.readAddress(length - 1);
+                            break;
+                        case DW_LNE_define_file: {
+                            const char* name = instruction.readString();
+                            if (instruction.ok()) decodeFileV2Attributes(instruction, name);
+                            break;
+                        }
+                        default:
+                            // DW_LNE_set_discriminator and vendor extensions.
+                            break;
+                    }
+                    break;
+                }
+                case DW_LNS_copy:
+                    emitRow();
+                    break;
+                case DW_LNS_advance_pc:
+                    address_ += program.readUleb128() * minimumInstructionLength_;
+                    break;
+                case DW_LNS_advance_line:
+                    line_ += program.readSleb128();
+                    break;
+                case DW_LNS_set_file:
+                    file_ = program.readUleb128();
+                    break;
+                case DW_LNS_set_column:
+                    column_ = program.readUleb128();
+                    break;
+                case DW_LNS_negate_stmt:
+                case DW_LNS_set_basic_block:
+                    break;
+                case DW_LNS_const_add_pc:
+                    address_ += static_cast<uint64_t>((255 - opcodeBase_) / lineRange_) * minimumInstructionLength_;
+                    break;
+                case DW_LNS_fixed_advance_pc:
+                    address_ += program.read<uint16_t>();
+                    break;
+                default:
+                    // Opcodes from newer versions or vendors: skip their ULEB128 operands.
+                    for (uint8_t i = 0; i < standardOpcodeLengths_[opcode - 1]; ++i) {
+                        program.readUleb128();
+                    }
+                    break;
+            }
+            if (!program.ok()) break;
+        }
+        // Rows of a sequence without the end marker cannot be bounded.
+        table_.rows_.resize(sequenceStart);
+        return program.ok();
+    }
+
+    void resetState() noexcept {
+        address_ = 0;
+        file_ = 1;
+        line_ = 1;
+        column_ = 0;
+    }
+
+    void emitRow() noexcept {
+        uint32_t line = line_ > 0 && line_ <= INT32_MAX ? static_cast<uint32_t>(line_) : 0;
+        uint32_t column = column_ <= INT32_MAX ? static_cast<uint32_t>(column_) : 0;
+        table_.rows_.push_back({address_, fileId(file_), line, column, false});
+    }
+
+    DwarfLineTable& table_;
+    const Sections& sections_;
+    KStdOrderedMap<KStdString, uint32_t>& fileIds_;
+
+    bool dwarf64_ = false;
+    uint16_t version_ = 0;
+    uint8_t minimumInstructionLength_ = 1;
+    int8_t lineBase_ = 0;
+    uint8_t lineRange_ = 1;
+    uint8_t opcodeBase_ = 1;
+    const uint8_t* standardOpcodeLengths_ = nullptr;
+    KStdVector<const char*> directories_;
+    // Unit file numbers to table file ids.
+    KStdVector<uint32_t> files_;
+
+    uint64_t address_ = 0;
+    uint64_t file_ = 1;
+    int64_t line_ = 1;
+    uint64_t column_ = 0;
+};
+
+DwarfLineTable::DwarfLineTable(const Sections& sections) noexcept {
+    KStdOrderedMap<KStdString, uint32_t> fileIds;
+    Reader section(sections.debugLine, sections.debugLine + sections.debugLineSize);
+    while (!section.atEnd()) {
+        bool dwarf64 = false;
+        uint64_t length = section.read<uint32_t>();
+        if (length == 0xffffffff) {
+            dwarf64 = true;
+            length = section.read<uint64_t>();
+        } else if (length >= 0xfffffff0) {
+            // Reserved values.
+            break;
+        }
+        if (!section.ok() || length > section.remaining()) break;
+        Reader unit(section.position(), section.position() + length);
+        section.skip(length);
+
+        size_t rowCount = rows_.size();
+        UnitDecoder decoder(*this, sections, fileIds);
+        if (!decoder.decode(unit, dwarf64)) {
+            // Keep whatever the broken unit added to the file names, but none of its rows.
+            rows_.resize(rowCount);
+        }
+    }
+
+    // Several sequences may start where another one ends: put end markers first, so that the start wins.
+    std::stable_sort(rows_.begin(), rows_.end(), [](const Row& lhs, const Row& rhs) {
+        if (lhs.address != rhs.address) return lhs.address < rhs.address;
+        return lhs.endSequence && !rhs.endSequence;
+    });
+    rows_.shrink_to_fit();
+    fileNames_.shrink_to_fit();
+    fileNameOffsets_.shrink_to_fit();
+}
+
+bool DwarfLineTable::Find(uint64_t address, Location* result) const noexcept {
+    // The last row at or before the address.
+    auto it = std::upper_bound(rows_.begin(), rows_.end(), address, [](uint64_t value, const Row& row) {
+        return value < row.address;
+    });
+    if (it == rows_.begin()) return false;
+    --it;
+    if (it->endSequence) return false;
+    result->fileName = fileName(it->file);
+    result->line = it->line;
+    result->column = it->column;
+    return true;
+}
+
+const char* DwarfLineTable::fileName(uint32_t file) const noexcept {
+    if (file >= fileNameOffsets_.size()) return nullptr;
+    return fileNames_.data() + fileNameOffsets_[file];
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_DWARF_LINE_TABLE_H
+#define RUNTIME_DWARF_LINE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Address to source line mapping decoded from the line number programs of a DWARF `.debug_line` section,
+// versions 2 to 5. Section data is expected in the native byte order.
+class DwarfLineTable : private MoveOnly {
+public:
+    struct Sections {
+        const uint8_t* debugLine = nullptr;
+        size_t debugLineSize = 0;
+        // Strings referenced with DW_FORM_line_strp from DWARF 5 file tables.
+        const uint8_t* debugLineStr = nullptr;
+        size_t debugLineStrSize = 0;
+        // Strings referenced with DW_FORM_strp.
+        const uint8_t* debugStr = nullptr;
+        size_t debugStrSize = 0;
+    };
+
+    struct Location {
+        const char* fileName;
+        int32_t line;
+        int32_t column;
+    };
+
+    DwarfLineTable() noexcept = default;
+
+    // Decodes all units of `sections`, skipping the ones that are malformed or use unsupported forms.
+    // Everything needed for lookups is copied, so the sections may be unmapped afterwards.
+    explicit DwarfLineTable(const Sections& sections) noexcept;
+
+    DwarfLineTable(DwarfLineTable&&) noexcept = default;
+    DwarfLineTable& operator=(DwarfLineTable&&) noexcept = default;
+
+    // Finds the row covering link time `address`. `fileName` stays valid for the lifetime of the table,
+    // and is null when the unit refers to a file it does not declare.
+    bool Find(uint64_t address, Location* result) const noexcept;
+
+    size_t size() const noexcept { return rows_.size(); }
+
+private:
+    class UnitDecoder;
+
+    struct Row {
+        uint64_t address;
+        uint32_t file;
+        uint32_t line;
+        uint32_t column;
+        // Marks the first address after a sequence, not covered by any row of it.
+        bool endSequence;
+    };
+
+    static constexpr uint32_t kNoFile = UINT32_MAX;
+
+    const char* fileName(uint32_t file) const noexcept;
+
+    KStdVector<Row> rows_;
+    // Zero-terminated file names, indexed by `fileNameOffsets_`.
+    KStdVector<char> fileNames_;
+    KStdVector<uint32_t> fileNameOffsets_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_DWARF_LINE_TABLE_H
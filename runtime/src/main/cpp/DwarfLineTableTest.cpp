@@ -0,0 +1,244 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "DwarfLineTable.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace kotlin;
+
+namespace {
+
+constexpr int kLineBase = -5;
+constexpr uint8_t kLineRange = 14;
+constexpr uint8_t kOpcodeBase = 13;
+
+class SectionBuilder {
+public:
+    template <typename T>
+    SectionBuilder& value(T value) {
+        uint8_t bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+        return *this;
+    }
+
+    SectionBuilder& u8(uint8_t byte) { return value(byte); }
+
+    SectionBuilder& uleb(uint64_t value) {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            data_.push_back(value != 0 ? byte | 0x80 : byte);
+        } while (value != 0);
+        return *this;
+    }
+
+    SectionBuilder& sleb(int64_t value) {
+        bool more = true;
+        while (more) {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            more = !((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0));
+            data_.push_back(more ? byte | 0x80 : byte);
+        }
+        return *this;
+    }
+
+    SectionBuilder& string(const char* string) {
+        data_.insert(data_.end(), string, string + strlen(string) + 1);
+        return *this;
+    }
+
+    SectionBuilder& append(const std::vector<uint8_t>& bytes) {
+        data_.insert(data_.end(), bytes.begin(), bytes.end());
+        return *this;
+    }
+
+    // Line program instructions.
+    SectionBuilder& setAddress(uint64_t address) { return u8(0).uleb(9).u8(0x02).value(address); }
+    SectionBuilder& endSequence() { return u8(0).uleb(1).u8(0x01); }
+    SectionBuilder& advancePc(uint64_t delta) { return u8(0x02).uleb(delta); }
+    SectionBuilder& advanceLine(int64_t delta) { return u8(0x03).sleb(delta); }
+    SectionBuilder& setFile(uint64_t file) { return u8(0x04).uleb(file); }
+    SectionBuilder& setColumn(uint64_t column) { return u8(0x05).uleb(column); }
+    SectionBuilder& copy() { return u8(0x01); }
+
+    // Advances the address and the line and appends a row with a single special opcode.
+    SectionBuilder& special(uint8_t addressDelta, int lineDelta) {
+        return u8(kOpcodeBase + (lineDelta - kLineBase) + kLineRange * addressDelta);
+    }
+
+    const std::vector<uint8_t>& data() const { return data_; }
+    size_t size() const { return data_.size(); }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+void appendHeaderFields(SectionBuilder& header) {
+    header.u8(1) // minimum_instruction_length
+            .u8(1) // maximum_operations_per_instruction
+            .u8(1) // default_is_stmt
+            .value<int8_t>(kLineBase)
+            .u8(kLineRange)
+            .u8(kOpcodeBase)
+            .append({0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1});
+}
+
+std::vector<uint8_t> unitV4(const SectionBuilder& program) {
+    SectionBuilder header;
+    appendHeaderFields(header);
+    header.string("/src").string("lib").string("");
+    header.string("main.kt").uleb(1).uleb(0).uleb(0);
+    header.string("util.kt").uleb(2).uleb(0).uleb(0);
+    header.string("/abs/other.kt").uleb(0).uleb(0).uleb(0);
+    header.u8(0);
+
+    SectionBuilder unit;
+    unit.value<uint16_t>(4).value<uint32_t>(header.size()).append(header.data()).append(program.data());
+    SectionBuilder result;
+    result.value<uint32_t>(unit.size()).append(unit.data());
+    return result.data();
+}
+
+std::vector<uint8_t> unitV5(const SectionBuilder& program) {
+    constexpr uint64_t DW_LNCT_path = 1;
+    constexpr uint64_t DW_LNCT_directory_index = 2;
+    constexpr uint64_t DW_LNCT_MD5 = 5;
+    constexpr uint64_t DW_FORM_string = 0x08;
+    constexpr uint64_t DW_FORM_line_strp = 0x1f;
+    constexpr uint64_t DW_FORM_udata = 0x0f;
+    constexpr uint64_t DW_FORM_data16 = 0x1e;
+
+    SectionBuilder header;
+    appendHeaderFields(header);
+    // Directories: "/build" from .debug_line_str at offset 0, and relative "gen".
+    header.u8(1).uleb(DW_LNCT_path).uleb(DW_FORM_line_strp);
+    header.uleb(2).value<uint32_t>(0).value<uint32_t>(7);
+    // Files with a path, a directory and an MD5 checksum.
+    header.u8(3).uleb(DW_LNCT_path).uleb(DW_FORM_string).uleb(DW_LNCT_directory_index).uleb(DW_FORM_udata).uleb(DW_LNCT_MD5).uleb(
+            DW_FORM_data16);
+    header.uleb(2);
+    header.string("a.kt").uleb(0).append(std::vector<uint8_t>(16, 0xab));
+    header.string("b.kt").uleb(1).append(std::vector<uint8_t>(16, 0xcd));
+
+    SectionBuilder unit;
+    unit.value<uint16_t>(5).u8(8).u8(0).value<uint32_t>(header.size()).append(header.data()).append(program.data());
+    SectionBuilder result;
+    result.value<uint32_t>(unit.size()).append(unit.data());
+    return result.data();
+}
+
+DwarfLineTable::Location find(const DwarfLineTable& table, uint64_t address) {
+    DwarfLineTable::Location location = {nullptr, -1, -1};
+    EXPECT_TRUE(table.Find(address, &location)) << "address " << address;
+    return location;
+}
+
+} // namespace
+
+TEST(DwarfLineTableTest, Empty) {
+    DwarfLineTable table(DwarfLineTable::Sections{});
+    DwarfLineTable::Location location;
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_FALSE(table.Find(0x1000, &location));
+}
+
+TEST(DwarfLineTableTest, Version4) {
+    SectionBuilder program;
+    program.setAddress(0x1000).advanceLine(9).setColumn(5).copy(); // 0x1000 main.kt:10:5
+    program.special(4, 2); // 0x1004 main.kt:12:5
+    program.setFile(2).setColumn(1).advanceLine(-7).special(8, 0); // 0x100c lib/util.kt:5:1
+    program.setFile(3).advancePc(0x10).copy(); // 0x101c /abs/other.kt:5:1
+    program.advancePc(4).endSequence(); // 0x1020
+    // A sequence of a discarded function.
+    program.setAddress(0).advanceLine(99).copy().advancePc(0x2000).endSequence();
+    program.setAddress(0x3000).setFile(1).copy().advancePc(2).endSequence();
+
+    auto debugLine = unitV4(program);
+    DwarfLineTable::Sections sections;
+    sections.debugLine = debugLine.data();
+    sections.debugLineSize = debugLine.size();
+    DwarfLineTable table(sections);
+
+    DwarfLineTable::Location location;
+    EXPECT_FALSE(table.Find(0xfff, &location));
+    location = find(table, 0x1000);
+    EXPECT_STREQ(location.fileName, "/src/main.kt");
+    EXPECT_EQ(location.line, 10);
+    EXPECT_EQ(location.column, 5);
+    location = find(table, 0x1007);
+    EXPECT_STREQ(location.fileName, "/src/main.kt");
+    EXPECT_EQ(location.line, 12);
+    location = find(table, 0x100c);
+    EXPECT_STREQ(location.fileName, "lib/util.kt");
+    EXPECT_EQ(location.line, 5);
+    EXPECT_EQ(location.column, 1);
+    location = find(table, 0x101f);
+    EXPECT_STREQ(location.fileName, "/abs/other.kt");
+    EXPECT_FALSE(table.Find(0x1020, &location));
+    EXPECT_FALSE(table.Find(0x1500, &location));
+    EXPECT_FALSE(table.Find(0x2fff, &location));
+    location = find(table, 0x3001);
+    EXPECT_STREQ(location.fileName, "/src/main.kt");
+    EXPECT_EQ(location.line, 1);
+    EXPECT_FALSE(table.Find(0x3002, &location));
+}
+
+TEST(DwarfLineTableTest, Version5) {
+    const char debugLineStr[] = "/build\0gen";
+    SectionBuilder program;
+    program.setAddress(0x2000).setFile(0).advanceLine(2).copy(); // a.kt:3
+    program.setFile(1).special(0x10, 4); // 0x2010 b.kt:7
+    program.advancePc(0x10).endSequence();
+
+    auto debugLine = unitV5(program);
+    DwarfLineTable::Sections sections;
+    sections.debugLine = debugLine.data();
+    sections.debugLineSize = debugLine.size();
+    sections.debugLineStr = reinterpret_cast<const uint8_t*>(debugLineStr);
+    sections.debugLineStrSize = sizeof(debugLineStr);
+    DwarfLineTable table(sections);
+
+    auto location = find(table, 0x2004);
+    EXPECT_STREQ(location.fileName, "/build/a.kt");
+    EXPECT_EQ(location.line, 3);
+    location = find(table, 0x2010);
+    EXPECT_STREQ(location.fileName, "/build/gen/b.kt");
+    EXPECT_EQ(location.line, 7);
+}
+
+TEST(DwarfLineTableTest, MalformedUnitIsSkipped) {
+    SectionBuilder program;
+    program.setAddress(0x1000).copy().advancePc(4).endSequence();
+    auto valid = unitV4(program);
+
+    // Truncated in the middle of the program.
+    auto truncated = unitV4(SectionBuilder().setAddress(0x5000).copy().advancePc(4).endSequence());
+    truncated.resize(truncated.size() - 3);
+    uint32_t length = truncated.size() - sizeof(uint32_t);
+    memcpy(truncated.data(), &length, sizeof(length));
+
+    std::vector<uint8_t> debugLine = truncated;
+    debugLine.insert(debugLine.end(), valid.begin(), valid.end());
+    DwarfLineTable::Sections sections;
+    sections.debugLine = debugLine.data();
+    sections.debugLineSize = debugLine.size();
+    DwarfLineTable table(sections);
+
+    DwarfLineTable::Location location;
+    EXPECT_FALSE(table.Find(0x5000, &location));
+    location = find(table, 0x1002);
+    EXPECT_STREQ(location.fileName, "/src/main.kt");
+
+    // A section cut in the middle of a unit.
+    sections.debugLineSize = 10;
+    EXPECT_EQ(DwarfLineTable(sections).size(), 0u);
+}
@@ -18,7 +18,10 @@
 #include <string.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <exception>
+#include <limits>
+#include <pthread.h>
 #include <unistd.h>
 
 #if KONAN_NO_EXCEPTIONS
@@ -48,58 +51,126 @@
 
 namespace {
 
-#if USE_GCC_UNWIND
-struct Backtrace {
-  Backtrace(int count, int skip) : index(0), skipCount(skip) {
-    uint32_t size = count - skipCount;
-    if (size < 0) {
-      size = 0;
-    }
-    auto result = AllocArrayInstance(theNativePtrArrayTypeInfo, size, arrayHolder.slot());
-    // TODO: throw cached OOME?
-    RuntimeCheck(result != nullptr, "Cannot create backtrace array");
-  }
+// Frame pointer chains are only walked where the frame record layout is {previous frame, return address}
+// and the stack bounds of the current thread are cheap to obtain.
+#if !OMIT_BACKTRACE && ((KONAN_LINUX && !KONAN_ANDROID) || KONAN_OBJC_INTEROP) && (defined(__x86_64__) || defined(__aarch64__))
+#define FRAME_POINTER_BACKTRACE 1
+#else
+#define FRAME_POINTER_BACKTRACE 0
+#endif
 
-  void setNextElement(_Unwind_Ptr element) {
-    Kotlin_NativePtrArray_set(obj(), index++, (KNativePtr) element);
-  }
+// Captured frames beyond this many do not fit into the on-stack buffer and need a heap one.
+constexpr int kInlineStackTraceCapacity = 130;
 
-  ObjHeader* obj() { return arrayHolder.obj(); }
+// Unlimited unless set from Kotlin.
+KInt g_stackTraceDepth = std::numeric_limits<KInt>::max();
+KBoolean g_framePointerBacktrace = false;
 
-  int index;
+#if USE_GCC_UNWIND
+struct UnwindBuffer {
+  void** frames;
+  int capacity;
+  int size;
   int skipCount;
-  ObjHolder arrayHolder;
 };
 
-_Unwind_Reason_Code depthCountCallback(
-    struct _Unwind_Context * context, void* arg) {
-  int* result = reinterpret_cast<int*>(arg);
-  (*result)++;
-  return _URC_NO_REASON;
-}
-
 _Unwind_Reason_Code unwindCallback(
     struct _Unwind_Context* context, void* arg) {
-  Backtrace* backtrace = reinterpret_cast<Backtrace*>(arg);
-  if (backtrace->skipCount > 0) {
-    backtrace->skipCount--;
+  UnwindBuffer* buffer = reinterpret_cast<UnwindBuffer*>(arg);
+  if (buffer->skipCount > 0) {
+    buffer->skipCount--;
     return _URC_NO_REASON;
   }
+  if (buffer->size == buffer->capacity) return _URC_END_OF_STACK;
 
 #if (__MINGW32__ || __MINGW64__)
   _Unwind_Ptr address = _Unwind_GetRegionStart(context);
 #else
   _Unwind_Ptr address = _Unwind_GetIP(context);
 #endif
-  backtrace->setNextElement(address);
+  buffer->frames[buffer->size++] = reinterpret_cast<void*>(address);
 
   return _URC_NO_REASON;
 }
 #endif
 
+#if FRAME_POINTER_BACKTRACE
+struct StackBounds {
+  uintptr_t low;
+  uintptr_t high;
+};
+
+THREAD_LOCAL_VARIABLE StackBounds currentStackBounds = {0, 0};
+
+StackBounds stackBounds() {
+  if (currentStackBounds.high == 0) {
+#if KONAN_OBJC_INTEROP
+    pthread_t self = pthread_self();
+    uintptr_t high = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+    currentStackBounds = {high - pthread_get_stacksize_np(self), high};
+#else
+    pthread_attr_t attr;
+    void* low = nullptr;
+    size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+      pthread_attr_getstack(&attr, &low, &size);
+      pthread_attr_destroy(&attr);
+    }
+    currentStackBounds = {reinterpret_cast<uintptr_t>(low), reinterpret_cast<uintptr_t>(low) + size};
+#endif
+  }
+  return currentStackBounds;
+}
+
+// Walks the frame records starting from the caller's frame. Code compiled without frame pointers
+// makes the chain inexact, so every record is checked to be inside the stack and strictly above the previous one:
+// the walk may stop early or report bogus frames, but never reads outside of the stack.
+ALWAYS_INLINE inline int captureFramePointers(void** frames, int capacity, int skipCount) {
+  StackBounds bounds = stackBounds();
+  auto frame = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+  int size = 0;
+  while (size < capacity) {
+    if (frame < bounds.low || frame > bounds.high - 2 * sizeof(void*) || frame % sizeof(void*) != 0) break;
+    auto record = reinterpret_cast<void* const*>(frame);
+    void* returnAddress = record[1];
+    if (returnAddress == nullptr) break;
+    if (skipCount > 0) {
+      skipCount--;
+    } else {
+      frames[size++] = returnAddress;
+    }
+    auto next = reinterpret_cast<uintptr_t>(record[0]);
+    if (next <= frame) break;
+    frame = next;
+  }
+  return size;
+}
+#endif // FRAME_POINTER_BACKTRACE
+
+// Collects return addresses of the caller's callers, skipping the innermost `skipCount` of them.
+// Must be inlined so that every method counts frames from the same function.
+ALWAYS_INLINE inline int captureFrames(void** frames, int capacity, int skipCount) {
+#if FRAME_POINTER_BACKTRACE
+  if (g_framePointerBacktrace) {
+    // The first frame record already belongs to the caller, while the unwinders report the caller itself first.
+    return captureFramePointers(frames, capacity, skipCount - 1);
+  }
+#endif
+#if USE_GCC_UNWIND
+  UnwindBuffer buffer = { frames, capacity, 0, skipCount };
+  _Unwind_Backtrace(unwindCallback, &buffer);
+  return buffer.size;
+#else
+  int size = backtrace(frames, capacity);
+  if (size <= skipCount) return 0;
+  memmove(frames, frames + skipCount, (size - skipCount) * sizeof(void*));
+  return size - skipCount;
+#endif
+}
+
 THREAD_LOCAL_VARIABLE bool disallowSourceInfo = false;
 
-#if !OMIT_BACKTRACE && !USE_GCC_UNWIND
+#if !OMIT_BACKTRACE
 SourceInfo getSourceInfo(KConstRef stackTrace, int index) {
   return disallowSourceInfo
       ? SourceInfo { .fileName = nullptr, .lineNumber = -1, .column = -1 }
@@ -111,35 +182,45 @@ SourceInfo getSourceInfo(KConstRef stackTrace, int index) {
 
 // TODO: this implementation is just a hack, e.g. the result is inexact;
 // however it is better to have an inexact stacktrace than not to have any.
+// Only raw addresses are captured here, symbolization is deferred to GetStackTraceStrings.
 NO_INLINE OBJ_GETTER0(Kotlin_getCurrentStackTrace) {
 #if OMIT_BACKTRACE
   return AllocArrayInstance(theNativePtrArrayTypeInfo, 0, OBJ_RESULT);
 #else
   // Skips first 2 elements as irrelevant: this function and primary Throwable constructor.
   constexpr int kSkipFrames = 2;
-#if USE_GCC_UNWIND
-  int depth = 0;
-  _Unwind_Backtrace(depthCountCallback, &depth);
-  Backtrace result(depth, kSkipFrames);
-  if (result.obj()->array()->count_ > 0) {
-    _Unwind_Backtrace(unwindCallback, &result);
+  KInt depth = g_stackTraceDepth;
+  // backtrace() reports the skipped frames too, so the buffer must fit them.
+  int64_t neededCapacity = std::min<int64_t>(static_cast<int64_t>(depth) + kSkipFrames, std::numeric_limits<int>::max());
+  int capacity = static_cast<int>(std::min<int64_t>(neededCapacity, kInlineStackTraceCapacity));
+  void* inlineFrames[kInlineStackTraceCapacity];
+  KStdVector<void*> heapFrames;
+  void** frames = inlineFrames;
+  int size = depth > 0 ? captureFrames(frames, capacity, kSkipFrames) : 0;
+  // Most traces fit into the on-stack buffer. Deeper ones are captured again into a buffer twice as large,
+  // so the cost stays proportional to the actual stack depth, not to the configured limit.
+  while (size >= capacity - kSkipFrames && capacity < neededCapacity) {
+    capacity = static_cast<int>(std::min<int64_t>(neededCapacity, 2 * static_cast<int64_t>(capacity)));
+    heapFrames.resize(capacity);
+    frames = heapFrames.data();
+    size = captureFrames(frames, capacity, kSkipFrames);
   }
-  RETURN_OBJ(result.obj());
-#else
-  const int maxSize = 32;
-  void* buffer[maxSize];
-
-  int size = backtrace(buffer, maxSize);
-  if (size < kSkipFrames)
-    return AllocArrayInstance(theNativePtrArrayTypeInfo, 0, OBJ_RESULT);
+  if (size > depth) size = depth;
 
-  ObjHolder resultHolder;
-  ObjHeader* result = AllocArrayInstance(theNativePtrArrayTypeInfo, size - kSkipFrames, resultHolder.slot());
-  for (int index = kSkipFrames; index < size; ++index) {
-    Kotlin_NativePtrArray_set(result, index - kSkipFrames, buffer[index]);
+  ObjHeader* result = AllocArrayInstance(theNativePtrArrayTypeInfo, size, OBJ_RESULT);
+  if (size > 0) {
+    memcpy(PrimitiveArrayAddressOfElementAt<KNativePtr>(result->array(), 0), frames, size * sizeof(void*));
   }
-  RETURN_OBJ(result);
-#endif
+  return result;
+#endif  // !OMIT_BACKTRACE
+}
+
+NO_INLINE int CaptureStackTrace(void** frames, int capacity, int skipCount) {
+#if OMIT_BACKTRACE
+  return 0;
+#else
+  // Skips this function too.
+  return captureFrames(frames, capacity, skipCount + 1);
 #endif  // !OMIT_BACKTRACE
 }
 
@@ -162,8 +243,16 @@ OBJ_GETTER(GetStackTraceStrings, KConstRef stackTrace) {
       // Make empty string:
       symbol[0] = '\0';
     }
-    char line[512];
-    konan::snprintf(line, sizeof(line) - 1, "%s (%p)", symbol, (void*)(intptr_t)address);
+    auto sourceInfo = getSourceInfo(stackTrace, index);
+    char line[1024];
+    if (sourceInfo.fileName != nullptr && sourceInfo.lineNumber > 0) {
+      konan::snprintf(line, sizeof(line) - 1, "%s (%p) (%s:%d:%d)",
+                      symbol, (void*)(intptr_t)address, sourceInfo.fileName, sourceInfo.lineNumber, sourceInfo.column);
+    } else if (sourceInfo.fileName != nullptr) {
+      konan::snprintf(line, sizeof(line) - 1, "%s (%p) (%s:<unknown>)", symbol, (void*)(intptr_t)address, sourceInfo.fileName);
+    } else {
+      konan::snprintf(line, sizeof(line) - 1, "%s (%p)", symbol, (void*)(intptr_t)address);
+    }
     ObjHolder holder;
     CreateStringFromCString(line, holder.slot());
     UpdateHeapRef(ArrayAddressOfElementAt(strings->array(), index), holder.obj());
@@ -325,3 +414,23 @@ void SetKonanTerminateHandler() {
 void DisallowSourceInfo() {
   disallowSourceInfo = true;
 }
+
+extern "C" {
+
+KInt Konan_Platform_getStackTraceDepth() {
+  return g_stackTraceDepth;
+}
+
+void Konan_Platform_setStackTraceDepth(KInt value) {
+  g_stackTraceDepth = value;
+}
+
+KBoolean Konan_Platform_getFramePointerStackTrace() {
+  return FRAME_POINTER_BACKTRACE && g_framePointerBacktrace;
+}
+
+void Konan_Platform_setFramePointerStackTrace(KBoolean value) {
+  g_framePointerBacktrace = value;
+}
+
+}  // extern "C"
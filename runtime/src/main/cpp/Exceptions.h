@@ -75,4 +75,8 @@ void PrintThrowable(KRef);
 // It's not always safe to extract SourceInfo during unhandled exception termination.
 void DisallowSourceInfo();
 
+// Stores up to `capacity` return addresses into `frames`, starting from the caller of this function after skipping
+// `skipCount` frames, and returns how many were stored. Addresses are not symbolized.
+int CaptureStackTrace(void** frames, int capacity, int skipCount);
+
 #endif // RUNTIME_NAMES_H
@@ -23,15 +23,20 @@
 #include <dlfcn.h>
 #include <elf.h>
 #include <fcntl.h>
+#include <link.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 #include "KAssert.h"
+#include "Mutex.hpp"
 
 namespace {
 
@@ -51,15 +56,21 @@ namespace {
 #error "Impossible ELFSIZE"
 #endif
 
-struct SymRecord {
-  Elf_Sym* symtabBegin;
-  Elf_Sym* symtabEnd;
-  char* strtab;
+// Address range of one sized symbol from the symbol tables of the file.
+struct SymbolEntry {
+  uintptr_t begin;
+  uintptr_t end;
+  // Maximum of `end` over this entry and all entries before it. Symbols may nest (e.g. an alias covering
+  // several functions), so the lookup walks back while an earlier entry may still contain the address.
+  uintptr_t maxEnd;
+  const char* name;
 };
 
-typedef KStdVector<SymRecord> SymRecordList;
+// Entries sorted by `begin`, built once on the first lookup that misses in `dladdr`.
+typedef KStdVector<SymbolEntry> SymbolIndex;
 
-SymRecordList* symbols = nullptr;
+std::atomic<SymbolIndex*> symbols{nullptr};
+kotlin::SpinLock symbolsLock;
 
 // Unfortunately, symbol tables are stored in ELF sections not mapped
 // during regular execution, so we have to map binary ourselves.
@@ -67,36 +78,80 @@ Elf_Ehdr* findElfHeader() {
   int fd = open("/proc/self/exe", O_RDONLY);
   if (fd < 0) return nullptr;
   struct stat fd_stat;
-  if (fstat(fd, &fd_stat) < 0) return nullptr;
-  void* result = mmap(nullptr, fd_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  void* result = MAP_FAILED;
+  if (fstat(fd, &fd_stat) == 0) {
+    result = mmap(nullptr, fd_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping keeps its own reference to the file.
+  close(fd);
   if (result == MAP_FAILED) return nullptr;
   return (Elf_Ehdr*)result;
 }
 
-void initSymbols() {
-  RuntimeAssert(symbols == nullptr, "Init twice");
-  symbols = konanConstructInstance<SymRecordList>();
+// Difference between run time and link time addresses of the executable, non-zero for PIE only.
+uintptr_t executableLoadBias() {
+  uintptr_t bias = 0;
+  // The executable is always reported first.
+  dl_iterate_phdr([](struct dl_phdr_info* info, size_t, void* data) {
+    *static_cast<uintptr_t*>(data) = info->dlpi_addr;
+    return 1;
+  }, &bias);
+  return bias;
+}
+
+void addSymbols(SymbolIndex* index, Elf_Sym* begin, Elf_Sym* end, const char* strtab, uintptr_t bias) {
+  for (Elf_Sym* sym = begin; sym < end; sym++) {
+    // Symbols without size cannot contain any address.
+    if (sym->st_size == 0 || sym->st_shndx == SHN_UNDEF) continue;
+    uintptr_t address = bias + sym->st_value;
+    index->push_back({address, address + sym->st_size, 0, &strtab[sym->st_name]});
+  }
+}
+
+SymbolIndex* buildSymbolIndex() {
+  SymbolIndex* index = konanConstructInstance<SymbolIndex>();
   Elf_Ehdr* ehdr = findElfHeader();
-  if (ehdr == nullptr) return;
+  if (ehdr == nullptr) return index;
   RuntimeAssert(strncmp((const char*)ehdr->e_ident, ELFMAG, SELFMAG) == 0, "Must be an ELF");
   char* mapAddress = (char*)ehdr;
   Elf_Shdr* shdr = (Elf_Shdr*)(mapAddress + ehdr->e_shoff);
+  uintptr_t bias = executableLoadBias();
   for (int i = 0; i < ehdr->e_shnum; i++) {
-    if (shdr[i].sh_type == SHT_SYMTAB) {   // Static symbol table.
-      SymRecord record;
-      record.symtabBegin = (Elf_Sym*)(mapAddress + shdr[i].sh_offset);
-      record.symtabEnd = (Elf_Sym*)((char*)record.symtabBegin + shdr[i].sh_size);
-      record.strtab = (char *)(mapAddress + shdr[shdr[i].sh_link].sh_offset);
-      symbols->push_back(record);
-    }
-    if (shdr[i].sh_type == SHT_DYNSYM) {   // Dynamic symbol table.
-      SymRecord record;
-      record.symtabBegin = (Elf_Sym*)(mapAddress + shdr[i].sh_offset);
-      record.symtabEnd = (Elf_Sym*)((char*)record.symtabBegin + shdr[i].sh_size);
-      record.strtab = (char*)(mapAddress + shdr[shdr[i].sh_link].sh_offset);
-      symbols->push_back(record);
+    // Static and dynamic symbol tables.
+    if (shdr[i].sh_type == SHT_SYMTAB || shdr[i].sh_type == SHT_DYNSYM) {
+      Elf_Sym* begin = (Elf_Sym*)(mapAddress + shdr[i].sh_offset);
+      Elf_Sym* end = (Elf_Sym*)((char*)begin + shdr[i].sh_size);
+      addSymbols(index, begin, end, mapAddress + shdr[shdr[i].sh_link].sh_offset, bias);
     }
   }
+  // Stable sort keeps the section order for equal ranges, so the first table wins as before.
+  std::stable_sort(index->begin(), index->end(), [](const SymbolEntry& lhs, const SymbolEntry& rhs) {
+    return lhs.begin < rhs.begin;
+  });
+  // Most symbols are present in both tables.
+  auto last = std::unique(index->begin(), index->end(), [](const SymbolEntry& lhs, const SymbolEntry& rhs) {
+    return lhs.begin == rhs.begin && lhs.end == rhs.end;
+  });
+  index->erase(last, index->end());
+  index->shrink_to_fit();
+  uintptr_t maxEnd = 0;
+  for (auto& entry : *index) {
+    maxEnd = std::max(maxEnd, entry.end);
+    entry.maxEnd = maxEnd;
+  }
+  return index;
+}
+
+SymbolIndex* symbolIndex() {
+  SymbolIndex* index = symbols.load(std::memory_order_acquire);
+  if (index != nullptr) return index;
+  std::lock_guard<kotlin::SpinLock> guard(symbolsLock);
+  index = symbols.load(std::memory_order_relaxed);
+  if (index == nullptr) {
+    index = buildSymbolIndex();
+    symbols.store(index, std::memory_order_release);
+  }
+  return index;
 }
 
 const char* addressToSymbol(const void* address) {
@@ -109,22 +164,17 @@ const char* addressToSymbol(const void* address) {
   }
 
   // Otherwise, consult symbol table of the file.
-  if (symbols == nullptr) {
-    initSymbols();
-  }
-
-  unsigned long addressValue = (unsigned long)address;
-
-  for (auto record : *symbols) {
-    auto begin = record.symtabBegin;
-    auto end = record.symtabEnd;
-    while (begin < end) {
-      // st_value is load address adjusted.
-      if (addressValue >= begin->st_value && addressValue < begin->st_value + begin->st_size) {
-        return &record.strtab[begin->st_name];
-      }
-      begin++;
-    }
+  SymbolIndex* index = symbolIndex();
+  uintptr_t addressValue = reinterpret_cast<uintptr_t>(address);
+
+  // Last entry starting at or before the address.
+  auto it = std::upper_bound(index->begin(), index->end(), addressValue, [](uintptr_t value, const SymbolEntry& entry) {
+    return value < entry.begin;
+  });
+  while (it != index->begin()) {
+    --it;
+    if (it->maxEnd <= addressValue) break;
+    if (addressValue < it->end) return it->name;
   }
   return nullptr;
 }
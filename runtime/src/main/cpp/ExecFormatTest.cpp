@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "ExecFormat.h"
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#if USE_ELF_SYMBOLS
+
+namespace {
+
+// Not exported, so only the symbol table of the file knows about it.
+__attribute__((noinline)) int localFunctionForSymbolLookup(int x) {
+    return x * 31 + 7;
+}
+
+} // namespace
+
+TEST(ExecFormatTest, LocalFunction) {
+    auto function = reinterpret_cast<const char*>(&localFunctionForSymbolLookup);
+    char buffer[1024];
+    ASSERT_TRUE(AddressToSymbol(function, buffer, sizeof(buffer)));
+    EXPECT_THAT(buffer, testing::HasSubstr("localFunctionForSymbolLookup"));
+    // An address inside the function resolves to the same symbol.
+    ASSERT_TRUE(AddressToSymbol(function + 1, buffer, sizeof(buffer)));
+    EXPECT_THAT(buffer, testing::HasSubstr("localFunctionForSymbolLookup"));
+}
+
+TEST(ExecFormatTest, Truncation) {
+    char buffer[8];
+    ASSERT_TRUE(AddressToSymbol(reinterpret_cast<const void*>(&localFunctionForSymbolLookup), buffer, sizeof(buffer)));
+    EXPECT_EQ(strlen(buffer), sizeof(buffer) - 1);
+}
+
+TEST(ExecFormatTest, Null) {
+    char buffer[64];
+    EXPECT_FALSE(AddressToSymbol(nullptr, buffer, sizeof(buffer)));
+}
+
+TEST(ExecFormatTest, ConcurrentLookups) {
+    constexpr int kThreadCount = 4;
+    std::vector<std::string> results(kThreadCount);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&results, i] {
+            char buffer[1024] = {};
+            AddressToSymbol(reinterpret_cast<const void*>(&localFunctionForSymbolLookup), buffer, sizeof(buffer));
+            results[i] = buffer;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& result : results) {
+        EXPECT_THAT(result, testing::HasSubstr("localFunctionForSymbolLookup"));
+    }
+}
+
+#endif // USE_ELF_SYMBOLS
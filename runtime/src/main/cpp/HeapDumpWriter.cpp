@@ -0,0 +1,126 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "HeapDumpWriter.hpp"
+
+#include <cstring>
+
+#include "KString.h"
+#include "Natives.h"
+#include "ObjectTraversal.hpp"
+#include "TypeInfo.h"
+#include "TypeInfoUtils.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'N', 'H', 'E', 'A', 'P', '\0', '\0'};
+
+} // namespace
+
+HeapDumpWriter::HeapDumpWriter(std::FILE* file) noexcept : file_(file) {
+    WriteBytes(kMagic, sizeof(kMagic));
+    Write(kVersion);
+    Write(static_cast<uint32_t>(sizeof(void*)));
+}
+
+void HeapDumpWriter::WriteRoot(RootKind kind, ObjHeader* object) noexcept {
+    if (object == nullptr) return;
+    Write(static_cast<uint8_t>(Tag::kRoot));
+    Write(static_cast<uint8_t>(kind));
+    WriteId(object);
+}
+
+void HeapDumpWriter::WriteObject(ObjHeader* object) noexcept {
+    const TypeInfo* typeInfo = object->type_info();
+    if (types_.insert(typeInfo).second) {
+        WriteType(typeInfo);
+    }
+
+    // Arrays of primitives have no references, and `traverseObjectFields` knows that.
+    references_.clear();
+    bool isArray = typeInfo->IsArray();
+    uintptr_t base = isArray ? reinterpret_cast<uintptr_t>(ArrayAddressOfElementAt(object->array(), 0))
+                             : reinterpret_cast<uintptr_t>(object);
+    traverseObjectFields(object, [this, isArray, base](ObjHeader** location) noexcept {
+        if (ObjHeader* referent = *location) {
+            uintptr_t offset = reinterpret_cast<uintptr_t>(location) - base;
+            references_.emplace_back(static_cast<uint32_t>(isArray ? offset / sizeof(ObjHeader*) : offset), referent);
+        }
+    });
+
+    Write(static_cast<uint8_t>(isArray ? Tag::kArray : Tag::kObject));
+    WriteId(object);
+    WriteId(typeInfo);
+    Write(ObjectSize(object));
+    if (isArray) {
+        Write(object->array()->count_);
+    }
+    Write(static_cast<uint32_t>(references_.size()));
+    for (auto& reference : references_) {
+        Write(reference.first);
+        WriteId(reference.second);
+    }
+}
+
+bool HeapDumpWriter::Finish() noexcept {
+    Write(static_cast<uint8_t>(Tag::kEnd));
+    if (std::fflush(file_) != 0) {
+        failed_ = true;
+    }
+    return !failed_;
+}
+
+void HeapDumpWriter::WriteType(const TypeInfo* typeInfo) noexcept {
+    Write(static_cast<uint8_t>(Tag::kType));
+    WriteId(typeInfo);
+    Write(typeInfo->instanceSize_);
+    WriteString(typeInfo->packageName_);
+    WriteString(typeInfo->relativeName_);
+
+    const ExtendedTypeInfo* extendedInfo = typeInfo->extendedInfo_;
+    if (extendedInfo != nullptr) {
+        // Arrays store their element type as a negated field count.
+        uint32_t fieldsCount = extendedInfo->fieldsCount_ > 0 ? extendedInfo->fieldsCount_ : 0;
+        Write(fieldsCount);
+        for (uint32_t index = 0; index < fieldsCount; ++index) {
+            WriteString(extendedInfo->fieldNames_[index]);
+            Write(extendedInfo->fieldOffsets_[index]);
+            Write(extendedInfo->fieldTypes_[index]);
+        }
+    } else {
+        // Without debug information only reference fields are known, and their names are not.
+        Write(static_cast<uint32_t>(typeInfo->objOffsetsCount_));
+        for (int32_t index = 0; index < typeInfo->objOffsetsCount_; ++index) {
+            WriteString(static_cast<const char*>(nullptr));
+            Write(typeInfo->objOffsets_[index]);
+            Write(static_cast<uint8_t>(RT_OBJECT));
+        }
+    }
+}
+
+void HeapDumpWriter::WriteString(const char* string) noexcept {
+    uint32_t length = string != nullptr ? std::strlen(string) : 0;
+    Write(length);
+    WriteBytes(string, length);
+}
+
+void HeapDumpWriter::WriteString(ObjHeader* string) noexcept {
+    if (string == nullptr) {
+        WriteString(static_cast<const char*>(nullptr));
+        return;
+    }
+    char* cstring = CreateCStringFromString(string);
+    WriteString(cstring);
+    DisposeCString(cstring);
+}
+
+void HeapDumpWriter::WriteBytes(const void* data, size_t size) noexcept {
+    if (failed_ || size == 0) return;
+    if (std::fwrite(data, 1, size, file_) != size) {
+        failed_ = true;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_HEAP_DUMP_WRITER_H
+#define RUNTIME_HEAP_DUMP_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include "Memory.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Streams a heap dump into a file. The dump is a sequence of records in the native byte order, preceded by a header:
+//
+//   header:  "KNHEAP\0\0", u32 version, u32 identifier size
+//   type:    u8 kType, id type, i32 instance size (negated element size for arrays), string package name,
+//            string relative name, u32 field count, field count * (string name, i32 offset, u8 Konan_RuntimeType)
+//   object:  u8 kObject, id object, id type, u64 size, u32 reference count, reference count * (u32 offset, id referent)
+//   array:   u8 kArray, id array, id type, u64 size, u32 length, u32 reference count, reference count * (u32 index, id referent)
+//   root:    u8 kRoot, u8 RootKind, id object
+//   end:     u8 kEnd
+//
+// Identifiers are addresses. Strings are a u32 length followed by that many UTF-8 bytes. A type record precedes
+// the first object of that type. Only non-null references are written. References may point to objects without a
+// record, e.g. to permanent objects.
+class HeapDumpWriter : private Pinned {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    enum class Tag : uint8_t {
+        kEnd = 0,
+        kType = 1,
+        kObject = 2,
+        kArray = 3,
+        kRoot = 4,
+    };
+
+    enum class RootKind : uint8_t {
+        kGlobal = 1,
+        kStableRef = 2,
+        kStack = 3,
+        kThreadLocal = 4,
+    };
+
+    // Does not take ownership of `file`.
+    explicit HeapDumpWriter(std::FILE* file) noexcept;
+
+    void WriteRoot(RootKind kind, ObjHeader* object) noexcept;
+
+    void WriteObject(ObjHeader* object) noexcept;
+
+    // Writes the end record and flushes the file. Returns `false` if any of the writes failed.
+    bool Finish() noexcept;
+
+private:
+    void WriteType(const TypeInfo* typeInfo) noexcept;
+
+    void WriteString(const char* string) noexcept;
+    void WriteString(ObjHeader* string) noexcept;
+    void WriteId(const void* id) noexcept { Write(reinterpret_cast<uintptr_t>(id)); }
+
+    template <typename T>
+    void Write(T value) noexcept {
+        WriteBytes(&value, sizeof(value));
+    }
+
+    void WriteBytes(const void* data, size_t size) noexcept;
+
+    std::FILE* file_;
+    bool failed_ = false;
+    KStdUnorderedSet<const TypeInfo*> types_;
+    KStdVector<std::pair<uint32_t, ObjHeader*>> references_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_HEAP_DUMP_WRITER_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "HeapDumpWriter.hpp"
+
+#include <array>
+#include <cstring>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ObjectTestSupport.hpp"
+#include "TypeInfo.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+using namespace kotlin;
+
+using test_support::Array;
+using test_support::Object;
+
+namespace {
+
+class Reader {
+public:
+    explicit Reader(std::FILE* file) {
+        std::rewind(file);
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data_.insert(data_.end(), buffer, buffer + read);
+        }
+    }
+
+    template <typename T>
+    T Read() {
+        T value;
+        EXPECT_THAT(position_ + sizeof(T), testing::Le(data_.size()));
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return value;
+    }
+
+    uint8_t ReadTag() { return Read<uint8_t>(); }
+
+    void* ReadId() { return reinterpret_cast<void*>(Read<uintptr_t>()); }
+
+    KStdString ReadString() {
+        uint32_t length = Read<uint32_t>();
+        KStdString result(reinterpret_cast<const char*>(data_.data() + position_), length);
+        position_ += length;
+        return result;
+    }
+
+    void ReadHeader() {
+        EXPECT_THAT(ReadString8(), KStdString("KNHEAP\0\0", 8));
+        EXPECT_THAT(Read<uint32_t>(), HeapDumpWriter::kVersion);
+        EXPECT_THAT(Read<uint32_t>(), sizeof(void*));
+    }
+
+    bool AtEnd() const { return position_ == data_.size(); }
+
+private:
+    KStdString ReadString8() {
+        KStdString result(reinterpret_cast<const char*>(data_.data() + position_), 8);
+        position_ += 8;
+        return result;
+    }
+
+    KStdVector<uint8_t> data_;
+    size_t position_ = 0;
+};
+
+constexpr uint8_t Tag(HeapDumpWriter::Tag tag) {
+    return static_cast<uint8_t>(tag);
+}
+
+class HeapDumpWriterTest : public testing::Test {
+public:
+    HeapDumpWriterTest() : file_(std::tmpfile()) {}
+
+    ~HeapDumpWriterTest() { std::fclose(file_); }
+
+    std::FILE* file() { return file_; }
+
+private:
+    std::FILE* file_;
+};
+
+} // namespace
+
+TEST_F(HeapDumpWriterTest, Empty) {
+    HeapDumpWriter writer(file());
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(HeapDumpWriterTest, Roots) {
+    ObjHeader global;
+    ObjHeader stack;
+    HeapDumpWriter writer(file());
+    writer.WriteRoot(HeapDumpWriter::RootKind::kGlobal, &global);
+    writer.WriteRoot(HeapDumpWriter::RootKind::kStack, nullptr);
+    writer.WriteRoot(HeapDumpWriter::RootKind::kStack, &stack);
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kRoot));
+    EXPECT_THAT(reader.Read<uint8_t>(), static_cast<uint8_t>(HeapDumpWriter::RootKind::kGlobal));
+    EXPECT_THAT(reader.ReadId(), &global);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kRoot));
+    EXPECT_THAT(reader.Read<uint8_t>(), static_cast<uint8_t>(HeapDumpWriter::RootKind::kStack));
+    EXPECT_THAT(reader.ReadId(), &stack);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(HeapDumpWriterTest, ObjectWithFieldNames) {
+    ObjHeader referent;
+    Object<2> object;
+    object[1] = &referent;
+    std::array<int32_t, 3> fieldOffsets = {object.offset(0), object.offset(1), 0};
+    std::array<uint8_t, 3> fieldTypes = {RT_OBJECT, RT_OBJECT, RT_INT32};
+    std::array<const char*, 3> fieldNames = {"first", "second", "count"};
+    ExtendedTypeInfo extendedInfo{};
+    extendedInfo.fieldsCount_ = 3;
+    extendedInfo.fieldOffsets_ = fieldOffsets.data();
+    extendedInfo.fieldTypes_ = fieldTypes.data();
+    extendedInfo.fieldNames_ = fieldNames.data();
+    object.type().extendedInfo_ = &extendedInfo;
+
+    HeapDumpWriter writer(file());
+    writer.WriteObject(object.header());
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kType));
+    EXPECT_THAT(reader.ReadId(), &object.type());
+    EXPECT_THAT(reader.Read<int32_t>(), object.type().instanceSize_);
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.Read<uint32_t>(), 3);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_THAT(reader.ReadString(), fieldNames[i]);
+        EXPECT_THAT(reader.Read<int32_t>(), fieldOffsets[i]);
+        EXPECT_THAT(reader.Read<uint8_t>(), fieldTypes[i]);
+    }
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kObject));
+    EXPECT_THAT(reader.ReadId(), object.header());
+    EXPECT_THAT(reader.ReadId(), &object.type());
+    EXPECT_THAT(reader.Read<uint64_t>(), sizeof(Object<2>));
+    EXPECT_THAT(reader.Read<uint32_t>(), 1);
+    EXPECT_THAT(reader.Read<uint32_t>(), object.offset(1));
+    EXPECT_THAT(reader.ReadId(), &referent);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(HeapDumpWriterTest, TypeWithoutFieldNames) {
+    Object<1> object1;
+    Object<1> object2(object1);
+
+    HeapDumpWriter writer(file());
+    writer.WriteObject(object1.header());
+    writer.WriteObject(object2.header());
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kType));
+    EXPECT_THAT(reader.ReadId(), &object1.type());
+    EXPECT_THAT(reader.Read<int32_t>(), object1.type().instanceSize_);
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.Read<uint32_t>(), 1);
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.Read<int32_t>(), object1.offset(0));
+    EXPECT_THAT(reader.Read<uint8_t>(), RT_OBJECT);
+    // The type is written only once.
+    for (auto* object : {object1.header(), object2.header()}) {
+        EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kObject));
+        EXPECT_THAT(reader.ReadId(), object);
+        EXPECT_THAT(reader.ReadId(), &object1.type());
+        EXPECT_THAT(reader.Read<uint64_t>(), sizeof(Object<1>));
+        EXPECT_THAT(reader.Read<uint32_t>(), 0);
+    }
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(HeapDumpWriterTest, ObjectArray) {
+    ObjHeader referent1;
+    ObjHeader referent3;
+    Array<3> array;
+    array[0] = &referent1;
+    array[2] = &referent3;
+
+    HeapDumpWriter writer(file());
+    writer.WriteObject(array.header());
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kType));
+    EXPECT_THAT(reader.ReadId(), theArrayTypeInfo);
+    reader.Read<int32_t>();
+    reader.ReadString();
+    reader.ReadString();
+    uint32_t fieldsCount = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < fieldsCount; ++i) {
+        reader.ReadString();
+        reader.Read<int32_t>();
+        reader.Read<uint8_t>();
+    }
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kArray));
+    EXPECT_THAT(reader.ReadId(), array.header());
+    EXPECT_THAT(reader.ReadId(), theArrayTypeInfo);
+    EXPECT_THAT(reader.Read<uint64_t>(), sizeof(ArrayHeader) + 3 * sizeof(ObjHeader*));
+    EXPECT_THAT(reader.Read<uint32_t>(), 3);
+    EXPECT_THAT(reader.Read<uint32_t>(), 2);
+    EXPECT_THAT(reader.Read<uint32_t>(), 0);
+    EXPECT_THAT(reader.ReadId(), &referent1);
+    EXPECT_THAT(reader.Read<uint32_t>(), 2);
+    EXPECT_THAT(reader.ReadId(), &referent3);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(HeapDumpWriterTest, PrimitiveArray) {
+    TypeInfo type{};
+    type.typeInfo_ = &type;
+    type.instanceSize_ = -static_cast<int32_t>(sizeof(int32_t));
+    Array<4> array(&type);
+
+    HeapDumpWriter writer(file());
+    writer.WriteObject(array.header());
+    EXPECT_TRUE(writer.Finish());
+
+    Reader reader(file());
+    reader.ReadHeader();
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kType));
+    EXPECT_THAT(reader.ReadId(), &type);
+    EXPECT_THAT(reader.Read<int32_t>(), type.instanceSize_);
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.ReadString(), "");
+    EXPECT_THAT(reader.Read<uint32_t>(), 0);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kArray));
+    EXPECT_THAT(reader.ReadId(), array.header());
+    EXPECT_THAT(reader.ReadId(), &type);
+    EXPECT_THAT(reader.Read<uint64_t>(), sizeof(ArrayHeader) + 4 * sizeof(int32_t));
+    EXPECT_THAT(reader.Read<uint32_t>(), 4);
+    EXPECT_THAT(reader.Read<uint32_t>(), 0);
+    EXPECT_THAT(reader.ReadTag(), Tag(HeapDumpWriter::Tag::kEnd));
+    EXPECT_TRUE(reader.AtEnd());
+}
@@ -23,6 +23,7 @@
 #include "Memory.h"
 #include "Natives.h"
 #include "KString.h"
+#include "NumberFormatting.hpp"
 #include "Porting.h"
 #include "Types.h"
 
@@ -270,16 +271,7 @@ KInt Kotlin_StringBuilder_insertString(KRef builder, KInt distIndex, KString fro
 KInt Kotlin_StringBuilder_insertInt(KRef builder, KInt position, KInt value) {
   auto toArray = builder->array();
   RuntimeAssert(toArray->count_ >= static_cast<uint32_t>(11 + position), "must be true");
-  char cstring[12];
-  auto length = konan::snprintf(cstring, sizeof(cstring), "%d", value);
-  RuntimeAssert(length >= 0, "This should never happen"); // may be overkill
-  RuntimeAssert(static_cast<size_t>(length) < sizeof(cstring), "Unexpectedly large value"); // Can't be, but this is what sNprintf for
-  auto* from = &cstring[0];
-  auto* to = CharArrayAddressOfElementAt(toArray, position);
-  while (*from) {
-    *to++ = *from++;
-  }
-  return from - cstring;
+  return kotlin::FormatInteger(value, CharArrayAddressOfElementAt(toArray, position));
 }
 
 
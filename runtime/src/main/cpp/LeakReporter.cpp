@@ -0,0 +1,174 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "LeakReporter.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "Natives.h"
+#include "ObjectTraversal.hpp"
+#include "Porting.h"
+#include "TypeInfo.h"
+#include "TypeInfoUtils.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+// Longer paths are printed with the middle elided.
+constexpr size_t kMaxPrintedPathLength = 16;
+
+const char* rootName(LeakReporter::RootKind kind) noexcept {
+    switch (kind) {
+        case LeakReporter::RootKind::kStableRef:
+            return "stable ref";
+        case LeakReporter::RootKind::kAtomic:
+            return "atomic reference";
+    }
+    return "unknown root";
+}
+
+// Describes the reference from `object` to `referent`: `.name` for fields, `[index]` for array elements.
+KStdString referenceName(ObjHeader* object, ObjHeader* referent) noexcept {
+    const TypeInfo* typeInfo = object->type_info();
+    ObjHeader** found = nullptr;
+    traverseObjectFields(object, [&found, referent](ObjHeader** location) noexcept {
+        if (found == nullptr && *location == referent) found = location;
+    });
+    // The reference may have been changed since the path was found.
+    if (found == nullptr) return ".?";
+
+    char buffer[32];
+    // Like traverseObjectFields, only arrays of references can refer to other objects.
+    if (typeInfo == theArrayTypeInfo) {
+        auto index = found - ArrayAddressOfElementAt(object->array(), 0);
+        konan::snprintf(buffer, sizeof(buffer), "[%td]", index);
+        return buffer;
+    }
+    int32_t offset = static_cast<int32_t>(reinterpret_cast<uintptr_t>(found) - reinterpret_cast<uintptr_t>(object));
+    if (const ExtendedTypeInfo* extendedInfo = typeInfo->extendedInfo_) {
+        for (int32_t index = 0; index < extendedInfo->fieldsCount_; ++index) {
+            if (extendedInfo->fieldOffsets_[index] == offset) {
+                return KStdString(".") + extendedInfo->fieldNames_[index];
+            }
+        }
+    }
+    // Without debug information field names are not known.
+    konan::snprintf(buffer, sizeof(buffer), ".@%d", offset);
+    return buffer;
+}
+
+} // namespace
+
+void LeakReporter::AddLiveRoot(ObjHeader* object) noexcept {
+    if (object == nullptr) return;
+    liveRoots_.push_back(object);
+}
+
+void LeakReporter::AddLeakRoot(RootKind kind, ObjHeader* object) noexcept {
+    if (object == nullptr) return;
+    leakRoots_.emplace_back(kind, object);
+}
+
+KStdVector<LeakReporter::Leak> LeakReporter::FindLeaks() noexcept {
+    // Breadth-first search, so that the first found path to an object is a shortest one.
+    KStdVector<ObjHeader*> queue;
+    KStdUnorderedSet<ObjHeader*> live;
+    auto enqueueLive = [&queue, &live](ObjHeader* object) noexcept {
+        // Permanent objects never refer to heap objects, and never leak.
+        if (object->permanent() || !live.insert(object).second) return;
+        queue.push_back(object);
+    };
+    for (ObjHeader* root : liveRoots_) {
+        enqueueLive(root);
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        traverseReferredObjects(queue[head], enqueueLive);
+    }
+
+    queue.clear();
+    // Leaked objects to the objects they were found from. Roots map to `nullptr`.
+    KStdUnorderedMap<ObjHeader*, ObjHeader*> parents;
+    KStdUnorderedMap<ObjHeader*, RootKind> roots;
+    for (auto& root : leakRoots_) {
+        ObjHeader* object = root.second;
+        if (object->permanent() || live.count(object) != 0 || !parents.emplace(object, nullptr).second) continue;
+        roots.emplace(object, root.first);
+        queue.push_back(object);
+    }
+
+    KStdVector<Leak> leaks;
+    KStdUnorderedMap<const TypeInfo*, size_t> leakIndices;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        ObjHeader* object = queue[head];
+        const TypeInfo* typeInfo = object->type_info();
+        auto it = leakIndices.find(typeInfo);
+        if (it == leakIndices.end()) {
+            Leak leak{typeInfo, 0, 0, RootKind::kStableRef, {}};
+            for (ObjHeader* current = object; current != nullptr; current = parents[current]) {
+                leak.path.push_back(current);
+            }
+            std::reverse(leak.path.begin(), leak.path.end());
+            leak.rootKind = roots[leak.path.front()];
+            it = leakIndices.emplace(typeInfo, leaks.size()).first;
+            leaks.push_back(std::move(leak));
+        }
+        Leak& leak = leaks[it->second];
+        ++leak.count;
+        leak.bytes += ObjectSize(object);
+
+        traverseReferredObjects(object, [&queue, &live, &parents, object](ObjHeader* referent) noexcept {
+            if (referent->permanent() || live.count(referent) != 0 || !parents.emplace(referent, object).second) return;
+            queue.push_back(referent);
+        });
+    }
+
+    std::stable_sort(leaks.begin(), leaks.end(), [](const Leak& lhs, const Leak& rhs) { return lhs.bytes > rhs.bytes; });
+    return leaks;
+}
+
+size_t LeakReporter::Report() noexcept {
+    auto leaks = FindLeaks();
+    if (leaks.empty()) {
+        konan::consoleErrorf("No leaked objects found\n");
+        return 0;
+    }
+
+    size_t count = 0;
+    uint64_t bytes = 0;
+    for (auto& leak : leaks) {
+        count += leak.count;
+        bytes += leak.bytes;
+    }
+    konan::consoleErrorf("Leaked %zu objects (%" PRIu64 " bytes) of %zu types:\n", count, bytes, leaks.size());
+    for (auto& leak : leaks) {
+        konan::consoleErrorf(
+                "  %zu objects (%" PRIu64 " bytes) of %s, e.g. retained by\n    %s\n", leak.count, leak.bytes,
+                TypeName(leak.typeInfo).c_str(), FormatPath(leak.rootKind, leak.path).c_str());
+    }
+    return count;
+}
+
+// static
+KStdString LeakReporter::FormatPath(RootKind rootKind, const KStdVector<ObjHeader*>& path) noexcept {
+    KStdString result = rootName(rootKind);
+    for (size_t index = 0; index < path.size(); ++index) {
+        if (path.size() > kMaxPrintedPathLength && index == kMaxPrintedPathLength / 2) {
+            size_t elided = path.size() - kMaxPrintedPathLength;
+            char buffer[48];
+            konan::snprintf(buffer, sizeof(buffer), " -> ... %zu more objects ...", elided);
+            result += buffer;
+            index += elided - 1;
+            continue;
+        }
+        result += " -> ";
+        result += TypeName(path[index]->type_info());
+        if (index + 1 < path.size()) {
+            result += referenceName(path[index], path[index + 1]);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_LEAK_REPORTER_H
+#define RUNTIME_LEAK_REPORTER_H
+
+#include <cstdint>
+
+#include "Memory.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Finds objects that are retained by leak roots (stable refs, atomic references), but not by live roots
+// (e.g. stacks, globals), groups them by type and finds a shortest retaining path for each type, so that a leak can be tracked
+// down instead of just being detected.
+class LeakReporter : private Pinned {
+public:
+    enum class RootKind {
+        kStableRef,
+        kAtomic,
+    };
+
+    struct Leak {
+        const TypeInfo* typeInfo;
+        size_t count;
+        uint64_t bytes;
+        // A shortest path to an object of this type from the root of `rootKind`: starts with the root and ends with
+        // the leaked object.
+        RootKind rootKind;
+        KStdVector<ObjHeader*> path;
+    };
+
+    // Objects reachable from live roots are not reported.
+    void AddLiveRoot(ObjHeader* object) noexcept;
+    void AddLeakRoot(RootKind kind, ObjHeader* object) noexcept;
+
+    // Traverses the heap from the roots. Leaks are sorted by retained bytes, most first.
+    KStdVector<Leak> FindLeaks() noexcept;
+
+    // Prints `FindLeaks` to the console. Returns the number of leaked objects.
+    size_t Report() noexcept;
+
+    static KStdString FormatPath(RootKind rootKind, const KStdVector<ObjHeader*>& path) noexcept;
+
+private:
+    KStdVector<ObjHeader*> liveRoots_;
+    KStdVector<std::pair<RootKind, ObjHeader*>> leakRoots_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_LEAK_REPORTER_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "LeakReporter.hpp"
+
+#include <array>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ObjectTestSupport.hpp"
+#include "TypeInfo.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+using namespace kotlin;
+
+using test_support::Array;
+using test_support::Object;
+
+using testing::ElementsAre;
+
+TEST(LeakReporterTest, NoRoots) {
+    LeakReporter reporter;
+    EXPECT_THAT(reporter.FindLeaks(), testing::IsEmpty());
+    EXPECT_THAT(reporter.Report(), 0);
+}
+
+TEST(LeakReporterTest, LiveObjectsAreNotLeaked) {
+    Object<1> live;
+    Object<1> shared;
+    Object<1> leaked;
+    live[0] = shared.header();
+    leaked[0] = shared.header();
+
+    LeakReporter reporter;
+    reporter.AddLiveRoot(live.header());
+    reporter.AddLeakRoot(LeakReporter::RootKind::kStableRef, leaked.header());
+    reporter.AddLeakRoot(LeakReporter::RootKind::kStableRef, live.header());
+
+    auto leaks = reporter.FindLeaks();
+    ASSERT_THAT(leaks.size(), 1);
+    EXPECT_THAT(leaks[0].typeInfo, leaked.header()->type_info());
+    EXPECT_THAT(leaks[0].count, 1);
+    EXPECT_THAT(leaks[0].bytes, sizeof(Object<1>));
+    EXPECT_THAT(leaks[0].rootKind, LeakReporter::RootKind::kStableRef);
+    EXPECT_THAT(leaks[0].path, ElementsAre(leaked.header()));
+}
+
+TEST(LeakReporterTest, GroupByType) {
+    Object<2> root;
+    Object<0> first;
+    Object<0> second(first);
+    Object<2> holder(root);
+    root[0] = first.header();
+    root[1] = holder.header();
+    holder[0] = second.header();
+    // Cycles are traversed once.
+    holder[1] = root.header();
+
+    LeakReporter reporter;
+    reporter.AddLeakRoot(LeakReporter::RootKind::kAtomic, root.header());
+
+    auto leaks = reporter.FindLeaks();
+    ASSERT_THAT(leaks.size(), 2);
+    EXPECT_THAT(leaks[0].typeInfo, root.header()->type_info());
+    EXPECT_THAT(leaks[0].count, 2);
+    EXPECT_THAT(leaks[0].bytes, 2 * sizeof(Object<2>));
+    EXPECT_THAT(leaks[0].rootKind, LeakReporter::RootKind::kAtomic);
+    EXPECT_THAT(leaks[0].path, ElementsAre(root.header()));
+    EXPECT_THAT(leaks[1].typeInfo, first.header()->type_info());
+    EXPECT_THAT(leaks[1].count, 2);
+    EXPECT_THAT(leaks[1].bytes, 2 * sizeof(Object<0>));
+    EXPECT_THAT(leaks[1].path, ElementsAre(root.header(), first.header()));
+    EXPECT_THAT(reporter.Report(), 4);
+}
+
+TEST(LeakReporterTest, ShortestPath) {
+    Object<1> atomic;
+    Object<1> stableRef;
+    Object<1> middle;
+    Object<0> leaked;
+    atomic[0] = middle.header();
+    middle[0] = leaked.header();
+    stableRef[0] = leaked.header();
+
+    LeakReporter reporter;
+    reporter.AddLeakRoot(LeakReporter::RootKind::kAtomic, atomic.header());
+    reporter.AddLeakRoot(LeakReporter::RootKind::kStableRef, stableRef.header());
+
+    for (auto& leak : reporter.FindLeaks()) {
+        if (leak.typeInfo != leaked.header()->type_info()) continue;
+        EXPECT_THAT(leak.rootKind, LeakReporter::RootKind::kStableRef);
+        EXPECT_THAT(leak.path, ElementsAre(stableRef.header(), leaked.header()));
+        return;
+    }
+    ADD_FAILURE() << "Leaked object is not found";
+}
+
+TEST(LeakReporterTest, FormatPath) {
+    Object<2> object;
+    Object<1> unnamed;
+    Array<3> array;
+    Object<0> leaked;
+    object[1] = unnamed.header();
+    unnamed[0] = array.header();
+    array[2] = leaked.header();
+
+    std::array<int32_t, 2> fieldOffsets = {object.offset(0), object.offset(1)};
+    std::array<uint8_t, 2> fieldTypes = {RT_OBJECT, RT_OBJECT};
+    std::array<const char*, 2> fieldNames = {"first", "second"};
+    ExtendedTypeInfo extendedInfo{};
+    extendedInfo.fieldsCount_ = 2;
+    extendedInfo.fieldOffsets_ = fieldOffsets.data();
+    extendedInfo.fieldTypes_ = fieldTypes.data();
+    extendedInfo.fieldNames_ = fieldNames.data();
+    object.type().extendedInfo_ = &extendedInfo;
+
+    KStdVector<ObjHeader*> path = {object.header(), unnamed.header(), array.header(), leaked.header()};
+    auto expected = "stable ref -> <anonymous>.second -> <anonymous>.@" + std::to_string(unnamed.offset(0)) +
+            " -> <anonymous>[2] -> <anonymous>";
+    EXPECT_THAT(LeakReporter::FormatPath(LeakReporter::RootKind::kStableRef, path), expected.c_str());
+}
+
+TEST(LeakReporterTest, FormatLongPath) {
+    constexpr size_t kLength = 40;
+    std::array<Object<1>, kLength> objects;
+    KStdVector<ObjHeader*> path;
+    for (size_t i = 0; i < kLength; ++i) {
+        if (i + 1 < kLength) objects[i][0] = objects[i + 1].header();
+        path.push_back(objects[i].header());
+    }
+
+    std::string formatted = LeakReporter::FormatPath(LeakReporter::RootKind::kAtomic, path).c_str();
+    EXPECT_THAT(formatted, testing::StartsWith("atomic reference -> "));
+    EXPECT_THAT(formatted, testing::HasSubstr(" -> ... 24 more objects ... -> "));
+    EXPECT_THAT(formatted, testing::EndsWith(" -> <anonymous>"));
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include <atomic>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#if KONAN_WINDOWS
+#include <windows.h>
+#elif !KONAN_WASM && !KONAN_ZEPHYR
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Alloc.h"
+#include "ByteOrder.hpp"
+#include "Exceptions.h"
+#include "KString.h"
+#include "Memory.h"
+#include "Natives.h"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+// Owns the mapping outside of the Kotlin heap, so that the cleaner of a file that was never closed can unmap it.
+struct Mapping {
+    void* address = nullptr;
+    void* handle = nullptr; // File mapping object on Windows, unused elsewhere.
+    KLong size = 0;
+    std::atomic<bool> unmapped = false;
+};
+
+// Must match the fields of MappedFile in MappedFile.kt.
+struct MappedFile {
+    ObjHeader header;
+    void* address;
+    KLong size;
+    KBoolean closed;
+    Mapping* mapping;
+};
+
+// Must match MappedFile.Advice in MappedFile.kt.
+enum class Advice {
+    kNormal = 0,
+    kSequential = 1,
+    kRandom = 2,
+    kWillNeed = 3,
+};
+
+constexpr int kUnsupported = -1;
+
+MappedFile* asMappedFile(KRef thiz) {
+    return reinterpret_cast<MappedFile*>(thiz);
+}
+
+const uint8_t* addressAt(KRef thiz, KLong index, KLong width) {
+    auto* file = asMappedFile(thiz);
+    if (file->closed) ThrowIllegalStateException();
+    if (index < 0 || index > file->size - width) ThrowArrayIndexOutOfBoundsException();
+    return static_cast<const uint8_t*>(file->address) + index;
+}
+
+template <typename T>
+T getAt(KRef thiz, KLong index) {
+    return LoadLittleEndian<T>(addressAt(thiz, index, sizeof(T)));
+}
+
+#if KONAN_WINDOWS
+
+int mapFile(Mapping* mapping, const char* path) {
+    int pathLength = ::MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+    if (pathLength == 0) return ::GetLastError();
+    KStdVector<wchar_t> widePath(pathLength);
+    ::MultiByteToWideChar(CP_UTF8, 0, path, -1, widePath.data(), pathLength);
+
+    HANDLE fileHandle = ::CreateFileW(
+            widePath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return ::GetLastError();
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(fileHandle, &size)) {
+        int error = ::GetLastError();
+        ::CloseHandle(fileHandle);
+        return error;
+    }
+    if (static_cast<uint64_t>(size.QuadPart) > SIZE_MAX) {
+        ::CloseHandle(fileHandle);
+        return ERROR_FILE_TOO_LARGE;
+    }
+    // Empty files cannot be mapped, but there is nothing to read from them anyway.
+    if (size.QuadPart > 0) {
+        HANDLE fileMapping = ::CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (fileMapping == nullptr) {
+            int error = ::GetLastError();
+            ::CloseHandle(fileHandle);
+            return error;
+        }
+        void* address = ::MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        if (address == nullptr) {
+            int error = ::GetLastError();
+            ::CloseHandle(fileMapping);
+            ::CloseHandle(fileHandle);
+            return error;
+        }
+        mapping->address = address;
+        mapping->handle = fileMapping;
+    }
+    ::CloseHandle(fileHandle);
+    mapping->size = size.QuadPart;
+    return 0;
+}
+
+void unmapFile(Mapping* mapping) {
+    if (mapping->address != nullptr) ::UnmapViewOfFile(mapping->address);
+    if (mapping->handle != nullptr) ::CloseHandle(mapping->handle);
+}
+
+void adviseFile(Mapping* mapping, Advice advice) {
+    // Windows has no portable equivalent of madvise for file views.
+}
+
+OBJ_GETTER(errorMessage, int error) {
+    if (error == kUnsupported) RETURN_RESULT_OF(CreateStringFromCString, "not supported");
+    char message[512] = {};
+    ::FormatMessageA(
+            FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, error, 0, message, sizeof(message), nullptr);
+    RETURN_RESULT_OF(CreateStringFromCString, message);
+}
+
+#elif KONAN_WASM || KONAN_ZEPHYR
+
+int mapFile(Mapping* mapping, const char* path) {
+    return kUnsupported;
+}
+
+void unmapFile(Mapping* mapping) {}
+
+void adviseFile(Mapping* mapping, Advice advice) {}
+
+OBJ_GETTER(errorMessage, int error) {
+    RETURN_RESULT_OF(CreateStringFromCString, "not supported");
+}
+
+#else
+
+int mapFile(Mapping* mapping, const char* path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno;
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0) {
+        int error = errno;
+        ::close(fd);
+        return error;
+    }
+    if (static_cast<uint64_t>(fileStat.st_size) > SIZE_MAX) {
+        ::close(fd);
+        return EFBIG;
+    }
+    // Empty files cannot be mapped, but there is nothing to read from them anyway.
+    if (fileStat.st_size > 0) {
+        void* address = ::mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            return error;
+        }
+        mapping->address = address;
+    }
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    mapping->size = fileStat.st_size;
+    return 0;
+}
+
+void unmapFile(Mapping* mapping) {
+    if (mapping->address != nullptr) ::munmap(mapping->address, mapping->size);
+}
+
+void adviseFile(Mapping* mapping, Advice advice) {
+    if (mapping->address == nullptr) return;
+    int posixAdvice = MADV_NORMAL;
+    switch (advice) {
+        case Advice::kNormal:
+            posixAdvice = MADV_NORMAL;
+            break;
+        case Advice::kSequential:
+            posixAdvice = MADV_SEQUENTIAL;
+            break;
+        case Advice::kRandom:
+            posixAdvice = MADV_RANDOM;
+            break;
+        case Advice::kWillNeed:
+            posixAdvice = MADV_WILLNEED;
+            break;
+    }
+    // Advice is only a hint, failures are not interesting.
+    ::madvise(mapping->address, mapping->size, posixAdvice);
+}
+
+OBJ_GETTER(errorMessage, int error) {
+    if (error == kUnsupported) RETURN_RESULT_OF(CreateStringFromCString, "not supported");
+    RETURN_RESULT_OF(CreateStringFromCString, ::strerror(error));
+}
+
+#endif
+
+// Both close() and the cleaner may get here, only the first one unmaps the file.
+void releaseMapping(Mapping* mapping) {
+    if (!mapping->unmapped.exchange(true)) unmapFile(mapping);
+}
+
+} // namespace
+
+extern "C" {
+
+KInt Kotlin_MappedFile_openImpl(KRef thiz, KConstRef path) {
+    auto* mapping = konanConstructInstance<Mapping>();
+    char* cpath = CreateCStringFromString(path);
+    int error = mapFile(mapping, cpath);
+    DisposeCString(cpath);
+    if (error != 0) {
+        konanDestructInstance(mapping);
+        return error;
+    }
+    auto* file = asMappedFile(thiz);
+    file->address = mapping->address;
+    file->size = mapping->size;
+    file->mapping = mapping;
+    return 0;
+}
+
+void Kotlin_MappedFile_close(KRef thiz) {
+    // A frozen file may be read from several threads, so none of them may unmap it.
+    MutationCheck(thiz);
+    auto* file = asMappedFile(thiz);
+    if (file->closed) return;
+    // The mapping record itself is disposed by the cleaner.
+    releaseMapping(file->mapping);
+    file->address = nullptr;
+    file->size = 0;
+    file->closed = true;
+}
+
+void Kotlin_MappedFile_disposeMapping(KNativePtr mapping) {
+    releaseMapping(static_cast<Mapping*>(mapping));
+    konanDestructInstance(static_cast<Mapping*>(mapping));
+}
+
+void Kotlin_MappedFile_adviseImpl(KRef thiz, KInt advice) {
+    auto* file = asMappedFile(thiz);
+    if (file->closed) ThrowIllegalStateException();
+    adviseFile(file->mapping, static_cast<Advice>(advice));
+}
+
+OBJ_GETTER(Kotlin_MappedFile_errorMessage, KInt error) {
+    RETURN_RESULT_OF(errorMessage, error);
+}
+
+KByte Kotlin_MappedFile_get(KRef thiz, KLong index) {
+    return getAt<KByte>(thiz, index);
+}
+
+KShort Kotlin_MappedFile_getShortAt(KRef thiz, KLong index) {
+    return getAt<KShort>(thiz, index);
+}
+
+KInt Kotlin_MappedFile_getIntAt(KRef thiz, KLong index) {
+    return getAt<KInt>(thiz, index);
+}
+
+KLong Kotlin_MappedFile_getLongAt(KRef thiz, KLong index) {
+    return getAt<KLong>(thiz, index);
+}
+
+KFloat Kotlin_MappedFile_getFloatAt(KRef thiz, KLong index) {
+    return getAt<KFloat>(thiz, index);
+}
+
+KDouble Kotlin_MappedFile_getDoubleAt(KRef thiz, KLong index) {
+    return getAt<KDouble>(thiz, index);
+}
+
+void Kotlin_MappedFile_copyIntoImpl(KRef thiz, KRef destination, KInt destinationOffset, KLong startIndex, KLong endIndex) {
+    ArrayHeader* array = destination->array();
+    KLong length = endIndex - startIndex;
+    if (length < 0 || destinationOffset < 0 || static_cast<uint64_t>(destinationOffset) + length > array->count_) {
+        ThrowArrayIndexOutOfBoundsException();
+    }
+    if (length == 0) return;
+    const uint8_t* source = addressAt(thiz, startIndex, length);
+    MutationCheck(destination);
+    memcpy(ByteArrayAddressOfElementAt(array, destinationOffset), source, length);
+}
+
+KNativePtr Kotlin_MappedFile_asCPointerImpl(KRef thiz, KLong offset) {
+    return const_cast<uint8_t*>(addressAt(thiz, offset, 0));
+}
+
+} // extern "C"
@@ -166,6 +166,16 @@ OBJ_GETTER(InitSingleton, ObjHeader** location, const TypeInfo* typeInfo, void (
 // TODO: When global initialization becomes lazy, this signature won't do.
 void InitAndRegisterGlobal(ObjHeader** location, const ObjHeader* initialValue) RUNTIME_NOTHROW;
 
+// States of a file with lazily initialized globals. Must be synchronized with IrToBitcode.kt
+constexpr int32_t FILE_NOT_INITIALIZED = 0;
+constexpr int32_t FILE_INITIALIZED = 1;
+constexpr int32_t FILE_BEING_INITIALIZED = 2;
+
+// Calls `init` to initialize globals of a file, unless it's already initialized or is being initialized
+// by the current thread (i.e. the file initializer, directly or not, accesses its own globals).
+// Other threads wait for the initialization to finish. If `init` throws, the file stays uninitialized.
+void CallInitGlobalPossiblyLock(int32_t* state, void (*init)());
+
 //
 // Object reference management.
 //
@@ -214,6 +224,9 @@ void UpdateStackRef(ObjHeader** location, const ObjHeader* object) RUNTIME_NOTHR
 void UpdateHeapRef(ObjHeader** location, const ObjHeader* object) RUNTIME_NOTHROW;
 // Updates heap/static data in one array.
 void UpdateHeapRefsInsideOneArray(const ArrayHeader* array, int fromIndex, int toIndex, int count) RUNTIME_NOTHROW;
+// Copies references between possibly overlapping heap locations, like `UpdateHeapRef` for each of them would.
+// Only for experimental MM.
+void CopyHeapRefs(ObjHeader** destination, ObjHeader* const* source, int count) RUNTIME_NOTHROW;
 // Updates location if it is null, atomically.
 void UpdateHeapRefIfNull(ObjHeader** location, const ObjHeader* object) RUNTIME_NOTHROW;
 // Updates reference in return slot.
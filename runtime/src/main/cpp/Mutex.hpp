@@ -18,6 +18,9 @@
 #define RUNTIME_MUTEX_H
 
 #include <cstdint>
+#if !KONAN_NO_THREADS
+#include <thread>
+#endif
 
 #include "KAssert.h"
 #include "Utils.hpp"
@@ -28,7 +31,10 @@ class SpinLock : private Pinned {
 public:
     void lock() noexcept {
         while (!__sync_bool_compare_and_swap(&atomicInt, 0, 1)) {
-            // TODO: yield.
+            // With several mutators the holder may have been preempted: let it run instead of burning the time slice.
+#if !KONAN_NO_THREADS
+            std::this_thread::yield();
+#endif
         }
     }
 
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_NODE_CHUNK_H
+#define RUNTIME_NODE_CHUNK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Alloc.h"
+#include "KAssert.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// A fixed-size block of `kSize` bytes that stores values in place. Erasing a value leaves a tombstone: the node is
+// cleared in the liveness bitmap and its index is pushed onto a free stack, so that the next insertion reuses it.
+// Nodes never move, so pointers to them are stable. Live nodes are found by scanning the bitmap a word at a time,
+// and only up to the highest node ever used.
+//
+// Chunks are linked into a `NodeChunkList` by their owner. `Owner` is an optional tag that containers with
+// per-thread chunks use to tell who may modify the chunk.
+template <typename T, typename Owner = void, size_t kSize = 4096>
+class NodeChunk : private Pinned {
+public:
+    class Node : private Pinned {
+    public:
+        T& operator*() noexcept { return *Get(); }
+        T* Get() noexcept { return reinterpret_cast<T*>(&value_); }
+
+        NodeChunk* chunk() noexcept { return chunk_; }
+
+    private:
+        friend class NodeChunk;
+
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type value_;
+        NodeChunk* chunk_;
+    };
+
+    static constexpr size_t kCacheLineSize = 64;
+    // Every node takes its own size, an index on the free stack and a bit in the liveness bitmap.
+    // A cache line is left for the header and for rounding the bitmap up to whole words.
+    static constexpr uint32_t kCapacity = (kSize - 2 * kCacheLineSize) * 8 / (sizeof(Node) * 8 + sizeof(uint16_t) * 8 + 1);
+    static_assert(kSize % kCacheLineSize == 0, "Chunk must consist of whole cache lines");
+    static_assert(kCapacity > 0, "Chunk is too small for T");
+    static_assert(kCapacity <= UINT16_MAX + 1, "Node indices must fit in uint16_t");
+
+    static NodeChunk* Create(Owner* owner = nullptr) noexcept {
+        static_assert(sizeof(NodeChunk) <= kSize, "NodeChunk must fit in kSize");
+        // Not every allocator honours the alignment. This only affects how nodes map onto cache lines.
+        return new (konanAllocAlignedMemory(sizeof(NodeChunk), kCacheLineSize)) NodeChunk(owner);
+    }
+
+    static void Destroy(NodeChunk* chunk) noexcept {
+        for (uint32_t index = chunk->NextLive(0); index < chunk->size_; index = chunk->NextLive(index + 1)) {
+            chunk->nodes_[index].Get()->~T();
+        }
+        chunk->~NodeChunk();
+        konanFreeMemory(chunk);
+    }
+
+    bool full() const noexcept { return freeCount_ == 0 && size_ == kCapacity; }
+    bool empty() const noexcept { return freeCount_ == size_; }
+
+    // Only `Owner` may change the chunk while `owner()` is set.
+    std::atomic<Owner*>& owner() noexcept { return owner_; }
+
+    template <typename... Args>
+    Node* Emplace(Args&&... args) noexcept {
+        RuntimeAssert(!full(), "Chunk is full");
+        uint32_t index = freeCount_ > 0 ? freeIndices_[--freeCount_] : size_++;
+        Node* node = &nodes_[index];
+        new (&node->value_) T(std::forward<Args>(args)...);
+        node->chunk_ = this;
+        live_[index / 64] |= uint64_t(1) << (index % 64);
+        return node;
+    }
+
+    void Erase(Node* node) noexcept {
+        RuntimeAssert(node->chunk_ == this, "Node belongs to another chunk");
+        uint32_t index = static_cast<uint32_t>(node - nodes_);
+        node->Get()->~T();
+        live_[index / 64] &= ~(uint64_t(1) << (index % 64));
+        freeIndices_[freeCount_++] = static_cast<uint16_t>(index);
+    }
+
+    // Index of the first live node at or after `index`, or `end()` if there is none.
+    uint32_t NextLive(uint32_t index) const noexcept {
+        while (index < size_) {
+            uint64_t word = live_[index / 64] >> (index % 64);
+            if (word != 0) return index + __builtin_ctzll(word);
+            index = (index / 64 + 1) * 64;
+        }
+        return size_;
+    }
+
+    uint32_t end() const noexcept { return size_; }
+
+    Node& operator[](uint32_t index) noexcept { return nodes_[index]; }
+
+private:
+    template <typename Chunk>
+    friend class NodeChunkList;
+    template <typename Chunk>
+    friend class NodeChunkIterator;
+
+    explicit NodeChunk(Owner* owner) noexcept : owner_(owner) {}
+
+    ~NodeChunk() = default;
+
+    std::atomic<Owner*> owner_;
+    NodeChunk* previous_ = nullptr;
+    NodeChunk* next_ = nullptr;
+    uint32_t size_ = 0; // Nodes at and after `size_` were never used.
+    uint32_t freeCount_ = 0;
+    uint64_t live_[(kCapacity + 63) / 64] = {};
+    Node nodes_[kCapacity];
+    uint16_t freeIndices_[kCapacity];
+};
+
+// An intrusive doubly linked list of chunks. Chunks with free nodes are kept at the front, full ones at the back,
+// so that insertions only ever have to look at the first chunk.
+template <typename Chunk>
+class NodeChunkList : private MoveOnly {
+public:
+    NodeChunkList() noexcept = default;
+
+    NodeChunkList(NodeChunkList&& rhs) noexcept : first_(rhs.first_), last_(rhs.last_) {
+        rhs.first_ = nullptr;
+        rhs.last_ = nullptr;
+    }
+
+    NodeChunkList& operator=(NodeChunkList&& rhs) noexcept {
+        std::swap(first_, rhs.first_);
+        std::swap(last_, rhs.last_);
+        return *this;
+    }
+
+    ~NodeChunkList() { Clear(); }
+
+    Chunk* first() noexcept { return first_; }
+    bool empty() const noexcept { return first_ == nullptr; }
+    bool single() const noexcept { return first_ != nullptr && first_ == last_; }
+
+    void Insert(Chunk* chunk) noexcept {
+        if (chunk->full()) {
+            chunk->previous_ = last_;
+            chunk->next_ = nullptr;
+            if (last_ != nullptr) {
+                last_->next_ = chunk;
+            } else {
+                first_ = chunk;
+            }
+            last_ = chunk;
+        } else {
+            chunk->previous_ = nullptr;
+            chunk->next_ = first_;
+            if (first_ != nullptr) {
+                first_->previous_ = chunk;
+            } else {
+                last_ = chunk;
+            }
+            first_ = chunk;
+        }
+    }
+
+    void Remove(Chunk* chunk) noexcept {
+        if (chunk->previous_ != nullptr) {
+            chunk->previous_->next_ = chunk->next_;
+        } else {
+            first_ = chunk->next_;
+        }
+        if (chunk->next_ != nullptr) {
+            chunk->next_->previous_ = chunk->previous_;
+        } else {
+            last_ = chunk->previous_;
+        }
+        chunk->previous_ = nullptr;
+        chunk->next_ = nullptr;
+    }
+
+    // Must be called after a change that might have made `chunk` full or not full.
+    void Update(Chunk* chunk, bool wasFull) noexcept {
+        if (chunk->full() == wasFull) return;
+        Remove(chunk);
+        Insert(chunk);
+    }
+
+    // Moves all the chunks of `rhs` to `this`.
+    void Splice(NodeChunkList& rhs) noexcept {
+        while (Chunk* chunk = rhs.first_) {
+            rhs.Remove(chunk);
+            Insert(chunk);
+        }
+    }
+
+    void Clear() noexcept {
+        while (Chunk* chunk = first_) {
+            Remove(chunk);
+            Chunk::Destroy(chunk);
+        }
+    }
+
+private:
+    Chunk* first_ = nullptr;
+    Chunk* last_ = nullptr;
+};
+
+// Visits live nodes of a chain of chunks linked by a `NodeChunkList`.
+template <typename Chunk>
+class NodeChunkIterator {
+public:
+    explicit NodeChunkIterator(Chunk* chunk) noexcept : chunk_(chunk), index_(chunk != nullptr ? chunk->NextLive(0) : 0) {
+        SkipExhaustedChunks();
+    }
+
+    typename Chunk::Node& operator*() noexcept { return (*chunk_)[index_]; }
+
+    NodeChunkIterator& operator++() noexcept {
+        index_ = chunk_->NextLive(index_ + 1);
+        SkipExhaustedChunks();
+        return *this;
+    }
+
+    bool operator==(const NodeChunkIterator& rhs) const noexcept { return chunk_ == rhs.chunk_ && index_ == rhs.index_; }
+
+    bool operator!=(const NodeChunkIterator& rhs) const noexcept { return !(*this == rhs); }
+
+private:
+    void SkipExhaustedChunks() noexcept {
+        while (chunk_ != nullptr && index_ == chunk_->end()) {
+            chunk_ = chunk_->next_;
+            index_ = chunk_ != nullptr ? chunk_->NextLive(0) : 0;
+        }
+    }
+
+    Chunk* chunk_;
+    uint32_t index_;
+};
+
+} // namespace kotlin
+
+#endif // RUNTIME_NODE_CHUNK_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_NUMBER_FORMATTING_H
+#define RUNTIME_NUMBER_FORMATTING_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kotlin {
+
+// Large enough for any Int, Long, Float or Double in the Kotlin `toString` format, including the sign.
+constexpr size_t kMaxNumberStringLength = 32;
+
+namespace internal {
+
+extern const char kDigitPairs[200];
+
+inline uint32_t DecimalLength(uint64_t value) {
+    uint32_t length = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        length += 4;
+    }
+    if (value >= 1000) return length + 3;
+    if (value >= 100) return length + 2;
+    if (value >= 10) return length + 1;
+    return length;
+}
+
+// Writes the digits of `value` so that the last one lands right before `end`, two digits at a time.
+template <typename Char>
+void WriteDigitsBackwards(uint64_t value, Char* end) {
+    while (value >= 100) {
+        uint32_t pair = static_cast<uint32_t>(value % 100) * 2;
+        value /= 100;
+        *--end = kDigitPairs[pair + 1];
+        *--end = kDigitPairs[pair];
+    }
+    if (value >= 10) {
+        uint32_t pair = static_cast<uint32_t>(value) * 2;
+        *--end = kDigitPairs[pair + 1];
+        *--end = kDigitPairs[pair];
+    } else {
+        *--end = static_cast<Char>('0' + value);
+    }
+}
+
+} // namespace internal
+
+// Number of characters `FormatInteger` writes for `value`.
+inline size_t FormattedIntegerLength(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    return internal::DecimalLength(magnitude) + (value < 0 ? 1 : 0);
+}
+
+// Writes the decimal representation of `value` into `buffer` without a terminating zero. Returns the number
+// of characters written, which is always `FormattedIntegerLength(value)`.
+template <typename Char>
+size_t FormatInteger(int64_t value, Char* buffer) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    size_t length = internal::DecimalLength(magnitude);
+    if (value < 0) {
+        *buffer++ = '-';
+    }
+    internal::WriteDigitsBackwards(magnitude, buffer + length);
+    return length + (value < 0 ? 1 : 0);
+}
+
+// Writes the shortest representation of `value` that reads back to the same `Double` into `buffer`,
+// laid out the same way as `Double.toString` on the JVM (e.g. "1.0", "0.001", "1.0E7", "4.9E-324", "NaN").
+// `buffer` must hold at least `kMaxNumberStringLength` characters; no terminating zero is written.
+size_t FormatDouble(double value, char* buffer);
+
+// Same as `FormatDouble` for `Float`: the digits are the shortest ones that read back to the same `Float`.
+size_t FormatFloat(float value, char* buffer);
+
+} // namespace kotlin
+
+#endif // RUNTIME_NUMBER_FORMATTING_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "NumberFormatting.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+std::string FormatIntegerToString(int64_t value) {
+    char buffer[kMaxNumberStringLength];
+    size_t length = FormatInteger(value, buffer);
+    EXPECT_EQ(length, FormattedIntegerLength(value));
+    return std::string(buffer, length);
+}
+
+std::string FormatDoubleToString(double value) {
+    char buffer[kMaxNumberStringLength];
+    return std::string(buffer, FormatDouble(value, buffer));
+}
+
+std::string FormatFloatToString(float value) {
+    char buffer[kMaxNumberStringLength];
+    return std::string(buffer, FormatFloat(value, buffer));
+}
+
+} // namespace
+
+TEST(NumberFormattingTest, Integers) {
+    EXPECT_EQ(FormatIntegerToString(0), "0");
+    EXPECT_EQ(FormatIntegerToString(7), "7");
+    EXPECT_EQ(FormatIntegerToString(-7), "-7");
+    EXPECT_EQ(FormatIntegerToString(10), "10");
+    EXPECT_EQ(FormatIntegerToString(99), "99");
+    EXPECT_EQ(FormatIntegerToString(100), "100");
+    EXPECT_EQ(FormatIntegerToString(1122334455), "1122334455");
+    EXPECT_EQ(FormatIntegerToString(112233445566778899), "112233445566778899");
+    EXPECT_EQ(FormatIntegerToString(std::numeric_limits<int32_t>::min()), "-2147483648");
+    EXPECT_EQ(FormatIntegerToString(std::numeric_limits<int64_t>::max()), "9223372036854775807");
+    EXPECT_EQ(FormatIntegerToString(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+}
+
+TEST(NumberFormattingTest, IntegersToUtf16) {
+    KChar buffer[kMaxNumberStringLength];
+    size_t length = FormatInteger(-1234567, buffer);
+    ASSERT_EQ(length, 8u);
+    EXPECT_EQ(std::u16string(reinterpret_cast<char16_t*>(buffer), length), u"-1234567");
+}
+
+TEST(NumberFormattingTest, DoubleSpecialValues) {
+    EXPECT_EQ(FormatDoubleToString(0.0), "0.0");
+    EXPECT_EQ(FormatDoubleToString(-0.0), "-0.0");
+    EXPECT_EQ(FormatDoubleToString(std::numeric_limits<double>::quiet_NaN()), "NaN");
+    EXPECT_EQ(FormatDoubleToString(std::numeric_limits<double>::infinity()), "Infinity");
+    EXPECT_EQ(FormatDoubleToString(-std::numeric_limits<double>::infinity()), "-Infinity");
+    EXPECT_EQ(FormatDoubleToString(std::numeric_limits<double>::denorm_min()), "4.9E-324");
+    EXPECT_EQ(FormatDoubleToString(std::numeric_limits<double>::min()), "2.2250738585072014E-308");
+    EXPECT_EQ(FormatDoubleToString(std::numeric_limits<double>::max()), "1.7976931348623157E308");
+}
+
+TEST(NumberFormattingTest, DoubleLayout) {
+    EXPECT_EQ(FormatDoubleToString(1.0), "1.0");
+    EXPECT_EQ(FormatDoubleToString(-1.5), "-1.5");
+    EXPECT_EQ(FormatDoubleToString(100.0), "100.0");
+    EXPECT_EQ(FormatDoubleToString(3.14159265358), "3.14159265358");
+    EXPECT_EQ(FormatDoubleToString(9999999.0), "9999999.0");
+    EXPECT_EQ(FormatDoubleToString(1e7), "1.0E7");
+    EXPECT_EQ(FormatDoubleToString(1.5e300), "1.5E300");
+    EXPECT_EQ(FormatDoubleToString(0.001), "0.001");
+    EXPECT_EQ(FormatDoubleToString(0.00099), "9.9E-4");
+    EXPECT_EQ(FormatDoubleToString(1e-300), "1.0E-300");
+}
+
+TEST(NumberFormattingTest, DoubleShortest) {
+    EXPECT_EQ(FormatDoubleToString(0.1), "0.1");
+    EXPECT_EQ(FormatDoubleToString(0.3), "0.3");
+    EXPECT_EQ(FormatDoubleToString(0.1 + 0.2), "0.30000000000000004");
+    EXPECT_EQ(FormatDoubleToString(2.0 / 3), "0.6666666666666666");
+    EXPECT_EQ(FormatDoubleToString(1e23), "1.0E23");
+    EXPECT_EQ(FormatDoubleToString(9007199254740993.0), "9.007199254740992E15");
+}
+
+TEST(NumberFormattingTest, DoubleRoundTrip) {
+    uint64_t bits = 0x123456789ABCDEFULL;
+    for (int i = 0; i < 100000; ++i) {
+        bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value) continue;
+        std::string string = FormatDoubleToString(value);
+        EXPECT_EQ(strtod(string.c_str(), nullptr), value) << string;
+    }
+}
+
+TEST(NumberFormattingTest, Float) {
+    EXPECT_EQ(FormatFloatToString(0.0f), "0.0");
+    EXPECT_EQ(FormatFloatToString(-0.0f), "-0.0");
+    EXPECT_EQ(FormatFloatToString(std::numeric_limits<float>::quiet_NaN()), "NaN");
+    EXPECT_EQ(FormatFloatToString(-std::numeric_limits<float>::infinity()), "-Infinity");
+    EXPECT_EQ(FormatFloatToString(std::numeric_limits<float>::denorm_min()), "1.4E-45");
+    EXPECT_EQ(FormatFloatToString(std::numeric_limits<float>::max()), "3.4028235E38");
+    EXPECT_EQ(FormatFloatToString(1.0f), "1.0");
+    EXPECT_EQ(FormatFloatToString(0.1f), "0.1");
+    EXPECT_EQ(FormatFloatToString(1e27f), "1.0E27");
+    EXPECT_EQ(FormatFloatToString(16777216.0f), "1.6777216E7");
+}
+
+TEST(NumberFormattingTest, FloatRoundTrip) {
+    for (uint32_t bits = 0; bits < 0x7F800000u; bits += 0x1003) {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        std::string string = FormatFloatToString(value);
+        EXPECT_EQ(strtof(string.c_str(), nullptr), value) << string;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_NUMBER_PARSING_H
+#define RUNTIME_NUMBER_PARSING_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kotlin {
+
+namespace internal {
+
+// Converts `mantissa * 10^exponent` to the nearest `Double`/`Float`. Returns false when the result can't be
+// proven to be correctly rounded (or is subnormal, zero or infinite) and the caller has to fall back to exact
+// arithmetic.
+bool EiselLemire(uint64_t mantissa, int64_t exponent, double* result);
+bool EiselLemire(uint64_t mantissa, int64_t exponent, float* result);
+
+} // namespace internal
+
+// Fast path for parsing a positive decimal number given as a string of decimal `digits` and a decimal `exponent`,
+// so that the value is `digits * 10^exponent`. Returns false if the digits are malformed or the fast path can't
+// guarantee the correctly rounded result; `result` is left intact in that case.
+template <typename Char, typename Result>
+bool TryParseDecimal(const Char* digits, size_t length, int32_t exponent, Result* result) {
+    constexpr size_t kMaxMantissaDigits = 19;
+    if (length == 0) return false;
+
+    uint64_t mantissa = 0;
+    size_t i = 0;
+    for (; i < length && i < kMaxMantissaDigits; ++i) {
+        uint32_t digit = static_cast<uint32_t>(digits[i]) - '0';
+        if (digit > 9) return false;
+        mantissa = mantissa * 10 + digit;
+    }
+    int64_t adjustedExponent = exponent;
+    bool truncated = false;
+    for (; i < length; ++i) {
+        uint32_t digit = static_cast<uint32_t>(digits[i]) - '0';
+        if (digit > 9) return false;
+        truncated |= digit != 0;
+        ++adjustedExponent;
+    }
+
+    Result value;
+    if (!internal::EiselLemire(mantissa, adjustedExponent, &value)) return false;
+    if (truncated) {
+        // The exact value lies between the truncated mantissa and the next one, both must round the same way.
+        Result upper;
+        if (!internal::EiselLemire(mantissa + 1, adjustedExponent, &upper) || upper != value) return false;
+    }
+    *result = value;
+    return true;
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_NUMBER_PARSING_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "NumberParsing.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace kotlin;
+
+namespace {
+
+template <typename Result>
+bool Parse(const std::string& digits, int32_t exponent, Result* result) {
+    return TryParseDecimal(digits.data(), digits.size(), exponent, result);
+}
+
+} // namespace
+
+TEST(NumberParsingTest, SimpleDoubles) {
+    double result = 0;
+    ASSERT_TRUE(Parse("1", 0, &result));
+    EXPECT_EQ(result, 1.0);
+    ASSERT_TRUE(Parse("12345", -2, &result));
+    EXPECT_EQ(result, 123.45);
+    ASSERT_TRUE(Parse("1", -1, &result));
+    EXPECT_EQ(result, 0.1);
+    ASSERT_TRUE(Parse("17976931348623157", 292, &result));
+    EXPECT_EQ(result, 1.7976931348623157e308);
+    ASSERT_TRUE(Parse("22250738585072014", -324, &result));
+    EXPECT_EQ(result, 2.2250738585072014e-308);
+}
+
+TEST(NumberParsingTest, SimpleFloats) {
+    float result = 0;
+    ASSERT_TRUE(Parse("1", 0, &result));
+    EXPECT_EQ(result, 1.0f);
+    ASSERT_TRUE(Parse("3", -1, &result));
+    EXPECT_EQ(result, 0.3f);
+    ASSERT_TRUE(Parse("34028235", 31, &result));
+    EXPECT_EQ(result, 3.4028235e38f);
+}
+
+TEST(NumberParsingTest, Malformed) {
+    double result = 42;
+    EXPECT_FALSE(Parse("", 0, &result));
+    EXPECT_FALSE(Parse("12a", 0, &result));
+    EXPECT_FALSE(Parse("1.5", 0, &result));
+    EXPECT_FALSE(Parse("12345678901234567890x", 0, &result));
+    EXPECT_EQ(result, 42);
+}
+
+TEST(NumberParsingTest, OutOfFastPathRange) {
+    double result = 42;
+    // Subnormal.
+    EXPECT_FALSE(Parse("5", -324, &result));
+    // Overflow.
+    EXPECT_FALSE(Parse("2", 308, &result));
+    EXPECT_EQ(result, 42);
+    float floatResult = 42;
+    EXPECT_FALSE(Parse("14", -46, &floatResult));
+    EXPECT_FALSE(Parse("4", 38, &floatResult));
+    EXPECT_EQ(floatResult, 42);
+}
+
+TEST(NumberParsingTest, LongMantissa) {
+    double result = 0;
+    ASSERT_TRUE(Parse("123456789012345678901234567890", -29, &result));
+    EXPECT_EQ(result, 1.2345678901234567890123456789);
+    // Exactly halfway between 2^53 and 2^53 + 2, and a truncated mantissa that is just above it.
+    EXPECT_FALSE(Parse("9007199254740993", 0, &result));
+    EXPECT_FALSE(Parse("90071992547409930000000001", -10, &result));
+}
+
+TEST(NumberParsingTest, MatchesStrtod) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 16;
+    };
+    for (int i = 0; i < 100000; ++i) {
+        std::string digits;
+        size_t length = 1 + next() % 22;
+        for (size_t j = 0; j < length; ++j) {
+            digits += static_cast<char>('0' + next() % 10);
+        }
+        int32_t exponent = static_cast<int32_t>(next() % 660) - 340;
+        std::string string = digits + "e" + std::to_string(exponent);
+
+        double doubleResult;
+        if (Parse(digits, exponent, &doubleResult)) {
+            EXPECT_EQ(doubleResult, strtod(string.c_str(), nullptr)) << string;
+        }
+        float floatResult;
+        if (Parse(digits, exponent, &floatResult)) {
+            EXPECT_EQ(floatResult, strtof(string.c_str(), nullptr)) << string;
+        }
+    }
+}
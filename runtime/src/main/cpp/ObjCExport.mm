@@ -41,6 +41,7 @@
 #import "ObjCExportPrivate.h"
 #import "ObjCMMAPI.h"
 #import "Runtime.h"
+#import "WritableTypeInfo.hpp"
 #import "Mutex.hpp"
 #import "Exceptions.h"
 
@@ -90,17 +91,6 @@ struct ObjCTypeAdapter {
 typedef id (*convertReferenceToObjC)(ObjHeader* obj);
 typedef OBJ_GETTER((*convertReferenceFromObjC), id obj);
 
-struct TypeInfoObjCExportAddition {
-  /*convertReferenceToObjC*/ void* convert;
-  Class objCClass;
-  const ObjCTypeAdapter* typeAdapter;
-};
-
-struct WritableTypeInfo {
-  TypeInfoObjCExportAddition objCExport;
-};
-
-
 static char associatedTypeInfoKey;
 
 extern "C" const TypeInfo* Kotlin_ObjCExport_getAssociatedTypeInfo(Class clazz) {
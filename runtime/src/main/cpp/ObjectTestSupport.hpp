@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_OBJECT_TEST_SUPPORT_H
+#define RUNTIME_OBJECT_TEST_SUPPORT_H
+
+#include <array>
+#include <cstdint>
+
+#include "Memory.h"
+#include "TypeInfo.h"
+#include "Types.h"
+#include "Utils.hpp"
+#include "WritableTypeInfo.hpp"
+
+namespace kotlin {
+namespace test_support {
+
+// An object with `Count` reference fields and a type of its own, which is not allocated by a memory manager.
+template <size_t Count>
+class Object : private Pinned {
+public:
+    Object() {
+        header_.typeInfoOrMeta_ = &type_;
+        type_.typeInfo_ = &type_;
+        type_.instanceSize_ = sizeof(Object);
+        type_.objOffsetsCount_ = Count;
+        type_.objOffsets_ = fieldOffsets_.data();
+        for (size_t i = 0; i < Count; ++i) {
+            fieldOffsets_[i] = reinterpret_cast<uintptr_t>(&fields_[i]) - reinterpret_cast<uintptr_t>(&header_);
+        }
+    }
+
+    // Makes this object have the type of `other`.
+    explicit Object(Object& other) : Object() { header_.typeInfoOrMeta_ = &other.type_; }
+
+    ObjHeader* header() { return &header_; }
+
+    // The type created for this object. `header()` may have the type of another object.
+    TypeInfo& type() { return type_; }
+
+    int32_t offset(size_t index) { return fieldOffsets_[index]; }
+
+    ObjHeader*& operator[](size_t index) { return fields_[index]; }
+
+private:
+    ObjHeader header_;
+    TypeInfo type_{};
+    std::array<int32_t, Count> fieldOffsets_;
+    std::array<ObjHeader*, Count> fields_{};
+};
+
+// An array of `Count` references, which is not allocated by a memory manager.
+template <size_t Count>
+class Array : private Pinned {
+public:
+    explicit Array(const TypeInfo* type = theArrayTypeInfo) {
+        header_.typeInfoOrMeta_ = const_cast<TypeInfo*>(type);
+        header_.count_ = Count;
+    }
+
+    ObjHeader* header() { return header_.obj(); }
+
+    ObjHeader*& operator[](size_t index) { return fields_[index]; }
+
+private:
+    ArrayHeader header_;
+    std::array<ObjHeader*, Count> fields_{};
+};
+
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+// A type with a writable part, which allocation counters of TypeCounters.hpp can be attached to. Counters are never
+// destroyed, so these types must outlive the tests.
+struct CountedType : private Pinned {
+    explicit CountedType(int32_t instanceSize) {
+        typeInfo.typeInfo_ = &typeInfo;
+        typeInfo.instanceSize_ = instanceSize;
+        typeInfo.writableInfo_ = &writableInfo;
+    }
+
+    TypeInfo typeInfo{};
+    WritableTypeInfo writableInfo{};
+};
+
+#endif // KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+} // namespace test_support
+} // namespace kotlin
+
+#endif // RUNTIME_OBJECT_TEST_SUPPORT_H
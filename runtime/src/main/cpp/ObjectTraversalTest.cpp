@@ -8,56 +8,19 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "ObjectTestSupport.hpp"
 #include "Types.h"
 #include "Utils.hpp"
 
 using namespace kotlin;
 
+using test_support::Array;
+using test_support::Object;
+
 using ::testing::_;
 
 namespace {
 
-template <size_t Count>
-class Object : private Pinned {
-public:
-    Object() {
-        header_.typeInfoOrMeta_ = &type_;
-        type_.typeInfo_ = &type_;
-        type_.objOffsetsCount_ = Count;
-        type_.objOffsets_ = fieldOffsets_.data();
-        for (size_t i = 0; i < Count; ++i) {
-            fieldOffsets_[i] = reinterpret_cast<uintptr_t>(&fields_[i]) - reinterpret_cast<uintptr_t>(&header_);
-        }
-    }
-
-    ObjHeader* header() { return &header_; }
-
-    ObjHeader*& operator[](size_t index) { return fields_[index]; }
-
-private:
-    ObjHeader header_;
-    TypeInfo type_;
-    std::array<int32_t, Count> fieldOffsets_;
-    std::array<ObjHeader*, Count> fields_{};
-};
-
-template <size_t Count>
-class Array : private Pinned {
-public:
-    Array() {
-        header_.typeInfoOrMeta_ = const_cast<TypeInfo*>(theArrayTypeInfo);
-        header_.count_ = Count;
-    }
-
-    ObjHeader* header() { return header_.obj(); }
-
-    ObjHeader*& operator[](size_t index) { return fields_[index]; }
-
-private:
-    ArrayHeader header_;
-    std::array<ObjHeader*, Count> fields_{};
-};
-
 struct CallableWithExceptions {
     void operator()(ObjHeader*) noexcept(false) {}
     void operator()(ObjHeader**) noexcept(false) {}
@@ -26,6 +26,7 @@
 #include <pthread.h>
 #endif
 #include <unistd.h>
+#include <errno.h>
 #if KONAN_WINDOWS
 #include <windows.h>
 #endif
@@ -45,6 +46,112 @@ extern "C" RUNTIME_NORETURN void Konan_exit(int32_t status);
 extern "C" size_t strnlen(const char* buffer, size_t maxSize);
 #endif
 
+// Android sends every write to logcat as a separate entry, and WASM and Zephyr hand it to the host, so
+// only buffer standard output where it is a file descriptor.
+#if KONAN_ANDROID || KONAN_WASM || KONAN_ZEPHYR
+#define KONAN_BUFFERED_CONSOLE 0
+#else
+#define KONAN_BUFFERED_CONSOLE 1
+#endif
+
+#if KONAN_BUFFERED_CONSOLE
+namespace {
+
+void writeFully(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    data += written;
+    size -= written;
+  }
+}
+
+void flushConsoleOutputAtExit();
+
+// Standard output buffer shared by all threads. Like C stdio, it is line buffered when stdout is
+// a terminal and fully buffered otherwise. It is flushed before writing to stderr, before reading
+// stdin, on explicit flush and at exit.
+class ConsoleOutput {
+ public:
+  void write(const char* data, uint32_t size) {
+    lock();
+    if (!initialized_) initializeLocked();
+    if (size > kCapacity - size_) {
+      flushLocked();
+      if (size >= kCapacity) {
+        writeFully(STDOUT_FILENO, data, size);
+        unlock();
+        return;
+      }
+    }
+    ::memcpy(buffer_ + size_, data, size);
+    size_ += size;
+    if (lineBuffered_ && ::memchr(data, '\n', size) != nullptr) flushLocked();
+    unlock();
+  }
+
+  void flush() {
+    lock();
+    flushLocked();
+    unlock();
+  }
+
+  // Used on abnormal termination, when the lock may be held by the failing thread itself.
+  void tryFlush() {
+#if !KONAN_NO_THREADS
+    if (pthread_mutex_trylock(&lock_) != 0) return;
+#endif
+    flushLocked();
+    unlock();
+  }
+
+ private:
+  static constexpr uint32_t kCapacity = 16 * 1024;
+
+  void initializeLocked() {
+    lineBuffered_ = ::isatty(STDOUT_FILENO);
+    ::atexit(flushConsoleOutputAtExit);
+    initialized_ = true;
+  }
+
+  void flushLocked() {
+    writeFully(STDOUT_FILENO, buffer_, size_);
+    size_ = 0;
+  }
+
+  void lock() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_lock(&lock_);
+#endif
+  }
+
+  void unlock() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_unlock(&lock_);
+#endif
+  }
+
+#if !KONAN_NO_THREADS
+  pthread_mutex_t lock_ = PTHREAD_MUTEX_INITIALIZER;
+#endif
+  bool initialized_ = false;
+  bool lineBuffered_ = false;
+  uint32_t size_ = 0;
+  char buffer_[kCapacity] = {};
+};
+
+ConsoleOutput consoleOutput_;
+
+void flushConsoleOutputAtExit() {
+  consoleOutput_.flush();
+}
+
+}  // namespace
+#endif  // KONAN_BUFFERED_CONSOLE
+
 namespace konan {
 
 // Console operations.
@@ -63,6 +170,8 @@ void consoleWriteUtf8(const void* utf8, uint32_t sizeBytes) {
 #ifdef KONAN_ANDROID
   // TODO: use sizeBytes!
   __android_log_print(ANDROID_LOG_INFO, "Konan_main", "%s", utf8);
+#elif KONAN_BUFFERED_CONSOLE
+  consoleOutput_.write(reinterpret_cast<const char*>(utf8), sizeBytes);
 #else
   ::write(STDOUT_FILENO, utf8, sizeBytes);
 #endif
@@ -73,6 +182,10 @@ void consoleErrorUtf8(const void* utf8, uint32_t sizeBytes) {
   // TODO: use sizeBytes!
   __android_log_print(ANDROID_LOG_ERROR, "Konan_main", "%s", utf8);
 #else
+#if KONAN_BUFFERED_CONSOLE
+  // Keep the order of interleaved stdout and stderr output.
+  consoleOutput_.flush();
+#endif
   ::write(STDERR_FILENO, utf8, sizeBytes);
 #endif
 }
@@ -92,6 +205,10 @@ int getLastErrorMessage(char* message, uint32_t size) {
 #endif
 
 int32_t consoleReadUtf8(void* utf8, uint32_t maxSizeBytes) {
+#if KONAN_BUFFERED_CONSOLE
+  // Make sure prompts are visible before blocking on input.
+  consoleOutput_.flush();
+#endif
 #ifdef KONAN_ZEPHYR
   return 0;
 #elif KONAN_WINDOWS
@@ -141,6 +258,96 @@ int32_t consoleReadUtf8(void* utf8, uint32_t maxSizeBytes) {
   return length;
 }
 
+#if !KONAN_ZEPHYR
+namespace {
+
+// Standard input buffer. Reads big blocks and scans them for line ends, so lines have no length limit
+// and reading a piped file takes one syscall per block rather than one per line.
+class ConsoleInput {
+ public:
+  bool readLine(void (*consumer)(const char* utf8, uint32_t sizeBytes, bool last, void* context), void* context) {
+    lock();
+    bool readAnything = false;
+    while (true) {
+      if (position_ == limit_ && !fill()) break;
+      readAnything = true;
+      const char* start = buffer_ + position_;
+      uint32_t available = limit_ - position_;
+      auto* lineEnd = reinterpret_cast<const char*>(::memchr(start, '\n', available));
+      if (lineEnd != nullptr) {
+        uint32_t size = lineEnd - start;
+        consumer(start, size, true, context);
+        position_ += size + 1;
+        break;
+      }
+      consumer(start, available, false, context);
+      position_ = limit_;
+    }
+    unlock();
+    return readAnything;
+  }
+
+ private:
+  static constexpr uint32_t kCapacity = 64 * 1024;
+
+  bool fill() {
+    while (true) {
+      auto result = ::read(STDIN_FILENO, buffer_, kCapacity);
+      if (result < 0 && errno == EINTR) continue;
+      if (result <= 0) return false;
+      position_ = 0;
+      limit_ = result;
+      return true;
+    }
+  }
+
+  void lock() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_lock(&lock_);
+#endif
+  }
+
+  void unlock() {
+#if !KONAN_NO_THREADS
+    pthread_mutex_unlock(&lock_);
+#endif
+  }
+
+#if !KONAN_NO_THREADS
+  pthread_mutex_t lock_ = PTHREAD_MUTEX_INITIALIZER;
+#endif
+  uint32_t position_ = 0;
+  uint32_t limit_ = 0;
+  char buffer_[kCapacity] = {};
+};
+
+ConsoleInput consoleInput_;
+
+}  // namespace
+#endif  // !KONAN_ZEPHYR
+
+bool consoleReadLineUtf8(void (*consumer)(const char* utf8, uint32_t sizeBytes, bool last, void* context), void* context) {
+#if KONAN_ZEPHYR
+  return false;
+#else
+#if KONAN_BUFFERED_CONSOLE
+  // Make sure prompts are visible before blocking on input.
+  consoleOutput_.flush();
+#endif
+#if KONAN_WINDOWS
+  // Interactive console input arrives in UTF-16 and line by line anyway.
+  if (::GetFileType(::GetStdHandle(STD_INPUT_HANDLE)) == FILE_TYPE_CHAR) {
+    char data[4096];
+    auto length = consoleReadUtf8(data, sizeof(data));
+    if (length < 0) return false;
+    consumer(data, length, true, context);
+    return true;
+  }
+#endif
+  return consoleInput_.readLine(consumer, context);
+#endif
+}
+
 #if KONAN_INTERNAL_SNPRINTF
 extern "C" int rpl_vsnprintf(char *, size_t, const char *, va_list);
 #define vsnprintf_impl rpl_vsnprintf
@@ -172,6 +379,9 @@ void consoleErrorf(const char* format, ...) {
 }
 
 void consoleFlush() {
+#if KONAN_BUFFERED_CONSOLE
+  consoleOutput_.flush();
+#endif
   ::fflush(stdout);
   ::fflush(stderr);
 }
@@ -240,6 +450,9 @@ void onThreadExit(void (*destructor)(void*), void* destructorParameter) {
 
 // Process execution.
 void abort(void) {
+#if KONAN_BUFFERED_CONSOLE
+  consoleOutput_.tryFlush();
+#endif
   ::abort();
 }
 
@@ -33,6 +33,11 @@ void consoleWriteUtf8(const void* utf8, uint32_t sizeBytes);
 void consoleErrorUtf8(const void* utf8, uint32_t sizeBytes);
 // Negative return value denotes that read wasn't successful.
 int32_t consoleReadUtf8(void* utf8, uint32_t maxSizeBytes);
+// Reads a line from the standard input and passes it to `consumer` in one or more chunks, without the line feed.
+// `last` is set for the chunk that ends the line, it is never set if the input ends in the middle of a line.
+// Chunks point into the input buffer, which is locked while `consumer` runs.
+// Returns false if the input has ended before anything was read.
+bool consoleReadLineUtf8(void (*consumer)(const char* utf8, uint32_t sizeBytes, bool last, void* context), void* context);
 void consoleFlush();
 
 // Process control.
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <cstring>
 #include "Types.h"
 #include "KString.h"
@@ -540,17 +541,119 @@ constexpr Decomposition decompositionValues[] = {
   {{40709}, 1}, {{40719}, 1}, {{40726}, 1}, {{40763}, 1}, {{173568}, 1}
 };
 
+/*
+ * Two-stage lookup tables over the sorted key arrays above, built at compile time.
+ * A code point is split into a block number (high bits) and an offset in the block (low bits).
+ * The first stage maps a block number to a block in the second stage, blocks without keys share
+ * the empty block 0. This gives O(1) lookup instead of a binary search per code point.
+ */
+constexpr int kBlockShift = 8;
+constexpr int kBlockSize = 1 << kBlockShift;
+constexpr int kBlockMask = kBlockSize - 1;
+
+template <size_t N>
+constexpr size_t countBlocks(const KInt (&keys)[N]) {
+  size_t result = 0;
+  KInt lastBlock = -1;
+  for (size_t i = 0; i < N; i++) {
+    KInt block = keys[i] >> kBlockShift;
+    if (block != lastBlock) {
+      result++;
+      lastBlock = block;
+    }
+  }
+  return result;
+}
+
+template <size_t N>
+constexpr KInt lastKey(const KInt (&keys)[N]) {
+  return keys[N - 1];
+}
+
+// Maps a code point to the index of the same code point in a sorted key array.
+template <size_t BlockCount, KInt MaxKey>
+class CodePointIndex {
+ public:
+  template <size_t N>
+  constexpr explicit CodePointIndex(const KInt (&keys)[N]) : blocks_(), entries_() {
+    static_assert(N < 0xFFFF, "Key indices must fit into uint16_t");
+    uint16_t blockCount = 0;
+    KInt lastBlock = -1;
+    for (size_t i = 0; i < N; i++) {
+      KInt block = keys[i] >> kBlockShift;
+      if (block != lastBlock) {
+        blocks_[block] = ++blockCount;
+        lastBlock = block;
+      }
+      entries_[blocks_[block] * kBlockSize + (keys[i] & kBlockMask)] = static_cast<uint16_t>(i + 1);
+    }
+  }
+
+  // Returns the index of the code point in the keys array or -1 if it is absent.
+  int find(KInt codePoint) const {
+    if (static_cast<uint32_t>(codePoint) > static_cast<uint32_t>(MaxKey)) {
+      return -1;
+    }
+    return static_cast<int>(entries_[blocks_[codePoint >> kBlockShift] * kBlockSize + (codePoint & kBlockMask)]) - 1;
+  }
+
+ private:
+  uint16_t blocks_[(MaxKey >> kBlockShift) + 1];
+  uint16_t entries_[(BlockCount + 1) * kBlockSize];
+};
+
+// Same as CodePointIndex but only answers whether a code point is present, using a bit per code point.
+template <size_t BlockCount, KInt MaxKey>
+class CodePointSet {
+ public:
+  template <size_t N>
+  constexpr explicit CodePointSet(const KInt (&keys)[N]) : blocks_(), bits_() {
+    uint16_t blockCount = 0;
+    KInt lastBlock = -1;
+    for (size_t i = 0; i < N; i++) {
+      KInt block = keys[i] >> kBlockShift;
+      if (block != lastBlock) {
+        blocks_[block] = ++blockCount;
+        lastBlock = block;
+      }
+      size_t bit = blocks_[block] * kBlockSize + (keys[i] & kBlockMask);
+      bits_[bit / 32] |= 1u << (bit % 32);
+    }
+  }
+
+  bool contains(KInt codePoint) const {
+    if (static_cast<uint32_t>(codePoint) > static_cast<uint32_t>(MaxKey)) {
+      return false;
+    }
+    size_t bit = blocks_[codePoint >> kBlockShift] * kBlockSize + (codePoint & kBlockMask);
+    return (bits_[bit / 32] >> (bit % 32)) & 1;
+  }
+
+ private:
+  uint16_t blocks_[(MaxKey >> kBlockShift) + 1];
+  uint32_t bits_[(BlockCount + 1) * kBlockSize / 32];
+};
+
+constexpr CodePointIndex<countBlocks(canonicalClassesKeys), lastKey(canonicalClassesKeys)>
+    canonicalClassesIndex(canonicalClassesKeys);
+
+constexpr CodePointIndex<countBlocks(decompositionKeys), lastKey(decompositionKeys)>
+    decompositionIndex(decompositionKeys);
+
+constexpr CodePointSet<countBlocks(singleDecompositions), lastKey(singleDecompositions)>
+    singleDecompositionsSet(singleDecompositions);
+
 KInt getCanonicalClass(KInt ch) {
-  int index = binarySearchRange(canonicalClassesKeys, ARRAY_SIZE(canonicalClassesKeys), ch);
-  if (canonicalClassesKeys[index] != ch) {
+  int index = canonicalClassesIndex.find(ch);
+  if (index < 0) {
     return 0;
   }
   return canonicalClassesValues[index];
 }
 
 const Decomposition* getDecomposition(KInt codePoint) {
-  int index = binarySearchRange(decompositionKeys, ARRAY_SIZE(decompositionKeys), codePoint);
-  if (decompositionKeys[index] != codePoint) {
+  int index = decompositionIndex.find(codePoint);
+  if (index < 0) {
     return nullptr;
   }
   return &decompositionValues[index];
@@ -565,8 +668,7 @@ KInt Kotlin_text_regex_getCanonicalClassInternal(KInt ch) {
 }
 
 KBoolean Kotlin_text_regex_hasSingleCodepointDecompositionInternal(KInt ch) {
-  int index = binarySearchRange(singleDecompositions, ARRAY_SIZE(singleDecompositions), ch);
-  return singleDecompositions[index] == ch;
+  return singleDecompositionsSet.contains(ch);
 }
 
 OBJ_GETTER(Kotlin_text_regex_getDecompositionInternal, KInt ch) {
@@ -105,11 +105,7 @@ RuntimeState* initRuntime() {
       case DESTROY_RUNTIME_LEGACY:
           compareAndSwap(&globalRuntimeStatus, kGlobalRuntimeUninitialized, kGlobalRuntimeRunning);
           result->memoryState = InitMemory(false); // The argument will be ignored for legacy DestroyRuntimeMode
-          result->worker = WorkerInit(true);
           firstRuntime = atomicAdd(&aliveRuntimesCount, 1) == 1;
-          if (CurrentMemoryModel == MemoryModel::kExperimental) {
-              RuntimeCheck(firstRuntime, "Experimental MM does not support multiple mutator threads yet");
-          }
           break;
       case DESTROY_RUNTIME_ON_SHUTDOWN:
           // First update `aliveRuntimesCount` and then update `globalRuntimeStatus`, for synchronization with
@@ -120,12 +116,11 @@ RuntimeState* initRuntime() {
               RuntimeAssert(lastStatus != kGlobalRuntimeShutdown, "Kotlin runtime was shut down. Cannot create new runtimes.");
           }
           firstRuntime = lastStatus == kGlobalRuntimeUninitialized;
-          if (CurrentMemoryModel == MemoryModel::kExperimental) {
-              RuntimeCheck(firstRuntime, "Experimental MM does not support multiple mutator threads yet");
-          }
           result->memoryState = InitMemory(firstRuntime);
-          result->worker = WorkerInit(true);
   }
+  // Creating a Worker takes the global workers lock, which dominates attaching short-lived foreign threads.
+  // So only the first runtime and native workers get one eagerly, others create it on first use.
+  result->worker = firstRuntime ? WorkerInit(true) : WorkerCurrent();
 
   InitOrDeinitGlobalVariables(ALLOC_THREAD_LOCAL_GLOBALS, result->memoryState);
   CommitTLSStorage(result->memoryState);
@@ -162,11 +157,16 @@ void deinitRuntime(RuntimeState* state, bool destroyRuntime) {
   ClearTLS(state->memoryState);
   if (destroyRuntime)
     InitOrDeinitGlobalVariables(DEINIT_GLOBALS, state->memoryState);
-  auto workerId = GetWorkerId(state->worker);
-  WorkerDeinit(state->worker);
+  Worker* worker = state->worker;
+  KInt workerId = 0;
+  if (worker != nullptr) {
+    workerId = GetWorkerId(worker);
+    WorkerDeinit(worker);
+  }
   DeinitMemory(state->memoryState, destroyRuntime);
   konanDestructInstance(state);
-  WorkerDestroyThreadDataIfNeeded(workerId);
+  if (worker != nullptr)
+    WorkerDestroyThreadDataIfNeeded(workerId);
   ::runtimeState = kInvalidRuntime;
 }
 
@@ -197,6 +197,12 @@ RUNTIME_NOTHROW void Kotlin_initRuntimeIfNeeded() {
   }
 }
 
+void Kotlin_initWorkerIfNeeded() {
+  RuntimeAssert(isValidRuntime(), "Current thread must have Kotlin runtime initialized on it");
+  if (::runtimeState->worker == nullptr)
+    ::runtimeState->worker = WorkerInit(true);
+}
+
 void Kotlin_deinitRuntimeIfNeeded() {
   if (isValidRuntime()) {
     deinitRuntime(::runtimeState, false);
@@ -36,6 +36,9 @@ DestroyRuntimeMode Kotlin_getDestroyRuntimeMode();
 RUNTIME_NOTHROW void Kotlin_initRuntimeIfNeeded();
 void Kotlin_deinitRuntimeIfNeeded();
 
+// Runtimes attached to foreign threads create their Worker lazily. Must be called on a thread with active runtime.
+void Kotlin_initWorkerIfNeeded();
+
 // Can only be called once.
 // No new runtimes can be initialized on any thread after this.
 // Must be called on a thread with active runtime.
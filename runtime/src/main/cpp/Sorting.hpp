@@ -0,0 +1,341 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_SORTING_H
+#define RUNTIME_SORTING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace kotlin {
+
+namespace internal {
+
+// Ranges smaller than this are sorted with insertion sort.
+constexpr ptrdiff_t kInsertionSortThreshold = 24;
+// Ranges larger than this use Tukey's ninther for the pivot.
+constexpr ptrdiff_t kNintherThreshold = 128;
+// Number of elements a partial insertion sort may move before giving up.
+constexpr ptrdiff_t kPartialInsertionSortLimit = 8;
+
+template <typename T, typename Less>
+void InsertionSort(T* begin, T* end, Less less) {
+    if (begin == end) return;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* siftPrevious = current - 1;
+        if (less(*sift, *siftPrevious)) {
+            T value = *sift;
+            do {
+                *sift-- = *siftPrevious;
+            } while (sift != begin && less(value, *--siftPrevious));
+            *sift = value;
+        }
+    }
+}
+
+// Same as `InsertionSort`, but relies on `*(begin - 1)` being not greater than any element in the range.
+template <typename T, typename Less>
+void UnguardedInsertionSort(T* begin, T* end, Less less) {
+    if (begin == end) return;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* siftPrevious = current - 1;
+        if (less(*sift, *siftPrevious)) {
+            T value = *sift;
+            do {
+                *sift-- = *siftPrevious;
+            } while (less(value, *--siftPrevious));
+            *sift = value;
+        }
+    }
+}
+
+// Insertion sort that gives up (returning false) after moving more than `kPartialInsertionSortLimit` elements.
+template <typename T, typename Less>
+bool PartialInsertionSort(T* begin, T* end, Less less) {
+    if (begin == end) return true;
+    ptrdiff_t moved = 0;
+    for (T* current = begin + 1; current != end; ++current) {
+        T* sift = current;
+        T* siftPrevious = current - 1;
+        if (less(*sift, *siftPrevious)) {
+            T value = *sift;
+            do {
+                *sift-- = *siftPrevious;
+            } while (sift != begin && less(value, *--siftPrevious));
+            *sift = value;
+            moved += current - sift;
+        }
+        if (moved > kPartialInsertionSortLimit) return false;
+    }
+    return true;
+}
+
+template <typename T, typename Less>
+void Sort2(T* a, T* b, Less less) {
+    if (less(*b, *a)) std::iter_swap(a, b);
+}
+
+template <typename T, typename Less>
+void Sort3(T* a, T* b, T* c, Less less) {
+    Sort2(a, b, less);
+    Sort2(b, c, less);
+    Sort2(a, b, less);
+}
+
+// Partitions the range around the pivot `*begin`, elements equal to the pivot go to the right part.
+// Returns the final pivot position and whether the range was partitioned already.
+template <typename T, typename Less>
+std::pair<T*, bool> PartitionRight(T* begin, T* end, Less less) {
+    T pivot = *begin;
+    T* first = begin;
+    T* last = end;
+
+    // The pivot was chosen as a median, so there is an element not less than it.
+    while (less(*++first, pivot)) {
+    }
+    // There may be no element less than the pivot if nothing was skipped above.
+    if (first - 1 == begin) {
+        while (first < last && !less(*--last, pivot)) {
+        }
+    } else {
+        while (!less(*--last, pivot)) {
+        }
+    }
+
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (less(*++first, pivot)) {
+        }
+        while (!less(*--last, pivot)) {
+        }
+    }
+
+    T* pivotPosition = first - 1;
+    *begin = *pivotPosition;
+    *pivotPosition = pivot;
+    return {pivotPosition, alreadyPartitioned};
+}
+
+// Partitions the range around the pivot `*begin`, elements equal to the pivot go to the left part.
+// Used when the pivot is known to be the smallest element, which happens with many equal elements.
+template <typename T, typename Less>
+T* PartitionLeft(T* begin, T* end, Less less) {
+    T pivot = *begin;
+    T* first = begin;
+    T* last = end;
+
+    while (less(pivot, *--last)) {
+    }
+    if (last + 1 == end) {
+        while (first < last && !less(pivot, *++first)) {
+        }
+    } else {
+        while (!less(pivot, *++first)) {
+        }
+    }
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (less(pivot, *--last)) {
+        }
+        while (!less(pivot, *++first)) {
+        }
+    }
+
+    T* pivotPosition = last;
+    *begin = *pivotPosition;
+    *pivotPosition = pivot;
+    return pivotPosition;
+}
+
+template <typename T, typename Less>
+void PdqSortLoop(T* begin, T* end, Less less, int badPartitionsAllowed, bool leftmost) {
+    while (true) {
+        ptrdiff_t size = end - begin;
+        if (size < kInsertionSortThreshold) {
+            if (leftmost) {
+                InsertionSort(begin, end, less);
+            } else {
+                UnguardedInsertionSort(begin, end, less);
+            }
+            return;
+        }
+
+        // Move the pivot to `*begin`.
+        ptrdiff_t half = size / 2;
+        if (size > kNintherThreshold) {
+            Sort3(begin, begin + half, end - 1, less);
+            Sort3(begin + 1, begin + (half - 1), end - 2, less);
+            Sort3(begin + 2, begin + (half + 1), end - 3, less);
+            Sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            std::iter_swap(begin, begin + half);
+        } else {
+            Sort3(begin + half, begin, end - 1, less);
+        }
+
+        // `*(begin - 1)` is the pivot of the enclosing partition, so nothing here is less than it. If it's equal to
+        // the new pivot, the whole left part consists of equal elements and needs no further sorting.
+        if (!leftmost && !less(*(begin - 1), *begin)) {
+            begin = PartitionLeft(begin, end, less) + 1;
+            continue;
+        }
+
+        auto partition = PartitionRight(begin, end, less);
+        T* pivotPosition = partition.first;
+        bool alreadyPartitioned = partition.second;
+
+        ptrdiff_t leftSize = pivotPosition - begin;
+        ptrdiff_t rightSize = end - (pivotPosition + 1);
+        if (leftSize < size / 8 || rightSize < size / 8) {
+            // Too many bad partitions mean an adversarial input: fall back to the guaranteed O(n log n).
+            if (--badPartitionsAllowed == 0) {
+                std::make_heap(begin, end, less);
+                std::sort_heap(begin, end, less);
+                return;
+            }
+            // Shuffle some elements around to break patterns.
+            if (leftSize >= kInsertionSortThreshold) {
+                std::iter_swap(begin, begin + leftSize / 4);
+                std::iter_swap(pivotPosition - 1, pivotPosition - leftSize / 4);
+                if (leftSize > kNintherThreshold) {
+                    std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                    std::iter_swap(pivotPosition - 2, pivotPosition - (leftSize / 4 + 1));
+                    std::iter_swap(pivotPosition - 3, pivotPosition - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= kInsertionSortThreshold) {
+                std::iter_swap(pivotPosition + 1, pivotPosition + (1 + rightSize / 4));
+                std::iter_swap(end - 1, end - rightSize / 4);
+                if (rightSize > kNintherThreshold) {
+                    std::iter_swap(pivotPosition + 2, pivotPosition + (2 + rightSize / 4));
+                    std::iter_swap(pivotPosition + 3, pivotPosition + (3 + rightSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                }
+            }
+        } else if (
+                alreadyPartitioned && PartialInsertionSort(begin, pivotPosition, less) &&
+                PartialInsertionSort(pivotPosition + 1, end, less)) {
+            // A balanced partition of an already partitioned range: the input was (almost) sorted.
+            return;
+        }
+
+        // Recurse into the left part and loop on the right one.
+        PdqSortLoop(begin, pivotPosition, less, badPartitionsAllowed, leftmost);
+        begin = pivotPosition + 1;
+        leftmost = false;
+    }
+}
+
+// Maps floating point numbers to signed integers, so that integer comparison gives the `compareTo` order:
+// -0.0 is less than 0.0, and all NaNs are equal to each other and greater than everything else.
+template <typename Float>
+auto TotalOrderKey(Float value) {
+    using Bits = std::conditional_t<sizeof(Float) == sizeof(int64_t), int64_t, int32_t>;
+    static_assert(sizeof(Bits) == sizeof(Float), "Unsupported floating point type");
+    if (value != value) return std::numeric_limits<Bits>::max();
+    Bits bits;
+    memcpy(&bits, &value, sizeof(bits));
+    // Negative numbers are ordered backwards by their magnitude bits.
+    return bits ^ ((bits >> (sizeof(Bits) * 8 - 1)) & std::numeric_limits<Bits>::max());
+}
+
+} // namespace internal
+
+// Pattern-defeating quicksort (Orson Peters, 2021): introsort with insertion sort for small and nearly sorted
+// ranges, and special handling of many equal elements. Not stable.
+template <typename T, typename Less>
+void PdqSort(T* begin, T* end, Less less) {
+    ptrdiff_t size = end - begin;
+    if (size < 2) return;
+    int log2 = 0;
+    while (size >>= 1) ++log2;
+    internal::PdqSortLoop(begin, end, less, log2, true);
+}
+
+template <typename T>
+void PdqSort(T* begin, T* end) {
+    if constexpr (std::is_floating_point<T>::value) {
+        PdqSort(begin, end, [](T a, T b) { return internal::TotalOrderKey(a) < internal::TotalOrderKey(b); });
+    } else {
+        PdqSort(begin, end, [](T a, T b) { return a < b; });
+    }
+}
+
+// Least significant digit radix sort of signed integers, one byte per pass. `buffer` must hold as many elements
+// as the range. Passes in which all elements have the same digit are skipped.
+template <typename T>
+void RadixSort(T* begin, T* end, T* buffer) {
+    static_assert(std::is_integral<T>::value && std::is_signed<T>::value, "Only for signed integers");
+    using Key = std::make_unsigned_t<T>;
+    constexpr size_t kPasses = sizeof(T);
+    constexpr Key kSignBit = Key(1) << (sizeof(T) * 8 - 1);
+
+    const size_t size = end - begin;
+    if (size < 2) return;
+
+    size_t counts[kPasses][256] = {};
+    for (T* it = begin; it != end; ++it) {
+        Key key = static_cast<Key>(*it) ^ kSignBit;
+        for (size_t pass = 0; pass < kPasses; ++pass) {
+            ++counts[pass][(key >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    T* from = begin;
+    T* to = buffer;
+    for (size_t pass = 0; pass < kPasses; ++pass) {
+        const size_t shift = pass * 8;
+        if (counts[pass][((static_cast<Key>(*from) ^ kSignBit) >> shift) & 0xFF] == size) continue;
+
+        size_t offsets[256];
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; ++digit) {
+            offsets[digit] = offset;
+            offset += counts[pass][digit];
+        }
+        for (size_t i = 0; i < size; ++i) {
+            T value = from[i];
+            to[offsets[((static_cast<Key>(value) ^ kSignBit) >> shift) & 0xFF]++] = value;
+        }
+        std::swap(from, to);
+    }
+    if (from != begin) {
+        memcpy(begin, from, size * sizeof(T));
+    }
+}
+
+// Sorts by counting occurrences of each value. Only for types with at most 256 distinct values.
+template <typename T>
+void CountingSort(T* begin, T* end) {
+    static_assert(sizeof(T) == 1, "Only for byte-sized types");
+    using Key = std::make_unsigned_t<std::conditional_t<std::is_same<T, bool>::value, uint8_t, T>>;
+    constexpr size_t kOffset = std::is_signed<T>::value ? 128 : 0;
+
+    size_t counts[256] = {};
+    for (T* it = begin; it != end; ++it) {
+        ++counts[static_cast<Key>(static_cast<Key>(*it) + kOffset)];
+    }
+    T* out = begin;
+    for (size_t index = 0; index < 256; ++index) {
+        T value = static_cast<T>(static_cast<Key>(index - kOffset));
+        for (size_t count = counts[index]; count > 0; --count) {
+            *out++ = value;
+        }
+    }
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_SORTING_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Sorting.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace kotlin;
+
+namespace {
+
+uint64_t NextRandom(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 16;
+}
+
+template <typename T>
+std::vector<T> RandomVector(size_t size, uint64_t seed, uint64_t range) {
+    std::vector<T> result(size);
+    for (auto& element : result) {
+        element = static_cast<T>(NextRandom(seed) % range);
+    }
+    return result;
+}
+
+template <typename T>
+void ExpectPdqSortMatchesStdSort(std::vector<T> values) {
+    std::vector<T> expected = values;
+    std::sort(expected.begin(), expected.end());
+    PdqSort(values.data(), values.data() + values.size());
+    EXPECT_EQ(values, expected);
+}
+
+template <typename T>
+void ExpectRadixSortMatchesStdSort(std::vector<T> values) {
+    std::vector<T> expected = values;
+    std::sort(expected.begin(), expected.end());
+    std::vector<T> buffer(values.size());
+    RadixSort(values.data(), values.data() + values.size(), buffer.data());
+    EXPECT_EQ(values, expected);
+}
+
+} // namespace
+
+TEST(SortingTest, PdqSortSmall) {
+    for (size_t size = 0; size < 64; ++size) {
+        ExpectPdqSortMatchesStdSort(RandomVector<int32_t>(size, size, 1000));
+    }
+}
+
+TEST(SortingTest, PdqSortRandom) {
+    ExpectPdqSortMatchesStdSort(RandomVector<int32_t>(100000, 1, std::numeric_limits<uint64_t>::max()));
+    ExpectPdqSortMatchesStdSort(RandomVector<int64_t>(100000, 2, std::numeric_limits<uint64_t>::max()));
+    ExpectPdqSortMatchesStdSort(RandomVector<uint16_t>(100000, 3, 65536));
+}
+
+TEST(SortingTest, PdqSortManyDuplicates) {
+    ExpectPdqSortMatchesStdSort(RandomVector<int32_t>(100000, 4, 3));
+    ExpectPdqSortMatchesStdSort(std::vector<int32_t>(10000, 42));
+}
+
+TEST(SortingTest, PdqSortPatterns) {
+    const size_t size = 10000;
+    std::vector<int32_t> ascending(size);
+    std::vector<int32_t> descending(size);
+    std::vector<int32_t> organPipe(size);
+    std::vector<int32_t> sawtooth(size);
+    for (size_t i = 0; i < size; ++i) {
+        ascending[i] = static_cast<int32_t>(i);
+        descending[i] = static_cast<int32_t>(size - i);
+        organPipe[i] = static_cast<int32_t>(i < size / 2 ? i : size - i);
+        sawtooth[i] = static_cast<int32_t>(i % 100);
+    }
+    ExpectPdqSortMatchesStdSort(ascending);
+    ExpectPdqSortMatchesStdSort(descending);
+    ExpectPdqSortMatchesStdSort(organPipe);
+    ExpectPdqSortMatchesStdSort(sawtooth);
+
+    std::vector<int32_t> almostSorted = ascending;
+    std::swap(almostSorted[10], almostSorted[size - 10]);
+    ExpectPdqSortMatchesStdSort(almostSorted);
+}
+
+TEST(SortingTest, PdqSortDoubleTotalOrder) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> values = {nan, 1.0, -0.0, infinity, 0.0, -infinity, -nan, -1.0, 0.0, -0.0};
+    PdqSort(values.data(), values.data() + values.size());
+
+    EXPECT_EQ(values[0], -infinity);
+    EXPECT_EQ(values[1], -1.0);
+    EXPECT_TRUE(values[2] == 0.0 && std::signbit(values[2]));
+    EXPECT_TRUE(values[3] == 0.0 && std::signbit(values[3]));
+    EXPECT_TRUE(values[4] == 0.0 && !std::signbit(values[4]));
+    EXPECT_TRUE(values[5] == 0.0 && !std::signbit(values[5]));
+    EXPECT_EQ(values[6], 1.0);
+    EXPECT_EQ(values[7], infinity);
+    EXPECT_TRUE(std::isnan(values[8]));
+    EXPECT_TRUE(std::isnan(values[9]));
+}
+
+TEST(SortingTest, PdqSortFloatRandom) {
+    uint64_t seed = 5;
+    std::vector<float> values(50000);
+    for (auto& value : values) {
+        uint32_t bits = static_cast<uint32_t>(NextRandom(seed));
+        memcpy(&value, &bits, sizeof(value));
+    }
+    PdqSort(values.data(), values.data() + values.size());
+    for (size_t i = 1; i < values.size(); ++i) {
+        EXPECT_LE(internal::TotalOrderKey(values[i - 1]), internal::TotalOrderKey(values[i]));
+    }
+}
+
+TEST(SortingTest, RadixSort) {
+    ExpectRadixSortMatchesStdSort(RandomVector<int32_t>(0, 6, 10));
+    ExpectRadixSortMatchesStdSort(RandomVector<int32_t>(1, 6, 10));
+    ExpectRadixSortMatchesStdSort(RandomVector<int32_t>(100000, 7, std::numeric_limits<uint64_t>::max()));
+    ExpectRadixSortMatchesStdSort(RandomVector<int64_t>(100000, 8, std::numeric_limits<uint64_t>::max()));
+    ExpectRadixSortMatchesStdSort(RandomVector<int32_t>(100000, 9, 1000));
+    ExpectRadixSortMatchesStdSort(std::vector<int64_t>{
+            std::numeric_limits<int64_t>::max(), -1, 0, std::numeric_limits<int64_t>::min(), 1, -1});
+}
+
+TEST(SortingTest, CountingSort) {
+    std::vector<int8_t> bytes = RandomVector<int8_t>(10000, 10, 256);
+    std::vector<int8_t> expectedBytes = bytes;
+    std::sort(expectedBytes.begin(), expectedBytes.end());
+    CountingSort(bytes.data(), bytes.data() + bytes.size());
+    EXPECT_EQ(bytes, expectedBytes);
+
+    bool booleans[] = {true, false, true, true, false};
+    CountingSort(booleans, booleans + 5);
+    EXPECT_FALSE(booleans[0]);
+    EXPECT_FALSE(booleans[1]);
+    EXPECT_TRUE(booleans[2]);
+    EXPECT_TRUE(booleans[4]);
+}
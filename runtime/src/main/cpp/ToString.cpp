@@ -23,6 +23,7 @@
 #include "Memory.h"
 #include "Natives.h"
 #include "KString.h"
+#include "NumberFormatting.hpp"
 #include "Porting.h"
 #include "Types.h"
 
@@ -65,14 +66,29 @@ template <typename T> OBJ_GETTER(Kotlin_toStringRadix, T value, KInt radix) {
   RETURN_RESULT_OF(CreateStringFromCString, cstring);
 }
 
+// Formats the number directly into the storage of a string of the exact length.
+OBJ_GETTER(Kotlin_toStringDecimal, KLong value) {
+  size_t length = kotlin::FormattedIntegerLength(value);
+  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, length, OBJ_RESULT)->array();
+  kotlin::FormatInteger(value, CharArrayAddressOfElementAt(result, 0));
+  RETURN_OBJ(result->obj());
+}
+
+OBJ_GETTER(CreateStringFromAscii, const char* chars, size_t length) {
+  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, length, OBJ_RESULT)->array();
+  KChar* out = CharArrayAddressOfElementAt(result, 0);
+  for (size_t i = 0; i < length; i++) {
+    out[i] = chars[i];
+  }
+  RETURN_OBJ(result->obj());
+}
+
 }  // namespace
 
 extern "C" {
 
 OBJ_GETTER(Kotlin_Byte_toString, KByte value) {
-  char cstring[8];
-  konan::snprintf(cstring, sizeof(cstring), "%d", value);
-  RETURN_RESULT_OF(CreateStringFromCString, cstring);
+  RETURN_RESULT_OF(Kotlin_toStringDecimal, value);
 }
 
 OBJ_GETTER(Kotlin_Char_toString, KChar value) {
@@ -82,15 +98,11 @@ OBJ_GETTER(Kotlin_Char_toString, KChar value) {
 }
 
 OBJ_GETTER(Kotlin_Short_toString, KShort value) {
-  char cstring[8];
-  konan::snprintf(cstring, sizeof(cstring), "%d", value);
-  RETURN_RESULT_OF(CreateStringFromCString, cstring);
+  RETURN_RESULT_OF(Kotlin_toStringDecimal, value);
 }
 
 OBJ_GETTER(Kotlin_Int_toString, KInt value) {
-  char cstring[16];
-  konan::snprintf(cstring, sizeof(cstring), "%d", value);
-  RETURN_RESULT_OF(CreateStringFromCString, cstring);
+  RETURN_RESULT_OF(Kotlin_toStringDecimal, value);
 }
 
 OBJ_GETTER(Kotlin_Int_toStringRadix, KInt value, KInt radix) {
@@ -98,15 +110,25 @@ OBJ_GETTER(Kotlin_Int_toStringRadix, KInt value, KInt radix) {
 }
 
 OBJ_GETTER(Kotlin_Long_toString, KLong value) {
-  char cstring[32];
-  konan::snprintf(cstring, sizeof(cstring), "%lld", static_cast<long long>(value));
-  RETURN_RESULT_OF(CreateStringFromCString, cstring);
+  RETURN_RESULT_OF(Kotlin_toStringDecimal, value);
 }
 
 OBJ_GETTER(Kotlin_Long_toStringRadix, KLong value, KInt radix) {
   RETURN_RESULT_OF(Kotlin_toStringRadix<KLong>, value, radix)
 }
 
+OBJ_GETTER(Kotlin_Float_toString, KFloat value) {
+  char chars[kotlin::kMaxNumberStringLength];
+  size_t length = kotlin::FormatFloat(value, chars);
+  RETURN_RESULT_OF(CreateStringFromAscii, chars, length);
+}
+
+OBJ_GETTER(Kotlin_Double_toString, KDouble value) {
+  char chars[kotlin::kMaxNumberStringLength];
+  size_t length = kotlin::FormatDouble(value, chars);
+  RETURN_RESULT_OF(CreateStringFromAscii, chars, length);
+}
+
 OBJ_GETTER(Kotlin_DurationValue_formatToExactDecimals, KDouble value, KInt decimals) {
   char cstring[32];
   konan::snprintf(cstring, sizeof(cstring), "%.*f", decimals, value);
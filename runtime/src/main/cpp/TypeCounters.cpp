@@ -0,0 +1,165 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "TypeCounters.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <new>
+
+#include "Alloc.h"
+#include "Atomic.h"
+#include "Exceptions.h"
+#include "KString.h"
+#include "Porting.h"
+#include "TypeInfo.h"
+#include "TypeInfoUtils.hpp"
+#include "WritableTypeInfo.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+std::atomic<TypeCounters*> allCounters = nullptr;
+
+std::atomic<uint32_t> nextShard = 0;
+
+// 1-based, so that `0` means that the current thread has no shard yet.
+THREAD_LOCAL_VARIABLE uint32_t currentShard = 0;
+
+} // namespace
+
+std::atomic<bool> kotlin::internal::typeCountersEnabled = false;
+
+NO_INLINE void kotlin::internal::CountAllocation(const TypeInfo* typeInfo, size_t size) noexcept {
+    if (auto* counters = TypeCounters::ForType(typeInfo)) {
+        counters->Allocated(size);
+    }
+}
+
+NO_INLINE void kotlin::internal::CountDeallocation(const ObjHeader* object) noexcept {
+    if (auto* counters = TypeCounters::ForType(object->type_info())) {
+        counters->Deallocated(ObjectSize(object));
+    }
+}
+
+// static
+bool TypeCounters::IsSupported() noexcept {
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+    return true;
+#else
+    return false;
+#endif
+}
+
+// static
+void TypeCounters::SetEnabled(bool enabled) noexcept {
+    internal::typeCountersEnabled.store(enabled && IsSupported(), std::memory_order_relaxed);
+}
+
+// static
+bool TypeCounters::IsEnabled() noexcept {
+    return internal::typeCountersEnabled.load(std::memory_order_relaxed);
+}
+
+// static
+TypeCounters* TypeCounters::ForType(const TypeInfo* typeInfo) noexcept {
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+    WritableTypeInfo* writableInfo = typeInfo->writableInfo_;
+    if (writableInfo == nullptr) return nullptr;
+    if (TypeCounters* counters = atomicGet(&writableInfo->counters)) {
+        return counters;
+    }
+
+    auto* created = new (konanAllocAlignedMemory(sizeof(TypeCounters), alignof(TypeCounters))) TypeCounters(typeInfo);
+    TypeCounters* existing = compareAndSwap(&writableInfo->counters, static_cast<TypeCounters*>(nullptr), created);
+    if (existing != nullptr) {
+        // Another thread got to it first.
+        created->~TypeCounters();
+        konanFreeMemory(created);
+        return existing;
+    }
+    created->next_ = allCounters.load(std::memory_order_relaxed);
+    while (!allCounters.compare_exchange_weak(created->next_, created, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return created;
+#else
+    return nullptr;
+#endif
+}
+
+// static
+KStdVector<TypeCounters::Entry> TypeCounters::Snapshot() noexcept {
+    KStdVector<Entry> result;
+    for (TypeCounters* counters = allCounters.load(std::memory_order_acquire); counters != nullptr; counters = counters->next_) {
+        result.push_back(counters->Get());
+    }
+    std::stable_sort(result.begin(), result.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.liveBytes > rhs.liveBytes; });
+    return result;
+}
+
+// static
+KStdString TypeCounters::Format(const KStdVector<Entry>& entries) noexcept {
+    KStdString result = "live objects\tlive bytes\tallocated objects\tallocated bytes\ttype\n";
+    char buffer[128];
+    for (auto& entry : entries) {
+        konan::snprintf(
+                buffer, sizeof(buffer), "%" PRId64 "\t%" PRId64 "\t%" PRId64 "\t%" PRId64 "\t", entry.liveObjects, entry.liveBytes,
+                entry.allocatedObjects, entry.allocatedBytes);
+        result += buffer;
+        result += TypeName(entry.typeInfo);
+        result += '\n';
+    }
+    return result;
+}
+
+void TypeCounters::Allocated(size_t size) noexcept {
+    auto& shard = CurrentShard();
+    shard.allocatedObjects.fetch_add(1, std::memory_order_relaxed);
+    shard.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void TypeCounters::Deallocated(size_t size) noexcept {
+    auto& shard = CurrentShard();
+    shard.deallocatedObjects.fetch_add(1, std::memory_order_relaxed);
+    shard.deallocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+TypeCounters::Entry TypeCounters::Get() const noexcept {
+    Entry entry{typeInfo_, 0, 0, 0, 0};
+    for (auto& shard : shards_) {
+        int64_t allocatedObjects = shard.allocatedObjects.load(std::memory_order_relaxed);
+        int64_t allocatedBytes = shard.allocatedBytes.load(std::memory_order_relaxed);
+        entry.allocatedObjects += allocatedObjects;
+        entry.allocatedBytes += allocatedBytes;
+        // Objects may be deallocated on another thread, so only the sum over all shards makes sense.
+        entry.liveObjects += allocatedObjects - shard.deallocatedObjects.load(std::memory_order_relaxed);
+        entry.liveBytes += allocatedBytes - shard.deallocatedBytes.load(std::memory_order_relaxed);
+    }
+    return entry;
+}
+
+TypeCounters::Shard& TypeCounters::CurrentShard() noexcept {
+    if (currentShard == 0) {
+        currentShard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount + 1;
+    }
+    return shards_[currentShard - 1];
+}
+
+extern "C" void Kotlin_native_internal_GC_setTypeCountersEnabled(ObjHeader*, bool value) {
+    if (value && !TypeCounters::IsSupported()) {
+        ThrowIllegalArgumentException();
+    }
+    TypeCounters::SetEnabled(value);
+}
+
+extern "C" bool Kotlin_native_internal_GC_getTypeCountersEnabled(ObjHeader*) {
+    return TypeCounters::IsEnabled();
+}
+
+extern "C" OBJ_GETTER(Kotlin_native_internal_GC_getTypeHistogram, ObjHeader*) {
+    auto histogram = TypeCounters::Format(TypeCounters::Snapshot());
+    RETURN_RESULT_OF(CreateStringFromCString, histogram.c_str());
+}
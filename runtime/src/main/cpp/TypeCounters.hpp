@@ -0,0 +1,102 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_TYPE_COUNTERS_H
+#define RUNTIME_TYPE_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "Common.h"
+#include "Memory.h"
+#include "Types.h"
+#include "Utils.hpp"
+
+namespace kotlin {
+
+// Counts allocated and deallocated objects and bytes of each type, so that a class histogram can be taken at runtime
+// without a heap dump. Counters of a type are created on its first counted allocation and are kept in its
+// `WritableTypeInfo`. They are sharded by thread, so that threads allocating the same type do not contend.
+class TypeCounters : private Pinned {
+public:
+    struct Entry {
+        const TypeInfo* typeInfo;
+        int64_t allocatedObjects;
+        int64_t allocatedBytes;
+        // Exact only if counting has been enabled since before these objects were allocated.
+        int64_t liveObjects;
+        int64_t liveBytes;
+    };
+
+    // `false` if types have no writable part on this target.
+    static bool IsSupported() noexcept;
+
+    // Counting is disabled by default.
+    static void SetEnabled(bool enabled) noexcept;
+    static bool IsEnabled() noexcept;
+
+    // Returns the counters of `typeInfo`, creating them if needed. Returns `nullptr` if not supported.
+    static TypeCounters* ForType(const TypeInfo* typeInfo) noexcept;
+
+    // All types with counters, sorted by live bytes, most first.
+    static KStdVector<Entry> Snapshot() noexcept;
+
+    // Formats `entries` as a table with a header and tab separated columns: live objects, live bytes,
+    // allocated objects, allocated bytes and the type name.
+    static KStdString Format(const KStdVector<Entry>& entries) noexcept;
+
+    void Allocated(size_t size) noexcept;
+    void Deallocated(size_t size) noexcept;
+
+    Entry Get() const noexcept;
+
+private:
+    static constexpr size_t kShardCount = 8;
+
+    // Each shard takes a cache line of its own.
+    struct alignas(64) Shard {
+        std::atomic<int64_t> allocatedObjects{0};
+        std::atomic<int64_t> allocatedBytes{0};
+        std::atomic<int64_t> deallocatedObjects{0};
+        std::atomic<int64_t> deallocatedBytes{0};
+    };
+
+    explicit TypeCounters(const TypeInfo* typeInfo) noexcept : typeInfo_(typeInfo) {}
+
+    Shard& CurrentShard() noexcept;
+
+    const TypeInfo* const typeInfo_;
+    // All created counters form a list, which is never shrunk, like the types themselves.
+    TypeCounters* next_ = nullptr;
+    std::array<Shard, kShardCount> shards_;
+};
+
+namespace internal {
+
+extern std::atomic<bool> typeCountersEnabled;
+
+void CountAllocation(const TypeInfo* typeInfo, size_t size) noexcept;
+void CountDeallocation(const ObjHeader* object) noexcept;
+
+} // namespace internal
+
+// Must be called by memory managers for every allocated object with its size.
+ALWAYS_INLINE inline void CountAllocation(const TypeInfo* typeInfo, size_t size) noexcept {
+    if (internal::typeCountersEnabled.load(std::memory_order_relaxed)) {
+        internal::CountAllocation(typeInfo, size);
+    }
+}
+
+// Must be called by memory managers for every deallocated object.
+ALWAYS_INLINE inline void CountDeallocation(const ObjHeader* object) noexcept {
+    if (internal::typeCountersEnabled.load(std::memory_order_relaxed)) {
+        internal::CountDeallocation(object);
+    }
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_TYPE_COUNTERS_H
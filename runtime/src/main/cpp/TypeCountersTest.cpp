@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "TypeCounters.hpp"
+
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ObjectTestSupport.hpp"
+#include "TypeInfo.h"
+#include "Types.h"
+#include "WritableTypeInfo.hpp"
+
+using namespace kotlin;
+
+namespace {
+
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+using test_support::CountedType;
+
+CountedType objectType(24);
+CountedType arrayType(-8);
+CountedType threadsType(16);
+CountedType disabledType(16);
+
+TypeCounters::Entry Find(const TypeInfo* typeInfo) {
+    for (auto& entry : TypeCounters::Snapshot()) {
+        if (entry.typeInfo == typeInfo) return entry;
+    }
+    return TypeCounters::Entry{typeInfo, 0, 0, 0, 0};
+}
+
+class TypeCountersTest : public testing::Test {
+public:
+    TypeCountersTest() { TypeCounters::SetEnabled(true); }
+
+    ~TypeCountersTest() { TypeCounters::SetEnabled(false); }
+};
+
+#endif
+
+} // namespace
+
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+TEST_F(TypeCountersTest, CountObjects) {
+    ObjHeader object;
+    object.typeInfoOrMeta_ = &objectType.typeInfo;
+
+    for (int i = 0; i < 3; ++i) {
+        CountAllocation(&objectType.typeInfo, 24);
+    }
+    CountDeallocation(&object);
+
+    auto entry = Find(&objectType.typeInfo);
+    EXPECT_THAT(entry.allocatedObjects, 3);
+    EXPECT_THAT(entry.allocatedBytes, 72);
+    EXPECT_THAT(entry.liveObjects, 2);
+    EXPECT_THAT(entry.liveBytes, 48);
+}
+
+TEST_F(TypeCountersTest, CountArrays) {
+    ArrayHeader array;
+    array.typeInfoOrMeta_ = &arrayType.typeInfo;
+    array.count_ = 10;
+    size_t size = sizeof(ArrayHeader) + 8 * 10;
+
+    CountAllocation(&arrayType.typeInfo, size);
+    CountAllocation(&arrayType.typeInfo, size);
+    CountDeallocation(array.obj());
+
+    auto entry = Find(&arrayType.typeInfo);
+    EXPECT_THAT(entry.allocatedObjects, 2);
+    EXPECT_THAT(entry.allocatedBytes, 2 * size);
+    EXPECT_THAT(entry.liveObjects, 1);
+    EXPECT_THAT(entry.liveBytes, size);
+}
+
+TEST_F(TypeCountersTest, CountOnThreads) {
+    constexpr int kThreadCount = 4;
+    constexpr int kCount = 10000;
+    KStdVector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < kCount; ++j) {
+                CountAllocation(&threadsType.typeInfo, 16);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto entry = Find(&threadsType.typeInfo);
+    EXPECT_THAT(entry.allocatedObjects, kThreadCount * kCount);
+    EXPECT_THAT(entry.liveBytes, kThreadCount * kCount * 16);
+    EXPECT_THAT(threadsType.writableInfo.counters, testing::Ne(nullptr));
+}
+
+TEST(TypeCountersDisabledTest, NotCounted) {
+    ASSERT_FALSE(TypeCounters::IsEnabled());
+    CountAllocation(&disabledType.typeInfo, 16);
+
+    EXPECT_THAT(disabledType.writableInfo.counters, nullptr);
+    EXPECT_THAT(Find(&disabledType.typeInfo).allocatedObjects, 0);
+}
+
+TEST(TypeCountersFormatTest, Format) {
+    TypeInfo type{};
+    KStdVector<TypeCounters::Entry> entries = {{&type, 3, 72, 2, 48}};
+    EXPECT_THAT(
+            TypeCounters::Format(entries),
+            "live objects\tlive bytes\tallocated objects\tallocated bytes\ttype\n"
+            "2\t48\t3\t72\t<anonymous>\n");
+}
+
+#endif
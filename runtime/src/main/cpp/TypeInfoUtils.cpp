@@ -0,0 +1,23 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "TypeInfoUtils.hpp"
+
+#include "KString.h"
+
+using namespace kotlin;
+
+KStdString kotlin::TypeName(const TypeInfo* typeInfo) noexcept {
+    KStdString result;
+    for (ObjHeader* name : {typeInfo->packageName_, typeInfo->relativeName_}) {
+        if (name == nullptr) continue;
+        char* cname = CreateCStringFromString(name);
+        if (!result.empty() && cname[0] != '\0') result += '.';
+        result += cname;
+        DisposeCString(cname);
+    }
+    if (result.empty()) result = "<anonymous>";
+    return result;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_TYPE_INFO_UTILS_H
+#define RUNTIME_TYPE_INFO_UTILS_H
+
+#include <cstdint>
+
+#include "Common.h"
+#include "Memory.h"
+#include "TypeInfo.h"
+#include "Types.h"
+
+namespace kotlin {
+
+// The fully qualified name of `typeInfo`, or `<anonymous>` if it has none.
+KStdString TypeName(const TypeInfo* typeInfo) noexcept;
+
+// The size of `object` in bytes, including its header and, for arrays, the elements.
+ALWAYS_INLINE inline uint64_t ObjectSize(const ObjHeader* object) noexcept {
+    const TypeInfo* typeInfo = object->type_info();
+    if (!typeInfo->IsArray()) {
+        return typeInfo->instanceSize_;
+    }
+    return sizeof(ArrayHeader) + static_cast<uint64_t>(-typeInfo->instanceSize_) * object->array()->count_;
+}
+
+} // namespace kotlin
+
+#endif // RUNTIME_TYPE_INFO_UTILS_H
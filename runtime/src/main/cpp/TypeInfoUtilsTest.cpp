@@ -0,0 +1,36 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "TypeInfoUtils.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ObjectTestSupport.hpp"
+
+using namespace kotlin;
+
+TEST(TypeInfoUtilsTest, ObjectSize) {
+    test_support::Object<3> object;
+    EXPECT_THAT(ObjectSize(object.header()), sizeof(test_support::Object<3>));
+}
+
+TEST(TypeInfoUtilsTest, ArraySize) {
+    test_support::Array<5> array;
+    EXPECT_THAT(ObjectSize(array.header()), sizeof(ArrayHeader) + 5 * sizeof(ObjHeader*));
+}
+
+TEST(TypeInfoUtilsTest, PrimitiveArraySize) {
+    TypeInfo type{};
+    type.typeInfo_ = &type;
+    type.instanceSize_ = -static_cast<int32_t>(sizeof(int16_t));
+    test_support::Array<5> array(&type);
+    EXPECT_THAT(ObjectSize(array.header()), sizeof(ArrayHeader) + 5 * sizeof(int16_t));
+}
+
+TEST(TypeInfoUtilsTest, AnonymousTypeName) {
+    TypeInfo type{};
+    EXPECT_THAT(TypeName(&type), "<anonymous>");
+}
@@ -582,7 +582,9 @@ KInt startWorker(KBoolean errorReporting, KRef customName) {
 }
 
 KInt currentWorker() {
-  if (g_worker == nullptr) ThrowWorkerInvalidState();
+  // Threads attached to the runtime by foreign code get their worker on first use.
+  if (::g_worker == nullptr) Kotlin_initWorkerIfNeeded();
+  if (::g_worker == nullptr) ThrowWorkerInvalidState();
   return ::g_worker->id();
 }
 
@@ -730,6 +732,14 @@ Worker* WorkerInit(KBoolean errorReporting) {
 #endif  // WITH_WORKERS
 }
 
+Worker* WorkerCurrent() {
+#if WITH_WORKERS
+  return ::g_worker;
+#else
+  return nullptr;
+#endif  // WITH_WORKERS
+}
+
 void WorkerDeinit(Worker* worker) {
 #if WITH_WORKERS
   ::g_worker = nullptr;
@@ -9,6 +9,8 @@ class Worker;
 KInt GetWorkerId(Worker* worker);
 
 Worker* WorkerInit(KBoolean errorReporting);
+// Worker already bound to the current thread (e.g. by a native worker's event loop), or nullptr.
+Worker* WorkerCurrent();
 void WorkerDeinit(Worker* worker);
 // Clean up all associated thread state, if this was a native worker.
 void WorkerDestroyThreadDataIfNeeded(KInt id);
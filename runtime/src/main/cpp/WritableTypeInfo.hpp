@@ -0,0 +1,42 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_WRITABLE_TYPE_INFO_H
+#define RUNTIME_WRITABLE_TYPE_INFO_H
+
+#include "Common.h"
+
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+#if KONAN_OBJC_INTEROP
+#include <objc/runtime.h>
+
+struct ObjCTypeAdapter;
+
+struct TypeInfoObjCExportAddition {
+  /*convertReferenceToObjC*/ void* convert;
+  Class objCClass;
+  const ObjCTypeAdapter* typeAdapter;
+};
+#endif
+
+namespace kotlin {
+class TypeCounters;
+} // namespace kotlin
+
+// Mutable part of the `TypeInfo`. The compiler emits it zero-initialized for each class, and fills
+// `objCExport` for the classes exported to Objective-C, so the layout must be kept in sync with
+// `buildWritableTypeInfoValue` in ObjCExportCodeGenerator.kt.
+struct WritableTypeInfo {
+#if KONAN_OBJC_INTEROP
+  TypeInfoObjCExportAddition objCExport;
+#endif
+  // Allocated on the first counted allocation of the type, see TypeCounters.hpp.
+  kotlin::TypeCounters* counters;
+};
+
+#endif // KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+#endif // RUNTIME_WRITABLE_TYPE_INFO_H
@@ -23,6 +23,7 @@
 #include "../Exceptions.h"
 #include "../KString.h"
 #include "../Natives.h"
+#include "../NumberParsing.hpp"
 #include "../utf8.h"
 
 #if defined(LINUX) || defined(FREEBSD) || defined(MACOSX) || defined(ZOS) || defined(AIX)
@@ -541,6 +542,13 @@ extern "C" KFloat
 Kotlin_native_FloatingPointParser_parseFloatImpl(KString s, KInt e)
 {
   const KChar* utf16 = CharArrayAddressOfElementAt(s, 0);
+  /* Most inputs are converted exactly by the fast path, the rest goes through big integer arithmetic. */
+  KFloat result;
+  if (kotlin::TryParseDecimal(utf16, s->count_, e, &result))
+    {
+      return result;
+    }
+
   KStdString utf8;
   utf8.reserve(s->count_);
   TRY_CATCH(utf8::utf16to8(utf16, utf16 + s->count_, back_inserter(utf8)),
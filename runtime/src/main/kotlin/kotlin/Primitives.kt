@@ -9,7 +9,6 @@ package kotlin
 
 import kotlin.native.internal.CanBePrecreated
 import kotlin.native.internal.IntrinsicType
-import kotlin.native.internal.NumberConverter
 import kotlin.native.internal.TypedIntrinsic
 
 /**
@@ -1398,7 +1397,8 @@ public final class Float private constructor() : Number(), Comparable<Float> {
 
     public override fun equals(other: Any?): Boolean = other is Float && this.equals(other)
 
-    public override fun toString() = NumberConverter.convert(this)
+    @SymbolName("Kotlin_Float_toString")
+    external public override fun toString(): String
 
     public override fun hashCode(): Int {
         return bits()
@@ -1674,7 +1674,8 @@ public final class Double private constructor() : Number(), Comparable<Double> {
 
     public override fun equals(other: Any?): Boolean = other is Double && this.equals(other)
 
-    public override fun toString(): String = NumberConverter.convert(this)
+    @SymbolName("Kotlin_Double_toString")
+    external public override fun toString(): String
 
     public override fun hashCode(): Int = bits().hashCode()
 
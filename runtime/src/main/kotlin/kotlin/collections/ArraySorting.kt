@@ -111,254 +111,6 @@ private fun <T> mergeSort(array: Array<T>, buffer: Array<T>, start: Int, end: In
     return target
 }
 
-// ByteArray    =============================================================================
-private fun partition(
-        array: ByteArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: ByteArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// ShortArray   =============================================================================
-private fun partition(
-        array: ShortArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: ShortArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// IntArray     =============================================================================
-private fun partition(
-        array: IntArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: IntArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// LongArray    =============================================================================
-private fun partition(
-        array: LongArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: LongArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// CharArray    =============================================================================
-private fun partition(
-        array: CharArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: CharArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// FloatArray   =============================================================================
-private fun partition(
-        array: FloatArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i].compareTo(pivot) < 0)
-            i++
-        while (array[j].compareTo(pivot) > 0)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: FloatArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// DoubleArray  =============================================================================
-private fun partition(
-        array: DoubleArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i].compareTo(pivot) < 0)
-            i++
-        while (array[j].compareTo(pivot) > 0)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: DoubleArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
-// BooleanArray =============================================================================
-private fun partition(
-        array: BooleanArray, left: Int, right: Int): Int {
-    var i = left
-    var j = right
-    val pivot = array[(left + right) / 2]
-    while (i <= j) {
-        while (array[i] < pivot)
-            i++
-        while (array[j] > pivot)
-            j--
-        if (i <= j) {
-            val tmp = array[i]
-            array[i] = array[j]
-            array[j] = tmp
-            i++
-            j--
-        }
-    }
-    return i
-}
-
-private fun quickSort(
-        array: BooleanArray, left: Int, right: Int) {
-    val index = partition(array, left, right)
-    if (left < index - 1)
-        quickSort(array, left, index - 1)
-    if (index < right)
-        quickSort(array, index, right)
-}
-
 // Interfaces   =============================================================================
 /**
  * Sorts the subarray specified by [fromIndex] (inclusive) and [toIndex] (exclusive) parameters
@@ -383,13 +135,29 @@ internal fun <T: Comparable<T>> sortArray(array: Array<out T>, fromIndex: Int, t
 }
 
 /**
- * Sorts the given array using qsort algorithm.
+ * Sorts the subarray specified by [fromIndex] (inclusive) and [toIndex] (exclusive) parameters
+ * in the order of the elements' `compareTo`. The sort is done natively and is not stable.
  */
-internal fun sortArray(array: ByteArray, fromIndex: Int, toIndex: Int)    = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: ShortArray, fromIndex: Int, toIndex: Int)   = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: IntArray, fromIndex: Int, toIndex: Int)     = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: LongArray, fromIndex: Int, toIndex: Int)    = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: CharArray, fromIndex: Int, toIndex: Int)    = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: FloatArray, fromIndex: Int, toIndex: Int)   = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: DoubleArray, fromIndex: Int, toIndex: Int)  = quickSort(array, fromIndex, toIndex - 1)
-internal fun sortArray(array: BooleanArray, fromIndex: Int, toIndex: Int) = quickSort(array, fromIndex, toIndex - 1)
\ No newline at end of file
+@SymbolName("Kotlin_ByteArray_sortImpl")
+internal external fun sortArray(array: ByteArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_ShortArray_sortImpl")
+internal external fun sortArray(array: ShortArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_IntArray_sortImpl")
+internal external fun sortArray(array: IntArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_LongArray_sortImpl")
+internal external fun sortArray(array: LongArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_CharArray_sortImpl")
+internal external fun sortArray(array: CharArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_FloatArray_sortImpl")
+internal external fun sortArray(array: FloatArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_DoubleArray_sortImpl")
+internal external fun sortArray(array: DoubleArray, fromIndex: Int, toIndex: Int)
+
+@SymbolName("Kotlin_BooleanArray_sortImpl")
+internal external fun sortArray(array: BooleanArray, fromIndex: Int, toIndex: Int)
@@ -34,3 +34,13 @@ external public actual fun println()
  */
 @SymbolName("Kotlin_io_Console_readLine")
 external public fun readLine(): String?
+
+/**
+ * Writes out everything [print] and [println] have buffered for the standard output stream.
+ *
+ * The standard output is line buffered when it is a terminal and fully buffered otherwise.
+ * It is also flushed by [readLine], before printing to the standard error stream and at exit.
+ */
+@ExperimentalStdlibApi
+@SymbolName("Kotlin_io_Console_flush")
+external public fun flushStandardOutput()
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+package kotlin.native
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.*
+import kotlinx.cinterop.*
+
+/**
+ * A byte buffer in native memory outside of the Kotlin heap.
+ *
+ * The memory never moves, so it can be passed to C APIs with [asCPointer] without copying or pinning,
+ * and it is released deterministically with [free]. Accessing the buffer after that throws [IllegalStateException].
+ * A buffer that is never freed is released some time after it becomes unreachable.
+ *
+ * Multi-byte values are read and written at arbitrary, possibly unaligned, byte offsets in the byte [order]
+ * of the buffer, which is the native byte order by default. Bulk accessors such as [getInts] and [putInts]
+ * copy whole arrays at once and only swap bytes when the order is not native.
+ */
+@ExperimentalStdlibApi
+@NoReorderFields
+public class DirectByteBuffer private constructor() {
+    // Layout is shared with DirectByteBuffer.cpp.
+    private var address: NativePtr = NativePtr.NULL
+    private var capacityBytes: Long = 0L
+    private var bigEndian: Boolean = !Platform.isLittleEndian
+    private var freed: Boolean = false
+    private var storage: NativePtr = NativePtr.NULL
+    // Releases the memory if the buffer is never freed.
+    private var cleaner: Cleaner? = null
+
+    /** Byte order of multi-byte values in a buffer. */
+    public enum class ByteOrder {
+        LITTLE_ENDIAN,
+        BIG_ENDIAN;
+
+        public companion object {
+            /** Byte order of the platform, and the default order of new buffers. */
+            public val NATIVE: ByteOrder
+                get() = if (Platform.isLittleEndian) LITTLE_ENDIAN else BIG_ENDIAN
+        }
+    }
+
+    public companion object {
+        /**
+         * Allocates a zero-filled buffer of [capacity] bytes.
+         *
+         * @throws IllegalArgumentException if [capacity] is negative.
+         * @throws OutOfMemoryError if the memory cannot be allocated.
+         */
+        public fun allocate(capacity: Long): DirectByteBuffer {
+            require(capacity >= 0) { "Capacity must not be negative: $capacity" }
+            val buffer = DirectByteBuffer()
+            buffer.allocateImpl(capacity)
+            buffer.cleaner = createCleaner(StorageHandle(buffer.storage).freeze()) { disposeStorage(it.storage) }
+            return buffer
+        }
+    }
+
+    /** Size of the buffer in bytes. */
+    public val capacity: Long
+        get() = capacityBytes
+
+    /** Whether [free] has been called. */
+    public val isFreed: Boolean
+        get() = freed
+
+    /** Byte order used to read and write multi-byte values. */
+    public var order: ByteOrder
+        get() = if (bigEndian) ByteOrder.BIG_ENDIAN else ByteOrder.LITTLE_ENDIAN
+        set(value) {
+            bigEndian = value == ByteOrder.BIG_ENDIAN
+        }
+
+    @SymbolName("Kotlin_DirectByteBuffer_get")
+    public external operator fun get(index: Long): Byte
+
+    @SymbolName("Kotlin_DirectByteBuffer_set")
+    public external operator fun set(index: Long, value: Byte)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getShortAt")
+    public external fun getShortAt(index: Long): Short
+
+    @SymbolName("Kotlin_DirectByteBuffer_setShortAt")
+    public external fun setShortAt(index: Long, value: Short)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getIntAt")
+    public external fun getIntAt(index: Long): Int
+
+    @SymbolName("Kotlin_DirectByteBuffer_setIntAt")
+    public external fun setIntAt(index: Long, value: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getLongAt")
+    public external fun getLongAt(index: Long): Long
+
+    @SymbolName("Kotlin_DirectByteBuffer_setLongAt")
+    public external fun setLongAt(index: Long, value: Long)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getFloatAt")
+    public external fun getFloatAt(index: Long): Float
+
+    @SymbolName("Kotlin_DirectByteBuffer_setFloatAt")
+    public external fun setFloatAt(index: Long, value: Float)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getDoubleAt")
+    public external fun getDoubleAt(index: Long): Double
+
+    @SymbolName("Kotlin_DirectByteBuffer_setDoubleAt")
+    public external fun setDoubleAt(index: Long, value: Double)
+
+    /**
+     * Copies [length] bytes starting at byte offset [index] into [destination] starting at [destinationOffset].
+     * @throws ArrayIndexOutOfBoundsException if the range does not fit into the buffer or into [destination].
+     */
+    public fun getBytes(index: Long, destination: ByteArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getBytesImpl(index, destination, destinationOffset, length)
+
+    /**
+     * Copies [length] bytes of [source] starting at [sourceOffset] into the buffer starting at byte offset [index].
+     * @throws ArrayIndexOutOfBoundsException if the range does not fit into the buffer or into [source].
+     */
+    public fun putBytes(index: Long, source: ByteArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putBytesImpl(index, source, sourceOffset, length)
+
+    /**
+     * Reads [length] values starting at byte offset [index] into [destination] starting at [destinationOffset].
+     * @throws ArrayIndexOutOfBoundsException if the range does not fit into the buffer or into [destination].
+     */
+    public fun getShorts(index: Long, destination: ShortArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getShortsImpl(index, destination, destinationOffset, length)
+
+    /**
+     * Writes [length] values of [source] starting at [sourceOffset] into the buffer starting at byte offset [index].
+     * @throws ArrayIndexOutOfBoundsException if the range does not fit into the buffer or into [source].
+     */
+    public fun putShorts(index: Long, source: ShortArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putShortsImpl(index, source, sourceOffset, length)
+
+    /** @see getShorts */
+    public fun getInts(index: Long, destination: IntArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getIntsImpl(index, destination, destinationOffset, length)
+
+    /** @see putShorts */
+    public fun putInts(index: Long, source: IntArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putIntsImpl(index, source, sourceOffset, length)
+
+    /** @see getShorts */
+    public fun getLongs(index: Long, destination: LongArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getLongsImpl(index, destination, destinationOffset, length)
+
+    /** @see putShorts */
+    public fun putLongs(index: Long, source: LongArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putLongsImpl(index, source, sourceOffset, length)
+
+    /** @see getShorts */
+    public fun getFloats(index: Long, destination: FloatArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getFloatsImpl(index, destination, destinationOffset, length)
+
+    /** @see putShorts */
+    public fun putFloats(index: Long, source: FloatArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putFloatsImpl(index, source, sourceOffset, length)
+
+    /** @see getShorts */
+    public fun getDoubles(index: Long, destination: DoubleArray, destinationOffset: Int = 0, length: Int = destination.size - destinationOffset) =
+            getDoublesImpl(index, destination, destinationOffset, length)
+
+    /** @see putShorts */
+    public fun putDoubles(index: Long, source: DoubleArray, sourceOffset: Int = 0, length: Int = source.size - sourceOffset) =
+            putDoublesImpl(index, source, sourceOffset, length)
+
+    /**
+     * Returns a C pointer to the buffer memory at [offset], which stays valid until [free].
+     */
+    public fun asCPointer(offset: Long = 0): CPointer<ByteVar> =
+            interpretCPointer<ByteVar>(asCPointerImpl(offset))!!
+
+    /**
+     * Releases the buffer memory. Does nothing if it is already freed.
+     * @throws InvalidMutabilityException if the buffer is frozen.
+     */
+    @SymbolName("Kotlin_DirectByteBuffer_free")
+    public external fun free()
+
+    /** Runs [block] with this buffer and frees it afterwards. */
+    public inline fun <R> use(block: (DirectByteBuffer) -> R): R {
+        try {
+            return block(this)
+        } finally {
+            free()
+        }
+    }
+
+    @SymbolName("Kotlin_DirectByteBuffer_allocateImpl")
+    private external fun allocateImpl(capacity: Long)
+
+    @SymbolName("Kotlin_DirectByteBuffer_asCPointerImpl")
+    private external fun asCPointerImpl(offset: Long): NativePtr
+
+    @SymbolName("Kotlin_DirectByteBuffer_getBytes")
+    private external fun getBytesImpl(index: Long, destination: ByteArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putBytes")
+    private external fun putBytesImpl(index: Long, source: ByteArray, sourceOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getShorts")
+    private external fun getShortsImpl(index: Long, destination: ShortArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putShorts")
+    private external fun putShortsImpl(index: Long, source: ShortArray, sourceOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getInts")
+    private external fun getIntsImpl(index: Long, destination: IntArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putInts")
+    private external fun putIntsImpl(index: Long, source: IntArray, sourceOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getLongs")
+    private external fun getLongsImpl(index: Long, destination: LongArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putLongs")
+    private external fun putLongsImpl(index: Long, source: LongArray, sourceOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getFloats")
+    private external fun getFloatsImpl(index: Long, destination: FloatArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putFloats")
+    private external fun putFloatsImpl(index: Long, source: FloatArray, sourceOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_getDoubles")
+    private external fun getDoublesImpl(index: Long, destination: DoubleArray, destinationOffset: Int, length: Int)
+
+    @SymbolName("Kotlin_DirectByteBuffer_putDoubles")
+    private external fun putDoublesImpl(index: Long, source: DoubleArray, sourceOffset: Int, length: Int)
+}
+
+// The cleaner argument must be shareable, and a boxed NativePtr is not frozen.
+private class StorageHandle(val storage: NativePtr)
+
+@SymbolName("Kotlin_DirectByteBuffer_disposeStorage")
+private external fun disposeStorage(storage: NativePtr)
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+package kotlin.native
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.*
+import kotlinx.cinterop.*
+
+/**
+ * A read-only memory mapping of a file.
+ *
+ * Values are read straight from the mapped pages, the file is never copied into the Kotlin heap.
+ * Like the [ByteArray] accessors such as [ByteArray.getIntAt], multi-byte values are read in
+ * little-endian byte order from arbitrary, possibly unaligned, offsets.
+ *
+ * The mapping stays valid until [close] is called. Accessing the file after that throws [IllegalStateException].
+ * A file that is never closed is unmapped some time after it becomes unreachable.
+ * The file must not be truncated while it is mapped.
+ */
+@ExperimentalStdlibApi
+@NoReorderFields
+public class MappedFile private constructor() {
+    // Layout is shared with MappedFile.cpp.
+    private var address: NativePtr = NativePtr.NULL
+    private var sizeBytes: Long = 0L
+    private var closed: Boolean = false
+    private var mapping: NativePtr = NativePtr.NULL
+    // Unmaps the file if it is never closed.
+    private var cleaner: Cleaner? = null
+
+    /**
+     * Expected access pattern, which lets the OS choose read-ahead and caching strategies.
+     */
+    public enum class Advice {
+        /** No particular access pattern. */
+        NORMAL,
+        /** The file is read from start to end, pages are read ahead aggressively and may be dropped soon after. */
+        SEQUENTIAL,
+        /** The file is read at random offsets, read-ahead is not useful. */
+        RANDOM,
+        /** The whole file will be read soon, the OS may start loading it in the background. */
+        WILL_NEED,
+    }
+
+    public companion object {
+        /**
+         * Maps the file at [path] into memory for reading.
+         *
+         * @throws IllegalArgumentException if the file cannot be opened or mapped.
+         */
+        public fun open(path: String, advice: Advice = Advice.NORMAL): MappedFile {
+            val file = MappedFile()
+            val error = file.openImpl(path)
+            if (error != 0)
+                throw IllegalArgumentException("Cannot map file $path: ${errorMessage(error)}")
+            file.cleaner = createCleaner(MappingHandle(file.mapping).freeze()) { disposeMapping(it.mapping) }
+            if (advice != Advice.NORMAL)
+                file.advise(advice)
+            return file
+        }
+    }
+
+    /** Size of the file in bytes. */
+    public val size: Long
+        get() = sizeBytes
+
+    /** Whether [close] has been called. */
+    public val isClosed: Boolean
+        get() = closed
+
+    /** Tells the OS how the file is about to be accessed. It is only a hint and may be ignored. */
+    public fun advise(advice: Advice) {
+        adviseImpl(advice.ordinal)
+    }
+
+    /**
+     * Gets the byte at [index].
+     * @throws ArrayIndexOutOfBoundsException if [index] is outside of the file.
+     */
+    @SymbolName("Kotlin_MappedFile_get")
+    public external operator fun get(index: Long): Byte
+
+    /**
+     * Gets [Short] at [index].
+     * @throws ArrayIndexOutOfBoundsException if the value does not fit in the file.
+     */
+    @SymbolName("Kotlin_MappedFile_getShortAt")
+    public external fun getShortAt(index: Long): Short
+
+    /**
+     * Gets [Int] at [index].
+     * @throws ArrayIndexOutOfBoundsException if the value does not fit in the file.
+     */
+    @SymbolName("Kotlin_MappedFile_getIntAt")
+    public external fun getIntAt(index: Long): Int
+
+    /**
+     * Gets [Long] at [index].
+     * @throws ArrayIndexOutOfBoundsException if the value does not fit in the file.
+     */
+    @SymbolName("Kotlin_MappedFile_getLongAt")
+    public external fun getLongAt(index: Long): Long
+
+    /**
+     * Gets [Float] at [index].
+     * @throws ArrayIndexOutOfBoundsException if the value does not fit in the file.
+     */
+    @SymbolName("Kotlin_MappedFile_getFloatAt")
+    public external fun getFloatAt(index: Long): Float
+
+    /**
+     * Gets [Double] at [index].
+     * @throws ArrayIndexOutOfBoundsException if the value does not fit in the file.
+     */
+    @SymbolName("Kotlin_MappedFile_getDoubleAt")
+    public external fun getDoubleAt(index: Long): Double
+
+    /**
+     * Copies bytes of the file from [startIndex] (inclusive) to [endIndex] (exclusive) into [destination]
+     * starting at [destinationOffset].
+     *
+     * @return the [destination] array.
+     * @throws ArrayIndexOutOfBoundsException if the range is outside of the file or does not fit into [destination].
+     */
+    public fun copyInto(destination: ByteArray, destinationOffset: Int = 0, startIndex: Long = 0, endIndex: Long = size): ByteArray {
+        copyIntoImpl(destination, destinationOffset, startIndex, endIndex)
+        return destination
+    }
+
+    /**
+     * Returns a C pointer to the mapped data at [offset], which stays valid until [close].
+     */
+    public fun asCPointer(offset: Long = 0): CPointer<ByteVar> =
+            interpretCPointer<ByteVar>(asCPointerImpl(offset))!!
+
+    /**
+     * Unmaps the file. Does nothing if it is already closed.
+     * @throws InvalidMutabilityException if the file is frozen.
+     */
+    @SymbolName("Kotlin_MappedFile_close")
+    public external fun close()
+
+    /** Runs [block] with this file and closes it afterwards. */
+    public inline fun <R> use(block: (MappedFile) -> R): R {
+        try {
+            return block(this)
+        } finally {
+            close()
+        }
+    }
+
+    @SymbolName("Kotlin_MappedFile_openImpl")
+    private external fun openImpl(path: String): Int
+
+    @SymbolName("Kotlin_MappedFile_adviseImpl")
+    private external fun adviseImpl(advice: Int)
+
+    @SymbolName("Kotlin_MappedFile_copyIntoImpl")
+    private external fun copyIntoImpl(destination: ByteArray, destinationOffset: Int, startIndex: Long, endIndex: Long)
+
+    @SymbolName("Kotlin_MappedFile_asCPointerImpl")
+    private external fun asCPointerImpl(offset: Long): NativePtr
+}
+
+// The cleaner argument must be shareable, and a boxed NativePtr is not frozen.
+private class MappingHandle(val mapping: NativePtr)
+
+@SymbolName("Kotlin_MappedFile_errorMessage")
+private external fun errorMessage(error: Int): String
+
+@SymbolName("Kotlin_MappedFile_disposeMapping")
+private external fun disposeMapping(mapping: NativePtr)
@@ -98,6 +98,29 @@ public object Platform {
     public var isCleanersLeakCheckerActive: Boolean
         get() = Platform_getCleanersLeakChecker()
         set(value) = Platform_setCleanersLeakChecker(value)
+
+    /**
+     * Maximum number of frames captured into the stack trace of a new [Throwable], unlimited ([Int.MAX_VALUE]) by default.
+     * Setting a limit makes throwing from deep recursion cheaper at the cost of losing the outermost frames.
+     * Only return addresses are captured, they are symbolized when the stack trace is first requested.
+     */
+    @ExperimentalStdlibApi
+    public var stackTraceDepth: Int
+        get() = Platform_getStackTraceDepth()
+        set(value) {
+            require(value >= 0) { "Stack trace depth must not be negative: $value" }
+            Platform_setStackTraceDepth(value)
+        }
+
+    /**
+     * If stack traces are captured by walking frame pointers instead of unwinding, `false` by default.
+     * It is much faster, but only exact when all code on the stack keeps frame pointers, otherwise the trace
+     * may be cut short. Only supported on Linux and Apple targets for x86-64 and ARM64, stays `false` elsewhere.
+     */
+    @ExperimentalStdlibApi
+    public var isFramePointerStackTraceActive: Boolean
+        get() = Platform_getFramePointerStackTrace()
+        set(value) = Platform_setFramePointerStackTrace(value)
 }
 
 @SymbolName("Konan_Platform_canAccessUnaligned")
@@ -129,3 +152,15 @@ private external fun Platform_getCleanersLeakChecker(): Boolean
 
 @SymbolName("Konan_Platform_setCleanersLeakChecker")
 private external fun Platform_setCleanersLeakChecker(value: Boolean): Unit
+
+@SymbolName("Konan_Platform_getStackTraceDepth")
+private external fun Platform_getStackTraceDepth(): Int
+
+@SymbolName("Konan_Platform_setStackTraceDepth")
+private external fun Platform_setStackTraceDepth(value: Int): Unit
+
+@SymbolName("Konan_Platform_getFramePointerStackTrace")
+private external fun Platform_getFramePointerStackTrace(): Boolean
+
+@SymbolName("Konan_Platform_setFramePointerStackTrace")
+private external fun Platform_setFramePointerStackTrace(value: Boolean): Unit
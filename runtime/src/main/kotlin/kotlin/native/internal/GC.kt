@@ -114,6 +114,66 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_findCycle")
     external fun findCycle(root: Any): Array<Any>?
 
+    /**
+     * Print objects retained only by stable references and atomic references to the standard error,
+     * grouped by type, with a shortest path from a root to an object of each type, and return their number.
+     * Objects reachable from globals or from the stack of the current thread are live, and are not reported.
+     * The legacy memory model cannot tell live objects from leaked ones while the program runs, so it returns `-1`,
+     * and prints this report only when [Platform.isMemoryLeakCheckerActive] finds leaks at shutdown.
+     */
+    @SymbolName("Kotlin_native_internal_GC_reportLeaks")
+    external fun reportLeaks(): Int
+
+    /**
+     * Average number of bytes allocated between two samples of the allocation profiler, 0 disables it (the default).
+     * Each sample records the type, size and stack of an allocation. Samples are aggregated in memory
+     * and can be written with [dumpAllocationProfile].
+     */
+    var allocationSamplingInterval: Long
+        get() = getAllocationSamplingInterval()
+        set(value) = setAllocationSamplingInterval(value)
+
+    /**
+     * Write the allocations sampled so far into the file at [path] as an uncompressed pprof profile.
+     * Returns `false` if the file could not be written.
+     */
+    @SymbolName("Kotlin_native_internal_GC_dumpAllocationProfile")
+    external fun dumpAllocationProfile(path: String): Boolean
+
+    /**
+     * If allocations and deallocations are counted per type for [typeHistogram], `false` by default.
+     * Counting adds a few atomic increments to each allocation and deallocation.
+     * Throws [IllegalArgumentException] if not supported on this target.
+     */
+    var typeCountersEnabled: Boolean
+        get() = getTypeCountersEnabled()
+        set(value) = setTypeCountersEnabled(value)
+
+    /**
+     * Snapshot the per-type counters as a table with a header line and tab separated columns: live objects,
+     * live bytes, allocated objects, allocated bytes and the type name, sorted by live bytes, most first.
+     * Live counts are exact only if [typeCountersEnabled] has been set since before the objects were allocated.
+     * Note that the experimental memory manager does not free objects yet, so all allocated objects are counted as live.
+     */
+    @SymbolName("Kotlin_native_internal_GC_getTypeHistogram")
+    external fun typeHistogram(): String
+
+    /**
+     * Write all objects of the heap, their types, sizes and references, along with the roots, into the file at [path].
+     * Returns `false` if the file could not be written. Only supported by the new memory model,
+     * throws [IllegalArgumentException] otherwise.
+     */
+    @SymbolName("Kotlin_native_internal_GC_dumpHeap")
+    external fun dumpHeap(path: String): Boolean
+
+    /**
+     * Make the [signal] write a heap dump as in [dumpHeap] into the file at [path], overwriting the previous one.
+     * The dump is written by the first thread to reach a safe point after the signal.
+     * Only supported by the new memory model, throws [IllegalArgumentException] otherwise.
+     */
+    @SymbolName("Kotlin_native_internal_GC_dumpHeapOnSignal")
+    external fun dumpHeapOnSignal(signal: Int, path: String)
+
     @SymbolName("Kotlin_native_internal_GC_getThreshold")
     private external fun getThreshold(): Int
 
@@ -138,6 +198,18 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_setTuneThreshold")
     private external fun setTuneThreshold(value: Boolean)
 
+    @SymbolName("Kotlin_native_internal_GC_getAllocationSamplingInterval")
+    private external fun getAllocationSamplingInterval(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setAllocationSamplingInterval")
+    private external fun setAllocationSamplingInterval(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getTypeCountersEnabled")
+    private external fun getTypeCountersEnabled(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setTypeCountersEnabled")
+    private external fun setTypeCountersEnabled(value: Boolean)
+
     @SymbolName("Kotlin_native_internal_GC_getCyclicCollector")
     private external fun getCyclicCollectorEnabled(): Boolean
 
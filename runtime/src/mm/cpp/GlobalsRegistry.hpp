@@ -7,7 +7,7 @@
 #define RUNTIME_MM_GLOBALS_REGISTRY_H
 
 #include "Memory.h"
-#include "MultiSourceQueue.hpp"
+#include "ChunkedMultiSourceQueue.hpp"
 #include "ThreadRegistry.hpp"
 #include "Utils.hpp"
 
@@ -16,15 +16,15 @@ namespace mm {
 
 class GlobalsRegistry : Pinned {
 public:
-    class ThreadQueue : public MultiSourceQueue<ObjHeader**>::Producer {
+    class ThreadQueue : public ChunkedMultiSourceQueue<ObjHeader**>::Producer {
     public:
         explicit ThreadQueue(GlobalsRegistry& registry) : Producer(registry.globals_) {}
         // Do not add fields as this is just a wrapper and Producer does not have virtual destructor.
     };
 
-    using Iterable = MultiSourceQueue<ObjHeader**>::Iterable;
+    using Iterable = ChunkedMultiSourceQueue<ObjHeader**>::Iterable;
 
-    using Iterator = MultiSourceQueue<ObjHeader**>::Iterator;
+    using Iterator = ChunkedMultiSourceQueue<ObjHeader**>::Iterator;
 
     GlobalsRegistry();
     ~GlobalsRegistry();
@@ -38,14 +38,10 @@ public:
     void ProcessThread(mm::ThreadData* threadData) noexcept;
 
     // Lock registry for safe iteration.
-    // TODO: Iteration over `globals_` will be slow, because it's `KStdList` collected at different times from
-    // different threads, and so the nodes are all over the memory. Use metrics to understand how
-    // much of a problem is it.
     Iterable Iter() noexcept { return globals_.Iter(); }
 
 private:
-    // TODO: Add-only MultiSourceQueue can be made more efficient. Measure, if it's a problem.
-    MultiSourceQueue<ObjHeader**> globals_;
+    ChunkedMultiSourceQueue<ObjHeader**> globals_;
 };
 
 } // namespace mm
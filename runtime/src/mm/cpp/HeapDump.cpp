@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "HeapDump.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <mutex>
+
+#include "Alloc.h"
+#include "GlobalData.hpp"
+#include "HeapDumpWriter.hpp"
+#include "Mutex.hpp"
+#include "Porting.h"
+#include "ThreadData.hpp"
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+SpinLock signalDumpPathLock;
+KStdString* signalDumpPath = nullptr;
+
+void heapDumpSignalHandler(int) {
+    // Only async-signal-safe things are allowed here, so leave the dump to the next safe point.
+    mm::internal::heapDumpRequested.store(true, std::memory_order_relaxed);
+}
+
+} // namespace
+
+std::atomic<bool> mm::internal::heapDumpRequested = false;
+
+void mm::internal::PerformRequestedHeapDump(ThreadData& threadData) noexcept {
+    if (!heapDumpRequested.exchange(false)) {
+        // Another thread got to it first.
+        return;
+    }
+    KStdString path;
+    {
+        std::lock_guard<SpinLock> guard(signalDumpPathLock);
+        if (signalDumpPath == nullptr) return;
+        path = *signalDumpPath;
+    }
+    if (!DumpHeap(threadData, path.c_str())) {
+        konan::consoleErrorf("Failed to write heap dump to %s\n", path.c_str());
+    }
+}
+
+bool mm::DumpHeap(ThreadData& threadData, const char* path) noexcept {
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+
+    // Make objects of the current thread visible to the iteration below.
+    threadData.Publish();
+
+    HeapDumpWriter writer(file);
+    auto& globalData = GlobalData::Instance();
+    for (ObjHeader** location : globalData.globalsRegistry().Iter()) {
+        writer.WriteRoot(HeapDumpWriter::RootKind::kGlobal, *location);
+    }
+    for (ObjHeader* object : globalData.stableRefRegistry().Iter()) {
+        writer.WriteRoot(HeapDumpWriter::RootKind::kStableRef, object);
+    }
+    for (ObjHeader* object : threadData.shadowStack()) {
+        writer.WriteRoot(HeapDumpWriter::RootKind::kStack, object);
+    }
+    for (ObjHeader** location : threadData.tls()) {
+        writer.WriteRoot(HeapDumpWriter::RootKind::kThreadLocal, *location);
+    }
+    for (auto node : globalData.objectFactory().Iter()) {
+        writer.WriteObject(node.IsArray() ? node.GetArrayHeader()->obj() : node.GetObjHeader());
+    }
+
+    bool written = writer.Finish();
+    if (std::fclose(file) != 0) {
+        written = false;
+    }
+    return written;
+}
+
+bool mm::DumpHeapOnSignal(int signal, const char* path) noexcept {
+    {
+        std::lock_guard<SpinLock> guard(signalDumpPathLock);
+        if (signalDumpPath == nullptr) {
+            signalDumpPath = konanConstructInstance<KStdString>();
+        }
+        *signalDumpPath = path;
+    }
+    return std::signal(signal, heapDumpSignalHandler) != SIG_ERR;
+}
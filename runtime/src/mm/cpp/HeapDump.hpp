@@ -0,0 +1,45 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_MM_HEAP_DUMP_H
+#define RUNTIME_MM_HEAP_DUMP_H
+
+#include <atomic>
+
+#include "Common.h"
+
+namespace kotlin {
+namespace mm {
+
+class ThreadData;
+
+namespace internal {
+
+extern std::atomic<bool> heapDumpRequested;
+
+void PerformRequestedHeapDump(ThreadData& threadData) noexcept;
+
+} // namespace internal
+
+// Writes roots and objects of the heap into `path` in the `HeapDumpWriter` format. Returns `false` if the file
+// could not be written. Must be called by a registered thread.
+// TODO: Without stopping the world only the roots of the current thread are consistent, so roots on other threads'
+//       stacks are not dumped. Objects that other threads have not published yet are only seen as referents.
+bool DumpHeap(ThreadData& threadData, const char* path) noexcept;
+
+// Makes `signal` request a heap dump into `path`. The dump is taken by the first thread to reach a safe point.
+// Each dump overwrites the previous one. Returns `false` if `signal` cannot be handled.
+bool DumpHeapOnSignal(int signal, const char* path) noexcept;
+
+ALWAYS_INLINE inline void HeapDumpSafePoint(ThreadData& threadData) noexcept {
+    if (internal::heapDumpRequested.load(std::memory_order_relaxed)) {
+        internal::PerformRequestedHeapDump(threadData);
+    }
+}
+
+} // namespace mm
+} // namespace kotlin
+
+#endif // RUNTIME_MM_HEAP_DUMP_H
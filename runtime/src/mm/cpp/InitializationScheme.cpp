@@ -5,9 +5,13 @@
 
 #include "InitializationScheme.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #include "Common.h"
 #include "ObjectOps.hpp"
 #include "ThreadData.hpp"
+#include "ThreadState.hpp"
 
 using namespace kotlin;
 
@@ -44,9 +48,15 @@ OBJ_GETTER(mm::InitSingleton, ThreadData* threadData, ObjHeader** location, cons
 
     ObjHeader* initializing = reinterpret_cast<ObjHeader*>(1);
 
-    // Spin lock.
-    ObjHeader* value = nullptr;
-    while ((value = __sync_val_compare_and_swap(location, nullptr, initializing)) == initializing) {
+    ObjHeader* value = __sync_val_compare_and_swap(location, nullptr, initializing);
+    if (value == initializing) {
+        // Another thread is running the constructor. Wait for it in the native state, so that this thread
+        // is not considered to be touching the heap while it spins.
+        ThreadState oldState = SwitchThreadState(threadData, ThreadState::kNative);
+        while ((value = __sync_val_compare_and_swap(location, nullptr, initializing)) == initializing) {
+            std::this_thread::yield();
+        }
+        SwitchThreadState(threadData, oldState);
     }
     if (value != nullptr) {
         // Initialized by someone else.
@@ -72,3 +82,44 @@ OBJ_GETTER(mm::InitSingleton, ThreadData* threadData, ObjHeader** location, cons
     initializingSingletons.pop_back();
     return object;
 }
+
+void mm::CallInitGlobalPossiblyLock(ThreadData* threadData, int32_t* state, void (*init)()) {
+    if (__atomic_load_n(state, __ATOMIC_ACQUIRE) == FILE_INITIALIZED) return;
+
+    auto& initializingFiles = threadData->initializingFiles();
+    if (std::find(initializingFiles.begin(), initializingFiles.end(), state) != initializingFiles.end()) {
+        // Accessed from the file initializer itself.
+        return;
+    }
+
+    int32_t value = FILE_NOT_INITIALIZED;
+    if (!__atomic_compare_exchange_n(state, &value, FILE_BEING_INITIALIZED, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        if (value == FILE_INITIALIZED) return;
+        // Another thread is running the initializer. Wait for it the same way `InitSingleton` does. If it fails,
+        // the state goes back to `FILE_NOT_INITIALIZED` and this thread retries the initialization.
+        ThreadState oldState = SwitchThreadState(threadData, ThreadState::kNative);
+        while (true) {
+            value = FILE_NOT_INITIALIZED;
+            if (__atomic_compare_exchange_n(state, &value, FILE_BEING_INITIALIZED, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) break;
+            if (value == FILE_INITIALIZED) break;
+            std::this_thread::yield();
+        }
+        SwitchThreadState(threadData, oldState);
+        if (value == FILE_INITIALIZED) return;
+    }
+
+    initializingFiles.push_back(state);
+#if KONAN_NO_EXCEPTIONS
+    init();
+#else
+    try {
+        init();
+    } catch (...) {
+        initializingFiles.pop_back();
+        __atomic_store_n(state, FILE_NOT_INITIALIZED, __ATOMIC_RELEASE);
+        throw;
+    }
+#endif
+    initializingFiles.pop_back();
+    __atomic_store_n(state, FILE_INITIALIZED, __ATOMIC_RELEASE);
+}
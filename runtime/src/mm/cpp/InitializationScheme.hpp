@@ -15,6 +15,7 @@ class ThreadData;
 
 OBJ_GETTER(InitThreadLocalSingleton, ThreadData* threadData, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*));
 OBJ_GETTER(InitSingleton, ThreadData* threadData, ObjHeader** location, const TypeInfo* typeInfo, void (*ctor)(ObjHeader*));
+void CallInitGlobalPossiblyLock(ThreadData* threadData, int32_t* state, void (*init)());
 
 } // namespace mm
 } // namespace kotlin
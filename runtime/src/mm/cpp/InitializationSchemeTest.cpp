@@ -257,3 +257,130 @@ TEST_F(InitSingletonTest, InitSingletonConcurrentFailing) {
     EXPECT_THAT(location, nullptr);
     EXPECT_THAT(stackLocations, testing::Each(nullptr));
 }
+
+namespace {
+
+class InitGlobalTest : public testing::Test {
+public:
+    InitGlobalTest() {
+        globalInit_ = &init_;
+        for (auto& threadData : threadDatas_) {
+            threadData = make_unique<mm::ThreadData>(pthread_t{});
+        }
+    }
+
+    ~InitGlobalTest() { globalInit_ = nullptr; }
+
+    testing::MockFunction<void()>& init() { return init_; }
+
+    void CallInitGlobal(int32_t* state, size_t threadIndex) {
+        mm::CallInitGlobalPossiblyLock(threadDatas_[threadIndex].get(), state, initImpl);
+    }
+
+private:
+    testing::StrictMock<testing::MockFunction<void()>> init_;
+    std::array<KStdUniquePtr<mm::ThreadData>, kDefaultThreadCount> threadDatas_;
+
+    static testing::MockFunction<void()>* globalInit_;
+
+    static void initImpl() { globalInit_->Call(); }
+};
+
+// static
+testing::MockFunction<void()>* InitGlobalTest::globalInit_ = nullptr;
+
+} // namespace
+
+TEST_F(InitGlobalTest, CallInitGlobal) {
+    int32_t state = FILE_NOT_INITIALIZED;
+
+    EXPECT_CALL(init(), Call()).WillOnce([&state]() { EXPECT_THAT(state, FILE_BEING_INITIALIZED); });
+    CallInitGlobal(&state, 0);
+    EXPECT_THAT(state, FILE_INITIALIZED);
+}
+
+TEST_F(InitGlobalTest, CallInitGlobalTwice) {
+    int32_t state = FILE_NOT_INITIALIZED;
+
+    EXPECT_CALL(init(), Call());
+    CallInitGlobal(&state, 0);
+    CallInitGlobal(&state, 0);
+    EXPECT_THAT(state, FILE_INITIALIZED);
+}
+
+TEST_F(InitGlobalTest, CallInitGlobalFail) {
+    int32_t state = FILE_NOT_INITIALIZED;
+    constexpr int kException = 42;
+
+    EXPECT_CALL(init(), Call()).WillOnce([]() { throw kException; });
+    try {
+        CallInitGlobal(&state, 0);
+        ASSERT_TRUE(false); // Cannot be reached.
+    } catch (int exception) {
+        EXPECT_THAT(exception, kException);
+    }
+    EXPECT_THAT(state, FILE_NOT_INITIALIZED);
+
+    // The next access retries the initialization.
+    EXPECT_CALL(init(), Call());
+    CallInitGlobal(&state, 0);
+    EXPECT_THAT(state, FILE_INITIALIZED);
+}
+
+TEST_F(InitGlobalTest, CallInitGlobalRecursive) {
+    // The first file. Its initializer accesses the second file.
+    int32_t state1 = FILE_NOT_INITIALIZED;
+    // The second file. Its initializer accesses the first file.
+    int32_t state2 = FILE_NOT_INITIALIZED;
+    bool firstStarted = false;
+
+    EXPECT_CALL(init(), Call())
+            .Times(2) // called only once for each file.
+            .WillRepeatedly([this, &state1, &state2, &firstStarted]() {
+                if (!firstStarted) {
+                    firstStarted = true;
+                    CallInitGlobal(&state2, 0);
+                    EXPECT_THAT(state2, FILE_INITIALIZED);
+                } else {
+                    // Returns immediately, the first file is still being initialized.
+                    CallInitGlobal(&state1, 0);
+                    EXPECT_THAT(state1, FILE_BEING_INITIALIZED);
+                }
+            });
+    CallInitGlobal(&state1, 0);
+    EXPECT_THAT(state1, FILE_INITIALIZED);
+}
+
+TEST_F(InitGlobalTest, CallInitGlobalConcurrent) {
+    constexpr size_t kThreadCount = kDefaultThreadCount;
+    std::atomic<bool> canStart(false);
+    std::atomic<size_t> readyCount(0);
+    KStdVector<std::thread> threads;
+    int32_t state = FILE_NOT_INITIALIZED;
+    std::atomic<int> initialized(0);
+    KStdVector<int> seen(kThreadCount, 0);
+
+    for (size_t i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([this, i, &state, &initialized, &seen, &readyCount, &canStart]() {
+            ++readyCount;
+            while (!canStart) {
+            }
+            CallInitGlobal(&state, i);
+            // Nobody returns before the initialization is finished.
+            seen[i] = initialized.load();
+        });
+    }
+
+    while (readyCount < kThreadCount) {
+    }
+    // Initializer is called exactly once.
+    EXPECT_CALL(init(), Call()).WillOnce([&initialized]() { initialized = 1; });
+    canStart = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    testing::Mock::VerifyAndClearExpectations(&init());
+
+    EXPECT_THAT(state, FILE_INITIALIZED);
+    EXPECT_THAT(seen, testing::Each(1));
+}
@@ -9,8 +9,11 @@
 #include "Exceptions.h"
 #include "ExtraObjectData.hpp"
 #include "GlobalsRegistry.hpp"
+#include "HeapDump.hpp"
 #include "InitializationScheme.hpp"
 #include "KAssert.h"
+#include "KString.h"
+#include "LeakReporter.hpp"
 #include "Natives.h"
 #include "Porting.h"
 #include "ObjectOps.hpp"
@@ -123,6 +126,12 @@ extern "C" ALWAYS_INLINE OBJ_GETTER(InitSingleton, ObjHeader** location, const T
     RETURN_RESULT_OF(mm::InitSingleton, threadData, location, typeInfo, ctor);
 }
 
+extern "C" void CallInitGlobalPossiblyLock(int32_t* state, void (*init)()) {
+    if (__atomic_load_n(state, __ATOMIC_ACQUIRE) == FILE_INITIALIZED) return;
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    mm::CallInitGlobalPossiblyLock(threadData, state, init);
+}
+
 extern "C" RUNTIME_NOTHROW void InitAndRegisterGlobal(ObjHeader** location, const ObjHeader* initialValue) {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     mm::GlobalsRegistry::Instance().RegisterStorageForGlobal(threadData, location);
@@ -176,6 +185,10 @@ extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void UpdateHeapRefsInsideOneArray(const
     RuntimeFail("Only for legacy MM");
 }
 
+extern "C" RUNTIME_NOTHROW void CopyHeapRefs(ObjHeader** destination, ObjHeader* const* source, int count) {
+    mm::CopyHeapRefs(destination, source, count);
+}
+
 extern "C" ALWAYS_INLINE RUNTIME_NOTHROW void UpdateReturnRef(ObjHeader** returnSlot, const ObjHeader* object) {
     mm::SetStackRef(returnSlot, const_cast<ObjHeader*>(object));
 }
@@ -313,6 +326,46 @@ extern "C" void Kotlin_native_internal_GC_setCyclicCollector(ObjHeader* gc, bool
         ThrowIllegalArgumentException();
 }
 
+extern "C" bool Kotlin_native_internal_GC_dumpHeap(ObjHeader*, ObjHeader* path) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    char* cpath = CreateCStringFromString(path);
+    bool written = mm::DumpHeap(*threadData, cpath);
+    DisposeCString(cpath);
+    return written;
+}
+
+extern "C" void Kotlin_native_internal_GC_dumpHeapOnSignal(ObjHeader*, int32_t signal, ObjHeader* path) {
+    char* cpath = CreateCStringFromString(path);
+    bool installed = mm::DumpHeapOnSignal(signal, cpath);
+    DisposeCString(cpath);
+    if (!installed) {
+        ThrowIllegalArgumentException();
+    }
+}
+
+extern "C" int32_t Kotlin_native_internal_GC_reportLeaks(ObjHeader*) {
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    // Make globals and stable refs of the current thread visible to the iteration below.
+    threadData->Publish();
+    auto& globalData = mm::GlobalData::Instance();
+    LeakReporter reporter;
+    // Only the current thread is known to be stopped, so objects used by other threads may be reported too.
+    for (ObjHeader* object : threadData->shadowStack()) {
+        reporter.AddLiveRoot(object);
+    }
+    for (ObjHeader** location : threadData->tls()) {
+        reporter.AddLiveRoot(*location);
+    }
+    // Globals hold what the program may use at any time, so everything reachable from them is live.
+    for (ObjHeader** location : globalData.globalsRegistry().Iter()) {
+        reporter.AddLiveRoot(*location);
+    }
+    for (ObjHeader* object : globalData.stableRefRegistry().Iter()) {
+        reporter.AddLeakRoot(LeakReporter::RootKind::kStableRef, object);
+    }
+    return reporter.Report();
+}
+
 extern "C" bool Kotlin_Any_isShareable(ObjHeader* thiz) {
     // TODO: Remove when legacy MM is gone.
     return true;
@@ -381,6 +434,13 @@ extern "C" RUNTIME_NOTHROW void CheckLifetimesConstraint(ObjHeader* obj, ObjHead
     }
 }
 
+extern "C" ForeignRefContext InitLocalForeignRef(ObjHeader* object) {
+    // Objects are not bound to threads, so a thread local foreign reference is just a stable reference.
+    auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
+    auto* node = mm::StableRefRegistry::Instance().RegisterStableRef(threadData, object);
+    return ToForeignRefManager(node);
+}
+
 extern "C" ForeignRefContext InitForeignRef(ObjHeader* object) {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     auto* node = mm::StableRefRegistry::Instance().RegisterStableRef(threadData, object);
@@ -399,6 +459,27 @@ extern "C" bool IsForeignRefAccessible(ObjHeader* object, ForeignRefContext cont
     return true;
 }
 
+extern "C" bool TryAddHeapRef(const ObjHeader* object) {
+    // TODO: Remove when legacy MM is gone.
+    // There's no reference counting, and an object reachable from a foreign reference stays alive.
+    return true;
+}
+
+extern "C" RUNTIME_NOTHROW void ReleaseHeapRef(const ObjHeader* object) {
+    // TODO: Remove when legacy MM is gone.
+    // Nothing to do
+}
+
+extern "C" RUNTIME_NOTHROW void ReleaseHeapRefNoCollect(const ObjHeader* object) {
+    // TODO: Remove when legacy MM is gone.
+    // Nothing to do
+}
+
+extern "C" void EnsureNeverFrozen(ObjHeader* object) {
+    // TODO: Freezing is not implemented, so the object cannot become frozen.
+    // Nothing to do
+}
+
 extern "C" void AdoptReferenceFromSharedVariable(ObjHeader* object) {
     // TODO: Remove when legacy MM is gone.
     // Nothing to do.
@@ -412,11 +493,13 @@ extern "C" void CheckGlobalsAccessible() {
 extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointFunctionEpilogue() {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     threadData->gc().SafePointFunctionEpilogue();
+    mm::HeapDumpSafePoint(*threadData);
 }
 
 extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointWhileLoopBody() {
     auto* threadData = mm::ThreadRegistry::Instance().CurrentThreadData();
     threadData->gc().SafePointLoopBody();
+    mm::HeapDumpSafePoint(*threadData);
 }
 
 extern "C" RUNTIME_NOTHROW void Kotlin_mm_safePointExceptionUnwind() {
@@ -10,11 +10,14 @@
 #include <memory>
 #include <mutex>
 #include <type_traits>
+#include <utility>
 
 #include "Alignment.hpp"
 #include "Alloc.h"
+#include "AllocationProfiler.hpp"
 #include "Memory.h"
 #include "Mutex.hpp"
+#include "TypeCounters.hpp"
 #include "Types.h"
 #include "Utils.hpp"
 
@@ -465,6 +468,8 @@ public:
             auto* heapObject = new (node.Data()) HeapObjHeader();
             auto* object = &heapObject->object;
             object->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
+            ProfileAllocation(typeInfo, typeInfo->instanceSize_);
+            CountAllocation(typeInfo, typeInfo->instanceSize_);
             return object;
         }
 
@@ -478,6 +483,8 @@ public:
             auto* array = &heapArray->array;
             array->typeInfoOrMeta_ = const_cast<TypeInfo*>(typeInfo);
             array->count_ = count;
+            ProfileAllocation(typeInfo, sizeof(ArrayHeader) + membersSize);
+            CountAllocation(typeInfo, sizeof(ArrayHeader) + membersSize);
             return array;
         }
 
@@ -513,6 +520,22 @@ public:
 
     class FinalizerQueue : private MoveOnly {
     public:
+        FinalizerQueue() noexcept = default;
+        FinalizerQueue(FinalizerQueue&&) noexcept = default;
+
+        FinalizerQueue& operator=(FinalizerQueue&& rhs) noexcept {
+            FinalizerQueue old(std::move(rhs));
+            std::swap(consumer_, old.consumer_);
+            return *this;
+        }
+
+        // Objects in the queue are freed together with it.
+        ~FinalizerQueue() {
+            for (auto& node : consumer_) {
+                CountNodeDeallocation(node);
+            }
+        }
+
         class Iterator {
         public:
             NodeRef operator*() noexcept { return NodeRef(*iterator_); }
@@ -550,7 +573,10 @@ public:
         Iterator begin() noexcept { return Iterator(iter_.begin()); }
         Iterator end() noexcept { return Iterator(iter_.end()); }
 
-        void EraseAndAdvance(Iterator& iterator) noexcept { iter_.EraseAndAdvance(iterator.iterator_); }
+        void EraseAndAdvance(Iterator& iterator) noexcept {
+            CountNodeDeallocation(*iterator.iterator_);
+            iter_.EraseAndAdvance(iterator.iterator_);
+        }
 
         void MoveAndAdvance(FinalizerQueue& queue, Iterator& iterator) noexcept {
             iter_.MoveAndAdvance(queue.consumer_, iterator.iterator_);
@@ -566,6 +592,12 @@ public:
     Iterable Iter() noexcept { return Iterable(*this); }
 
 private:
+    static void CountNodeDeallocation(typename Storage::Node& node) noexcept {
+        // `HeapArrayHeader` and `HeapObjHeader` are kept compatible, so the former can
+        // be always casted to the other.
+        CountDeallocation(&static_cast<HeapObjHeader*>(node.Data())->object);
+    }
+
     Storage storage_;
 };
 
@@ -13,7 +13,9 @@
 #include "gtest/gtest.h"
 
 #include "GC.hpp"
+#include "ObjectTestSupport.hpp"
 #include "TestSupport.hpp"
+#include "TypeCounters.hpp"
 #include "Types.h"
 
 using namespace kotlin;
@@ -759,6 +761,28 @@ KStdUniquePtr<TypeInfo> MakeArrayTypeInfo(int32_t elementSize) {
     return typeInfo;
 }
 
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+using test_support::CountedType;
+
+CountedType erasedObjectType(24);
+CountedType erasedArrayType(-8);
+CountedType finalizedObjectType(24);
+CountedType finalizedArrayType(-8);
+
+TypeCounters::Entry Counted(CountedType& type) {
+    return TypeCounters::ForType(&type.typeInfo)->Get();
+}
+
+class ObjectFactoryCountersTest : public testing::Test {
+public:
+    ObjectFactoryCountersTest() { TypeCounters::SetEnabled(true); }
+
+    ~ObjectFactoryCountersTest() { TypeCounters::SetEnabled(false); }
+};
+
+#endif
+
 } // namespace
 
 TEST(ObjectFactoryTest, CreateObject) {
@@ -882,6 +906,75 @@ TEST(ObjectFactoryTest, Move) {
     }
 }
 
+#if KONAN_TYPE_INFO_HAS_WRITABLE_PART
+
+TEST_F(ObjectFactoryCountersTest, CountErased) {
+    GC::ThreadData gc;
+    ObjectFactory objectFactory;
+    ObjectFactory::ThreadQueue threadQueue(objectFactory, gc);
+
+    threadQueue.CreateObject(&erasedObjectType.typeInfo);
+    threadQueue.CreateObject(&erasedObjectType.typeInfo);
+    threadQueue.CreateArray(&erasedArrayType.typeInfo, 3);
+    threadQueue.Publish();
+
+    {
+        auto iter = objectFactory.Iter();
+        auto it = iter.begin();
+        iter.EraseAndAdvance(it);
+        ++it;
+        iter.EraseAndAdvance(it);
+    }
+
+    auto objects = Counted(erasedObjectType);
+    EXPECT_THAT(objects.allocatedObjects, 2);
+    EXPECT_THAT(objects.liveObjects, 1);
+    EXPECT_THAT(objects.liveBytes, 24);
+    auto arrays = Counted(erasedArrayType);
+    EXPECT_THAT(arrays.allocatedObjects, 1);
+    EXPECT_THAT(arrays.liveObjects, 0);
+    EXPECT_THAT(arrays.liveBytes, 0);
+}
+
+TEST_F(ObjectFactoryCountersTest, CountFinalized) {
+    GC::ThreadData gc;
+    ObjectFactory objectFactory;
+    ObjectFactory::ThreadQueue threadQueue(objectFactory, gc);
+
+    threadQueue.CreateObject(&finalizedObjectType.typeInfo);
+    threadQueue.CreateObject(&finalizedObjectType.typeInfo);
+    threadQueue.CreateArray(&finalizedArrayType.typeInfo, 3);
+    threadQueue.Publish();
+
+    {
+        ObjectFactory::FinalizerQueue finalizerQueue;
+        {
+            auto iter = objectFactory.Iter();
+            auto it = iter.begin();
+            iter.MoveAndAdvance(finalizerQueue, it);
+            ++it;
+            iter.MoveAndAdvance(finalizerQueue, it);
+        }
+
+        // Objects awaiting finalization are still alive.
+        EXPECT_THAT(Counted(finalizedObjectType).liveObjects, 2);
+        EXPECT_THAT(Counted(finalizedArrayType).liveObjects, 1);
+
+        ObjectFactory::FinalizerQueue movedQueue(std::move(finalizerQueue));
+    }
+
+    auto objects = Counted(finalizedObjectType);
+    EXPECT_THAT(objects.allocatedObjects, 2);
+    EXPECT_THAT(objects.liveObjects, 1);
+    EXPECT_THAT(objects.liveBytes, 24);
+    auto arrays = Counted(finalizedArrayType);
+    EXPECT_THAT(arrays.allocatedObjects, 1);
+    EXPECT_THAT(arrays.liveObjects, 0);
+    EXPECT_THAT(arrays.liveBytes, 0);
+}
+
+#endif
+
 TEST(ObjectFactoryTest, ConcurrentPublish) {
     auto typeInfo = MakeObjectTypeInfo(24);
     ObjectFactory objectFactory;
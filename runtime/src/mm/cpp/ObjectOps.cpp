@@ -5,6 +5,7 @@
 
 #include "ObjectOps.hpp"
 
+#include "ArrayKernels.hpp"
 #include "Common.h"
 #include "ThreadData.hpp"
 
@@ -20,6 +21,11 @@ ALWAYS_INLINE void mm::SetHeapRef(ObjHeader** location, ObjHeader* value) noexce
     *location = value;
 }
 
+void mm::CopyHeapRefs(ObjHeader** destination, ObjHeader* const* source, size_t count) noexcept {
+    // `SetHeapRef` is a plain store, so the whole range can be moved at once.
+    CopyArray(destination, source, count * sizeof(ObjHeader*));
+}
+
 #pragma clang diagnostic push
 // On 32-bit android arm clang warns of significant performance penalty because of large
 // atomic operations. TODO: Consider using alternative ways of ordering memory operations if they
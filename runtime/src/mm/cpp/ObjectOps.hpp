@@ -6,6 +6,8 @@
 #ifndef RUNTIME_MM_OBJECT_OPS_H
 #define RUNTIME_MM_OBJECT_OPS_H
 
+#include <cstddef>
+
 #include "Memory.h"
 
 namespace kotlin {
@@ -24,6 +26,8 @@ class ThreadData;
 void SetStackRef(ObjHeader** location, ObjHeader* value) noexcept;
 void SetHeapRef(ObjHeader** location, ObjHeader* value) noexcept;
 void SetHeapRefAtomic(ObjHeader** location, ObjHeader* value) noexcept;
+// Same as `SetHeapRef` for each of `count` locations; the ranges may overlap.
+void CopyHeapRefs(ObjHeader** destination, ObjHeader* const* source, size_t count) noexcept;
 OBJ_GETTER(ReadHeapRefAtomic, ObjHeader** location) noexcept;
 OBJ_GETTER(CompareAndSwapHeapRef, ObjHeader** location, ObjHeader* expected, ObjHeader* value) noexcept;
 OBJ_GETTER(AllocateObject, ThreadData* threadData, const TypeInfo* typeInfo) noexcept;
@@ -6,8 +6,8 @@
 #ifndef RUNTIME_MM_STABLE_REF_REGISTRY_H
 #define RUNTIME_MM_STABLE_REF_REGISTRY_H
 
+#include "ChunkedMultiSourceQueue.hpp"
 #include "Memory.h"
-#include "MultiSourceQueue.hpp"
 #include "ThreadRegistry.hpp"
 
 namespace kotlin {
@@ -16,15 +16,15 @@ namespace mm {
 // Registry for all objects that have references outside of Kotlin.
 class StableRefRegistry : Pinned {
 public:
-    class ThreadQueue : public MultiSourceQueue<ObjHeader*>::Producer {
+    class ThreadQueue : public ChunkedMultiSourceQueue<ObjHeader*>::Producer {
     public:
         explicit ThreadQueue(StableRefRegistry& registry) : Producer(registry.stableRefs_) {}
         // Do not add fields as this is just a wrapper and Producer does not have virtual destructor.
     };
 
-    using Iterable = MultiSourceQueue<ObjHeader*>::Iterable;
-    using Iterator = MultiSourceQueue<ObjHeader*>::Iterator;
-    using Node = MultiSourceQueue<ObjHeader*>::Node;
+    using Iterable = ChunkedMultiSourceQueue<ObjHeader*>::Iterable;
+    using Iterator = ChunkedMultiSourceQueue<ObjHeader*>::Iterator;
+    using Node = ChunkedMultiSourceQueue<ObjHeader*>::Node;
 
     StableRefRegistry();
     ~StableRefRegistry();
@@ -42,29 +42,22 @@ public:
     // Lock registry and apply deletions. Should be called on GC thread after all threads have published, and before `Iter`.
     void ProcessDeletions() noexcept;
 
-    // Lock registry for safe iteration.
-    // TODO: Iteration over `stableRefs_` will be slow, because it's `KStdList` collected at different times from
-    // different threads, and so the nodes are all over the memory. Use metrics to understand how
-    // much of a problem is it.
+    // Lock registry for safe iteration. Only visits published references; if a reference was scheduled
+    // for deletion, it'll still be visited until `ProcessDeletions`.
     Iterable Iter() noexcept { return stableRefs_.Iter(); }
 
     void ClearForTests() noexcept { stableRefs_.ClearForTests(); }
 
 private:
-    // Current approach optimizes for creating and disposing of stable refs:
-    // * creation just enqueues ref, disposing either queues or deletes the ref immediately (if it still resides in the current queue).
-    // * when thread is stopped, it'll scan through the local queue (to mark that refs no longer reside in it) and push creation and
-    //   deletion queues to the global registry.
-    // * during marking GC will have to `ProcessDeletions` to actually delete the refs that were enqueued for deletion.
-    // So, we sacrifice memory (to keep deleted queues) and marking time (to process these queues) to improve creation and disposal times.
-    //
-    // Other alternatives:
-    // * Use a single global collection (e.g. lock free doubly linked list).
-    // * Sacrifice disposal time to try to delete as early as possible (e.g. post directly into owning producer, so it processes deletions
-    //   before posting queue to the global registry)
-    //
-    // TODO: Measure to understand, if this approach is problematic.
-    MultiSourceQueue<ObjHeader*> stableRefs_;
+    // Current approach optimizes for creating and disposing of stable refs, and for scanning them:
+    // * each thread creates refs in the chunks it owns without any synchronization, reusing the nodes it has freed.
+    //   Disposing of a ref in an owned chunk frees its node immediately, otherwise the node is queued for deletion.
+    //   Once its own chunks are full, a thread fills the free nodes of published chunks under the registry lock
+    //   before allocating a new chunk.
+    // * when thread is stopped, it publishes its chunks and deletion queue to the registry in bulk.
+    // * during marking GC will have to `ProcessDeletions` to free the queued nodes, and will then sweep the node arrays
+    //   of the published chunks. A published chunk is released once all of its nodes are freed.
+    ChunkedMultiSourceQueue<ObjHeader*> stableRefs_;
 };
 
 } // namespace mm
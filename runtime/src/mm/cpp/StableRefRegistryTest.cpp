@@ -0,0 +1,186 @@
+/*
+ * Copyright 2010-2021 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "StableRefRegistry.hpp"
+
+#include <algorithm>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Types.h"
+
+using namespace kotlin;
+
+namespace {
+
+ObjHeader* MakeRef(uintptr_t value) {
+    return reinterpret_cast<ObjHeader*>(value);
+}
+
+KStdVector<ObjHeader*> Collect(mm::StableRefRegistry& registry) {
+    KStdVector<ObjHeader*> result;
+    for (auto object : registry.Iter()) {
+        result.push_back(object);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(StableRefRegistryTest, Empty) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    queue.Publish();
+    registry.ProcessDeletions();
+
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+}
+
+TEST(StableRefRegistryTest, InsertAndPublish) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    auto* node1 = queue.Insert(MakeRef(1));
+    auto* node2 = queue.Insert(MakeRef(2));
+    EXPECT_THAT(**node1, MakeRef(1));
+    EXPECT_THAT(**node2, MakeRef(2));
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+
+    queue.Publish();
+
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(1), MakeRef(2)));
+}
+
+TEST(StableRefRegistryTest, EraseOwned) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    auto* node1 = queue.Insert(MakeRef(1));
+    queue.Insert(MakeRef(2));
+    queue.Erase(node1);
+    queue.Publish();
+
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(2)));
+}
+
+TEST(StableRefRegistryTest, ErasePublished) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    auto* node1 = queue.Insert(MakeRef(1));
+    queue.Insert(MakeRef(2));
+    queue.Publish();
+    queue.Erase(node1);
+    queue.Publish();
+
+    // Deletions of published refs are applied only by `ProcessDeletions`.
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(1), MakeRef(2)));
+
+    registry.ProcessDeletions();
+
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(2)));
+}
+
+TEST(StableRefRegistryTest, EraseFromAnotherQueue) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue1(registry);
+    mm::StableRefRegistry::ThreadQueue queue2(registry);
+
+    auto* node = queue1.Insert(MakeRef(1));
+    queue2.Erase(node);
+    queue2.Publish();
+    registry.ProcessDeletions();
+
+    EXPECT_THAT(**node, MakeRef(1));
+
+    queue1.Publish();
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(1)));
+
+    registry.ProcessDeletions();
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+}
+
+TEST(StableRefRegistryTest, ReuseErasedNode) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    auto* node1 = queue.Insert(MakeRef(1));
+    queue.Insert(MakeRef(2));
+    queue.Erase(node1);
+    auto* node3 = queue.Insert(MakeRef(3));
+    EXPECT_THAT(node3, node1);
+
+    queue.Publish();
+    EXPECT_THAT(Collect(registry), testing::ElementsAre(MakeRef(3), MakeRef(2)));
+}
+
+TEST(StableRefRegistryTest, ManyRefs) {
+    constexpr uintptr_t kCount = 1000;
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue1(registry);
+    mm::StableRefRegistry::ThreadQueue queue2(registry);
+
+    KStdVector<mm::StableRefRegistry::Node*> nodes;
+    for (uintptr_t i = 1; i <= kCount; ++i) {
+        nodes.push_back(queue1.Insert(MakeRef(i)));
+    }
+    queue1.Publish();
+    EXPECT_THAT(Collect(registry).size(), kCount);
+
+    // Erase every other ref from another queue.
+    for (size_t i = 0; i < nodes.size(); i += 2) {
+        queue2.Erase(nodes[i]);
+    }
+    queue2.Publish();
+    registry.ProcessDeletions();
+
+    KStdVector<ObjHeader*> expected;
+    for (size_t i = 1; i < nodes.size(); i += 2) {
+        expected.push_back(**nodes[i]);
+    }
+    EXPECT_THAT(Collect(registry), testing::UnorderedElementsAreArray(expected));
+
+    // Another queue reuses the freed nodes in place, so published refs stay visible.
+    KStdVector<mm::StableRefRegistry::Node*> newNodes;
+    for (uintptr_t i = kCount + 1; i <= kCount + kCount / 4; ++i) {
+        auto* node = queue2.Insert(MakeRef(i));
+        EXPECT_THAT(std::find(nodes.begin(), nodes.end(), node), testing::Ne(nodes.end()));
+        newNodes.push_back(node);
+        expected.push_back(MakeRef(i));
+    }
+    EXPECT_THAT(Collect(registry), testing::UnorderedElementsAreArray(expected));
+    queue2.Publish();
+    EXPECT_THAT(Collect(registry), testing::UnorderedElementsAreArray(expected));
+
+    // Erase everything.
+    for (size_t i = 1; i < nodes.size(); i += 2) {
+        queue1.Erase(nodes[i]);
+    }
+    for (auto* node : newNodes) {
+        queue1.Erase(node);
+    }
+    queue1.Publish();
+    registry.ProcessDeletions();
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+}
+
+TEST(StableRefRegistryTest, ClearForTests) {
+    mm::StableRefRegistry registry;
+    mm::StableRefRegistry::ThreadQueue queue(registry);
+
+    auto* node = queue.Insert(MakeRef(1));
+    queue.Publish();
+    queue.Insert(MakeRef(2));
+    queue.Erase(node);
+    queue.ClearForTests();
+    registry.ClearForTests();
+
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+    queue.Publish();
+    registry.ProcessDeletions();
+    EXPECT_THAT(Collect(registry), testing::IsEmpty());
+}
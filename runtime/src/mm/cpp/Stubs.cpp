@@ -22,10 +22,6 @@ void FreezeSubgraph(ObjHeader* obj) {
     // TODO: Unimplemented
 }
 
-void EnsureNeverFrozen(ObjHeader* obj) {
-    TODO();
-}
-
 void Kotlin_native_internal_GC_suspend(ObjHeader*) {
     TODO();
 }
@@ -50,20 +46,4 @@ bool Kotlin_native_internal_GC_getTuneThreshold(ObjHeader*) {
     TODO();
 }
 
-bool TryAddHeapRef(const ObjHeader* object) {
-    TODO();
-}
-
-RUNTIME_NOTHROW void ReleaseHeapRef(const ObjHeader* object) {
-    TODO();
-}
-
-RUNTIME_NOTHROW void ReleaseHeapRefNoCollect(const ObjHeader* object) {
-    TODO();
-}
-
-ForeignRefContext InitLocalForeignRef(ObjHeader* object) {
-    TODO();
-}
-
 } // extern "C"
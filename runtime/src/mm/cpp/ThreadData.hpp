@@ -57,6 +57,8 @@ public:
 
     KStdVector<std::pair<ObjHeader**, ObjHeader*>>& initializingSingletons() noexcept { return initializingSingletons_; }
 
+    KStdVector<int32_t*>& initializingFiles() noexcept { return initializingFiles_; }
+
     GC::ThreadData& gc() noexcept { return gc_; }
 
     void Publish() noexcept {
@@ -76,6 +78,7 @@ private:
     GC::ThreadData gc_;
     ObjectFactory<GC>::ThreadQueue objectFactoryThreadQueue_;
     KStdVector<std::pair<ObjHeader**, ObjHeader*>> initializingSingletons_;
+    KStdVector<int32_t*> initializingFiles_;
 };
 
 } // namespace mm
@@ -13,6 +13,9 @@ class TypeInfoImpl {
 public:
     TypeInfoImpl() { type_.typeInfo_ = &type_; }
 
+    // Arrays store the negated element size in `instanceSize_`.
+    explicit TypeInfoImpl(size_t elementSize) : TypeInfoImpl() { type_.instanceSize_ = -static_cast<int32_t>(elementSize); }
+
     TypeInfo* type() { return &type_; }
 
 private:
@@ -20,21 +23,21 @@ private:
 };
 
 TypeInfoImpl theAnyTypeInfoImpl;
-TypeInfoImpl theArrayTypeInfoImpl;
-TypeInfoImpl theBooleanArrayTypeInfoImpl;
-TypeInfoImpl theByteArrayTypeInfoImpl;
-TypeInfoImpl theCharArrayTypeInfoImpl;
-TypeInfoImpl theDoubleArrayTypeInfoImpl;
-TypeInfoImpl theFloatArrayTypeInfoImpl;
+TypeInfoImpl theArrayTypeInfoImpl(sizeof(ObjHeader*));
+TypeInfoImpl theBooleanArrayTypeInfoImpl(sizeof(KBoolean));
+TypeInfoImpl theByteArrayTypeInfoImpl(sizeof(KByte));
+TypeInfoImpl theCharArrayTypeInfoImpl(sizeof(KChar));
+TypeInfoImpl theDoubleArrayTypeInfoImpl(sizeof(KDouble));
+TypeInfoImpl theFloatArrayTypeInfoImpl(sizeof(KFloat));
 TypeInfoImpl theForeignObjCObjectTypeInfoImpl;
 TypeInfoImpl theFreezableAtomicReferenceTypeInfoImpl;
-TypeInfoImpl theIntArrayTypeInfoImpl;
-TypeInfoImpl theLongArrayTypeInfoImpl;
-TypeInfoImpl theNativePtrArrayTypeInfoImpl;
+TypeInfoImpl theIntArrayTypeInfoImpl(sizeof(KInt));
+TypeInfoImpl theLongArrayTypeInfoImpl(sizeof(KLong));
+TypeInfoImpl theNativePtrArrayTypeInfoImpl(sizeof(KNativePtr));
 TypeInfoImpl theObjCObjectWrapperTypeInfoImpl;
 TypeInfoImpl theOpaqueFunctionTypeInfoImpl;
-TypeInfoImpl theShortArrayTypeInfoImpl;
-TypeInfoImpl theStringTypeInfoImpl;
+TypeInfoImpl theShortArrayTypeInfoImpl(sizeof(KShort));
+TypeInfoImpl theStringTypeInfoImpl(sizeof(KChar));
 TypeInfoImpl theThrowableTypeInfoImpl;
 TypeInfoImpl theUnitTypeInfoImpl;
 TypeInfoImpl theWorkerBoundReferenceTypeInfoImpl;